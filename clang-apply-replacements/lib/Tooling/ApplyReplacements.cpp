@@ -110,16 +110,20 @@ collectReplacementsFromDirectory(const llvm::StringRef Directory,
       continue;
     }
 
+    // clang-tidy writes the diagnostics of each translation unit as a
+    // separate document.
     yaml::Input YIn(Out.get()->getBuffer(), nullptr, &eatDiagnostics);
-    tooling::TranslationUnitDiagnostics TU;
-    YIn >> TU;
-    if (YIn.error()) {
-      // File doesn't appear to be a header change description. Ignore it.
-      continue;
-    }
+    do {
+      tooling::TranslationUnitDiagnostics TU;
+      YIn >> TU;
+      if (YIn.error()) {
+        // File doesn't appear to be a header change description. Ignore it.
+        break;
+      }
 
-    // Only keep files that properly parse.
-    TUs.push_back(TU);
+      // Only keep documents that properly parse.
+      TUs.push_back(TU);
+    } while (YIn.nextDocument());
   }
 
   return ErrorCode;
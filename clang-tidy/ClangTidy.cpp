@@ -18,9 +18,12 @@
 #include "ClangTidy.h"
 #include "ClangTidyDiagnosticConsumer.h"
 #include "ClangTidyModuleRegistry.h"
+#include "ClangTidyResultCache.h"
+#include "ClangTidyWorkerProcesses.h"
 #include "clang/AST/ASTConsumer.h"
 #include "clang/AST/ASTContext.h"
 #include "clang/AST/Decl.h"
+#include "clang/AST/RecursiveASTVisitor.h"
 #include "clang/ASTMatchers/ASTMatchFinder.h"
 #include "clang/Format/Format.h"
 #include "clang/Frontend/ASTConsumers.h"
@@ -29,6 +32,7 @@
 #include "clang/Frontend/FrontendDiagnostic.h"
 #include "clang/Frontend/MultiplexConsumer.h"
 #include "clang/Frontend/TextDiagnosticPrinter.h"
+#include "clang/Frontend/Utils.h"
 #include "clang/Lex/PPCallbacks.h"
 #include "clang/Lex/Preprocessor.h"
 #include "clang/Rewrite/Frontend/FixItRewriter.h"
@@ -39,9 +43,17 @@
 #include "clang/Tooling/Refactoring.h"
 #include "clang/Tooling/ReplacementsYaml.h"
 #include "clang/Tooling/Tooling.h"
+#include "llvm/ADT/StringSet.h"
+#include "llvm/Support/FileSystem.h"
 #include "llvm/Support/Process.h"
 #include "llvm/Support/Signals.h"
+#include "llvm/Support/ThreadPool.h"
 #include <algorithm>
+#include <atomic>
+#include <map>
+#include <mutex>
+#include <set>
+#include <tuple>
 #include <utility>
 
 using namespace clang::ast_matchers;
@@ -87,6 +99,8 @@ private:
   ClangTidyContext &Context;
 };
 
+} // namespace
+
 class ErrorReporter {
 public:
   ErrorReporter(ClangTidyContext &Context, bool ApplyFixes)
@@ -100,10 +114,34 @@ public:
     DiagPrinter->BeginSourceFile(LangOpts);
   }
 
-  SourceManager &getSourceManager() { return SourceMgr; }
+  /// \brief Reports \p Errors, resolving their file paths relative to the
+  /// build directories they were found in. Their fixes are only collected if
+  /// \p CollectFixes is true.
+  void reportDiagnostics(ArrayRef<ClangTidyError> Errors,
+                         bool CollectFixes = true) {
+    vfs::FileSystem &FileSystem =
+        *SourceMgr.getFileManager().getVirtualFileSystem();
+    auto InitialWorkingDir = FileSystem.getCurrentWorkingDirectory();
+    if (!InitialWorkingDir)
+      llvm::report_fatal_error("Cannot get current working path.");
+
+    for (const ClangTidyError &Error : Errors) {
+      if (!Error.BuildDirectory.empty()) {
+        // By default, the working directory of file system is the current
+        // clang-tidy running directory.
+        //
+        // Change the directory to the one used during the analysis.
+        FileSystem.setCurrentWorkingDirectory(Error.BuildDirectory);
+      }
+      reportDiagnostic(Error, CollectFixes);
+      // Return to the initial directory to correctly resolve next Error.
+      FileSystem.setCurrentWorkingDirectory(InitialWorkingDir.get());
+    }
+  }
 
-  void reportDiagnostic(const ClangTidyError &Error) {
+  void reportDiagnostic(const ClangTidyError &Error, bool CollectFixes = true) {
     const tooling::DiagnosticMessage &Message = Error.Message;
+    const bool ApplyErrorFixes = ApplyFixes && CollectFixes;
     SourceLocation Loc = getLocation(Message.FilePath, Message.FileOffset);
     // Contains a pair for each attempted fix: location and whether the fix was
     // applied successfully.
@@ -125,12 +163,13 @@ public:
           // have valid file paths and are therefore not applicable.
           SourceRange Range;
           SourceLocation FixLoc;
-          ++TotalFixes;
+          if (ApplyErrorFixes)
+            ++TotalFixes;
           bool CanBeApplied = false;
           if (Repl.isApplicable()) {
             SmallString<128> FixAbsoluteFilePath = Repl.getFilePath();
             Files.makeAbsolutePath(FixAbsoluteFilePath);
-            if (ApplyFixes) {
+            if (ApplyErrorFixes) {
               tooling::Replacement R(FixAbsoluteFilePath, Repl.getOffset(),
                                      Repl.getLength(),
                                      Repl.getReplacementText());
@@ -169,15 +208,13 @@ public:
                                                  Repl.getReplacementText());
           }
 
-          if (ApplyFixes)
+          if (ApplyErrorFixes)
             FixLocations.push_back(std::make_pair(FixLoc, CanBeApplied));
         }
       }
     }
-    for (auto Fix : FixLocations) {
-      Diags.Report(Fix.first, Fix.second ? diag::note_fixit_applied
-                                         : diag::note_fixit_failed);
-    }
+    for (auto Fix : FixLocations)
+      reportFixNote(Fix.first, Fix.second);
     for (const auto &Note : Error.Notes)
       reportNote(Note);
   }
@@ -197,7 +234,7 @@ public:
         }
         StringRef Code = Buffer.get()->getBuffer();
         auto Style = format::getStyle(
-            *Context.getOptionsForFile(File).FormatStyle, File, "none");
+            *Context.getOptionsForFile(File)->FormatStyle, File, "none");
         if (!Style) {
           llvm::errs() << llvm::toString(Style.takeError()) << "\n";
           continue;
@@ -243,6 +280,11 @@ private:
     return SourceMgr.getLocForStartOfFile(ID).getLocWithOffset(Offset);
   }
 
+  void reportFixNote(SourceLocation Loc, bool Applied) {
+    Diags.Report(Loc,
+                 Applied ? diag::note_fixit_applied : diag::note_fixit_failed);
+  }
+
   void reportNote(const tooling::DiagnosticMessage &Message) {
     SourceLocation Loc = getLocation(Message.FilePath, Message.FileOffset);
     Diags.Report(Loc, Diags.getCustomDiagID(DiagnosticsEngine::Note, "%0"))
@@ -263,31 +305,298 @@ private:
   unsigned WarningsAsErrors;
 };
 
+namespace {
+
 class ClangTidyASTConsumer : public MultiplexConsumer {
 public:
   ClangTidyASTConsumer(std::vector<std::unique_ptr<ASTConsumer>> Consumers,
                        std::unique_ptr<ast_matchers::MatchFinder> Finder,
-                       std::vector<std::unique_ptr<ClangTidyCheck>> Checks)
+                       std::vector<std::unique_ptr<ClangTidyCheck>> Checks,
+                       std::unique_ptr<ClangTidySharedVisitor> SharedVisitor)
       : MultiplexConsumer(std::move(Consumers)), Finder(std::move(Finder)),
-        Checks(std::move(Checks)) {}
+        Checks(std::move(Checks)), SharedVisitor(std::move(SharedVisitor)) {}
 
 private:
   std::unique_ptr<ast_matchers::MatchFinder> Finder;
   std::vector<std::unique_ptr<ClangTidyCheck>> Checks;
+  std::unique_ptr<ClangTidySharedVisitor> SharedVisitor;
+};
+
+/// \brief Traverses nodes in the same way \c MatchFinder::matchAST traverses
+/// them and matches them one by one using \c MatchFinder::match.
+class NodeMatchVisitor : public RecursiveASTVisitor<NodeMatchVisitor> {
+  typedef RecursiveASTVisitor<NodeMatchVisitor> Base;
+
+public:
+  NodeMatchVisitor(ast_matchers::MatchFinder &Finder, ASTContext &Context)
+      : Finder(Finder), Context(Context) {}
+
+  bool shouldVisitTemplateInstantiations() const { return true; }
+  bool shouldVisitImplicitCode() const { return true; }
+
+  bool TraverseDecl(Decl *D) {
+    if (!D)
+      return true;
+    Finder.match(*D, Context);
+    return Base::TraverseDecl(D);
+  }
+
+  bool TraverseStmt(Stmt *S, DataRecursionQueue *Queue = nullptr) {
+    if (!S)
+      return true;
+    Finder.match(*S, Context);
+    return Base::TraverseStmt(S);
+  }
+
+  bool TraverseType(QualType T) {
+    Finder.match(T, Context);
+    return Base::TraverseType(T);
+  }
+
+  bool TraverseTypeLoc(TypeLoc TL) {
+    // Like MatchFinder, match both the TypeLoc and its QualType.
+    Finder.match(TL, Context);
+    Finder.match(TL.getType(), Context);
+    return Base::TraverseTypeLoc(TL);
+  }
+
+  bool TraverseNestedNameSpecifier(NestedNameSpecifier *NNS) {
+    if (!NNS)
+      return true;
+    Finder.match(*NNS, Context);
+    return Base::TraverseNestedNameSpecifier(NNS);
+  }
+
+  bool TraverseNestedNameSpecifierLoc(NestedNameSpecifierLoc NNS) {
+    if (!NNS)
+      return true;
+    Finder.match(NNS, Context);
+    // The NestedNameSpecifier itself is traversed in the Loc hierarchy, so we
+    // only need to match it here.
+    if (NNS.hasQualifier())
+      Finder.match(*NNS.getNestedNameSpecifier(), Context);
+    return Base::TraverseNestedNameSpecifierLoc(NNS);
+  }
+
+  bool TraverseConstructorInitializer(CXXCtorInitializer *CtorInit) {
+    if (!CtorInit)
+      return true;
+    Finder.match(*CtorInit, Context);
+    return Base::TraverseConstructorInitializer(CtorInit);
+  }
+
+private:
+  ast_matchers::MatchFinder &Finder;
+  ASTContext &Context;
+};
+
+/// \brief Runs the matchers of a \c MatchFinder on the parts of a translation
+/// unit that intersect the line ranges of a line filter.
+///
+/// Top-level declarations (and declarations in top-level namespaces and linkage
+/// specifications) that don't intersect any of the line ranges are skipped.
+/// All other nodes are matched by a \c NodeMatchVisitor.
+class LineFilterMatchVisitor {
+public:
+  LineFilterMatchVisitor(ast_matchers::MatchFinder &Finder,
+                         ASTContext &Context,
+                         ArrayRef<FileFilter> LineFilter)
+      : Finder(Finder), Context(Context), LineFilter(LineFilter),
+        Matcher(Finder, Context) {}
+
+  void matchTranslationUnit() {
+    TranslationUnitDecl *TU = Context.getTranslationUnitDecl();
+    Finder.match(*TU, Context);
+    traverseFilteredDecls(TU);
+  }
+
+private:
+  void traverseFilteredDecls(DeclContext *DC) {
+    for (Decl *D : DC->decls()) {
+      if (!intersectsLineFilter(D))
+        continue;
+      // Namespaces usually span whole files, look at their contents instead.
+      if (isa<NamespaceDecl>(D) || isa<LinkageSpecDecl>(D)) {
+        Finder.match(*D, Context);
+        traverseFilteredDecls(cast<DeclContext>(D));
+        continue;
+      }
+      Matcher.TraverseDecl(D);
+    }
+  }
+
+  /// \brief Returns \c false if diagnostics in the source range of \p D can't
+  /// pass the line filter.
+  bool intersectsLineFilter(const Decl *D) const {
+    const SourceManager &SM = Context.getSourceManager();
+    SourceRange Range = D->getSourceRange();
+    if (Range.isInvalid())
+      return true;
+    SourceLocation Begin = SM.getExpansionLoc(Range.getBegin());
+    SourceLocation End = SM.getExpansionLoc(Range.getEnd());
+    FileID FID = SM.getFileID(Begin);
+    const FileEntry *File = SM.getFileEntryForID(FID);
+    if (!File || SM.getFileID(End) != FID)
+      return true;
+
+    unsigned BeginLine = SM.getExpansionLineNumber(Begin);
+    unsigned EndLine = SM.getExpansionLineNumber(End);
+    // This mirrors ClangTidyDiagnosticConsumer::passesLineFilter.
+    for (const FileFilter &Filter : LineFilter) {
+      if (!StringRef(File->getName()).endswith(Filter.Name))
+        continue;
+      if (Filter.LineRanges.empty())
+        return true;
+      for (const FileFilter::LineRange &Range : Filter.LineRanges) {
+        if (Range.first <= EndLine && BeginLine <= Range.second)
+          return true;
+      }
+      return false;
+    }
+    return false;
+  }
+
+  ast_matchers::MatchFinder &Finder;
+  ASTContext &Context;
+  ArrayRef<FileFilter> LineFilter;
+  NodeMatchVisitor Matcher;
+};
+
+/// \brief Runs the matchers of a \c MatchFinder using a
+/// \c LineFilterMatchVisitor.
+///
+/// As \c MatchFinder doesn't expose its callbacks, only \p Checks are notified
+/// about the start and the end of the translation unit.
+class LineFilterMatchConsumer : public ASTConsumer {
+public:
+  LineFilterMatchConsumer(ast_matchers::MatchFinder &Finder,
+                          std::vector<ClangTidyCheck *> Checks,
+                          ArrayRef<FileFilter> LineFilter)
+      : Finder(Finder), Checks(std::move(Checks)), LineFilter(LineFilter) {}
+
+  void HandleTranslationUnit(ASTContext &Context) override {
+    for (ClangTidyCheck *Check : Checks)
+      Check->onStartOfTranslationUnit();
+    LineFilterMatchVisitor(Finder, Context, LineFilter).matchTranslationUnit();
+    for (ClangTidyCheck *Check : Checks)
+      Check->onEndOfTranslationUnit();
+  }
+
+private:
+  ast_matchers::MatchFinder &Finder;
+  std::vector<ClangTidyCheck *> Checks;
+  ArrayRef<FileFilter> LineFilter;
+};
+
+/// \brief Runs the matchers of serial-only checks on the whole translation unit
+/// in this process and the matchers of all other checks on chunks of its
+/// top-level declarations in worker processes.
+///
+/// Namespaces and linkage specifications are split into their declarations.
+/// The chunks are contiguous and have roughly the same size in the source.
+class ParallelMatchConsumer : public ASTConsumer {
+public:
+  ParallelMatchConsumer(ClangTidyContext &Context,
+                        ast_matchers::MatchFinder &SerialFinder,
+                        std::unique_ptr<ast_matchers::MatchFinder> ChunkFinder,
+                        std::vector<ClangTidyCheck *> ChunkChecks,
+                        unsigned Jobs)
+      : Context(Context), SerialFinder(SerialFinder),
+        ChunkFinder(std::move(ChunkFinder)),
+        ChunkChecks(std::move(ChunkChecks)), Jobs(Jobs) {}
+
+  void HandleTranslationUnit(ASTContext &AST) override {
+    std::vector<Decl *> Containers;
+    std::vector<Decl *> Decls;
+    collectDecls(AST.getTranslationUnitDecl(), Containers, Decls);
+
+    // Chunk I contains the declarations from ChunkBegins[I] to
+    // ChunkBegins[I + 1].
+    const SourceManager &SM = AST.getSourceManager();
+    std::vector<uint64_t> Sizes;
+    uint64_t TotalSize = 0;
+    for (const Decl *D : Decls) {
+      Sizes.push_back(getSize(D, SM));
+      TotalSize += Sizes.back();
+    }
+    std::vector<size_t> ChunkBegins(1, 0);
+    uint64_t Size = 0;
+    for (size_t I = 0; I + 1 < Decls.size(); ++I) {
+      Size += Sizes[I];
+      if (ChunkBegins.size() < Jobs &&
+          Size * Jobs >= TotalSize * ChunkBegins.size())
+        ChunkBegins.push_back(I + 1);
+    }
+    ChunkBegins.push_back(Decls.size());
+    unsigned NumChunks = Decls.empty() ? 0 : ChunkBegins.size() - 1;
+
+    for (ClangTidyCheck *Check : ChunkChecks)
+      Check->onStartOfTranslationUnit();
+    matchInWorkerProcesses(
+        Context, AST, NumChunks,
+        [&](unsigned Chunk) {
+          NodeMatchVisitor Matcher(*ChunkFinder, AST);
+          for (size_t I = ChunkBegins[Chunk]; I < ChunkBegins[Chunk + 1]; ++I)
+            Matcher.TraverseDecl(Decls[I]);
+        },
+        [&] {
+          SerialFinder.matchAST(AST);
+          ChunkFinder->match(*AST.getTranslationUnitDecl(), AST);
+          for (Decl *D : Containers)
+            ChunkFinder->match(*D, AST);
+        });
+    for (ClangTidyCheck *Check : ChunkChecks)
+      Check->onEndOfTranslationUnit();
+  }
+
+private:
+  static void collectDecls(DeclContext *DC, std::vector<Decl *> &Containers,
+                           std::vector<Decl *> &Decls) {
+    for (Decl *D : DC->decls()) {
+      if (isa<NamespaceDecl>(D) || isa<LinkageSpecDecl>(D)) {
+        Containers.push_back(D);
+        collectDecls(cast<DeclContext>(D), Containers, Decls);
+      } else {
+        Decls.push_back(D);
+      }
+    }
+  }
+
+  /// \brief Returns the number of characters \p D spans in the source, or 1
+  /// if it doesn't span a single file.
+  static uint64_t getSize(const Decl *D, const SourceManager &SM) {
+    SourceRange Range = D->getSourceRange();
+    if (Range.isInvalid())
+      return 1;
+    std::pair<FileID, unsigned> Begin =
+        SM.getDecomposedExpansionLoc(Range.getBegin());
+    std::pair<FileID, unsigned> End =
+        SM.getDecomposedExpansionLoc(Range.getEnd());
+    if (Begin.first != End.first || End.second < Begin.second)
+      return 1;
+    return End.second - Begin.second + 1;
+  }
+
+  ClangTidyContext &Context;
+  ast_matchers::MatchFinder &SerialFinder;
+  std::unique_ptr<ast_matchers::MatchFinder> ChunkFinder;
+  std::vector<ClangTidyCheck *> ChunkChecks;
+  unsigned Jobs;
+};
+
+/// \brief Collects the files a translation unit depends on for the result
+/// cache. System headers are included, as they change on toolchain updates.
+class ResultCacheDependencyCollector : public DependencyCollector {
+public:
+  bool needSystemDependencies() override { return true; }
 };
 
 } // namespace
 
 ClangTidyASTConsumerFactory::ClangTidyASTConsumerFactory(
     ClangTidyContext &Context)
-    : Context(Context), CheckFactories(new ClangTidyCheckFactories) {
-  for (ClangTidyModuleRegistry::iterator I = ClangTidyModuleRegistry::begin(),
-                                         E = ClangTidyModuleRegistry::end();
-       I != E; ++I) {
-    std::unique_ptr<ClangTidyModule> Module(I->instantiate());
-    Module->addCheckFactories(*CheckFactories);
-  }
-}
+    : Context(Context),
+      CheckFactories(ClangTidyCheckFactories::getRegistered()) {}
 
 static void setStaticAnalyzerCheckerOpts(const ClangTidyOptions &Opts,
                                          AnalyzerOptionsRef AnalyzerOptions) {
@@ -340,6 +649,7 @@ ClangTidyASTConsumerFactory::CreateASTConsumer(
   Context.setSourceManager(&Compiler.getSourceManager());
   Context.setCurrentFile(File);
   Context.setASTContext(&Compiler.getASTContext());
+  Context.getIncludeGraph().reset();
 
   auto WorkingDir = Compiler.getSourceManager()
                         .getFileManager()
@@ -349,7 +659,7 @@ ClangTidyASTConsumerFactory::CreateASTConsumer(
     Context.setCurrentBuildDirectory(WorkingDir.get());
 
   std::vector<std::unique_ptr<ClangTidyCheck>> Checks;
-  CheckFactories->createChecks(&Context, Checks);
+  CheckFactories.createChecks(&Context, Checks);
 
   ast_matchers::MatchFinder::MatchFinderOptions FinderOptions;
   if (auto *P = Context.getCheckProfileData())
@@ -358,14 +668,50 @@ ClangTidyASTConsumerFactory::CreateASTConsumer(
   std::unique_ptr<ast_matchers::MatchFinder> Finder(
       new ast_matchers::MatchFinder(std::move(FinderOptions)));
 
+  const ClangTidyGlobalOptions &GlobalOptions = Context.getGlobalOptions();
+  // Matching nodes one by one would overwrite the profile of each previous
+  // node, so profiling always uses the full traversal.
+  bool RestrictToLineFilter = GlobalOptions.RestrictToLineFilter &&
+                              !GlobalOptions.LineFilter.empty() &&
+                              !Context.getCheckProfileData();
+  // The matchers of checks that aren't serial-only are registered with
+  // ChunkFinder if chunks of the translation unit are matched in worker
+  // processes. The shared traversal only runs in this process, so checks
+  // collecting nodes in it are treated as serial-only.
+  std::unique_ptr<ast_matchers::MatchFinder> ChunkFinder;
+  std::vector<ClangTidyCheck *> ChunkChecks;
+  if (GlobalOptions.MatchingJobs > 1 && !RestrictToLineFilter &&
+      !Context.getCheckProfileData())
+    ChunkFinder = llvm::make_unique<ast_matchers::MatchFinder>();
+
+  auto SharedVisitor = llvm::make_unique<ClangTidySharedVisitor>(Context);
   for (auto &Check : Checks) {
-    Check->registerMatchers(&*Finder);
+    Check->registerSharedVisitorCallbacks(*SharedVisitor);
+    if (ChunkFinder && !Check->isSerialOnly() &&
+        !SharedVisitor->isSubscribed(Check.get())) {
+      Check->registerMatchers(&*ChunkFinder);
+      ChunkChecks.push_back(Check.get());
+    } else {
+      Check->registerMatchers(&*Finder);
+    }
     Check->registerPPCallbacks(Compiler);
   }
+  SharedVisitor->registerMatchers(&*Finder);
 
   std::vector<std::unique_ptr<ASTConsumer>> Consumers;
-  if (!Checks.empty())
+  if (!Checks.empty() && RestrictToLineFilter) {
+    std::vector<ClangTidyCheck *> CheckPtrs;
+    for (auto &Check : Checks)
+      CheckPtrs.push_back(Check.get());
+    Consumers.push_back(llvm::make_unique<LineFilterMatchConsumer>(
+        *Finder, std::move(CheckPtrs), GlobalOptions.LineFilter));
+  } else if (!ChunkChecks.empty()) {
+    Consumers.push_back(llvm::make_unique<ParallelMatchConsumer>(
+        Context, *Finder, std::move(ChunkFinder), std::move(ChunkChecks),
+        GlobalOptions.MatchingJobs));
+  } else if (!Checks.empty()) {
     Consumers.push_back(Finder->newASTConsumer());
+  }
 
   AnalyzerOptionsRef AnalyzerOptions = Compiler.getAnalyzerOpts();
   // FIXME: Remove this option once clang's cfg-temporary-dtors option defaults
@@ -387,12 +733,13 @@ ClangTidyASTConsumerFactory::CreateASTConsumer(
     Consumers.push_back(std::move(AnalysisConsumer));
   }
   return llvm::make_unique<ClangTidyASTConsumer>(
-      std::move(Consumers), std::move(Finder), std::move(Checks));
+      std::move(Consumers), std::move(Finder), std::move(Checks),
+      std::move(SharedVisitor));
 }
 
 std::vector<std::string> ClangTidyASTConsumerFactory::getCheckNames() {
   std::vector<std::string> CheckNames;
-  for (const auto &CheckFactory : *CheckFactories) {
+  for (const auto &CheckFactory : CheckFactories) {
     if (Context.isCheckEnabled(CheckFactory.first))
       CheckNames.push_back(CheckFactory.first);
   }
@@ -405,11 +752,36 @@ std::vector<std::string> ClangTidyASTConsumerFactory::getCheckNames() {
 }
 
 ClangTidyOptions::OptionMap ClangTidyASTConsumerFactory::getCheckOptions() {
+  // Checks only read options prefixed with their name and global options,
+  // which don't start with the name of any check. Checks without configured
+  // options store their defaults, which don't require creating them again.
+  llvm::StringSet<> ConfiguredChecks;
+  bool HasGlobalOptions = false;
+  for (const auto &Option : Context.getOptions().CheckOptions) {
+    StringRef Key = Option.first;
+    if (Key.startswith(AnalyzerCheckNamePrefix))
+      continue;
+    StringRef CheckName = Key.split('.').first;
+    if (CheckFactories.isRegistered(CheckName))
+      ConfiguredChecks.insert(CheckName);
+    else
+      HasGlobalOptions = true;
+  }
+
   ClangTidyOptions::OptionMap Options;
-  std::vector<std::unique_ptr<ClangTidyCheck>> Checks;
-  CheckFactories->createChecks(&Context, Checks);
-  for (const auto &Check : Checks)
+  for (const auto &CheckFactory : CheckFactories) {
+    if (!Context.isCheckEnabled(CheckFactory.first))
+      continue;
+    if (!HasGlobalOptions && !ConfiguredChecks.count(CheckFactory.first)) {
+      const ClangTidyOptions::OptionMap &Defaults =
+          CheckFactories.getDefaultOptions(CheckFactory.first);
+      Options.insert(Defaults.begin(), Defaults.end());
+      continue;
+    }
+    std::unique_ptr<ClangTidyCheck> Check(
+        CheckFactory.second(CheckFactory.first, &Context));
     Check->storeOptions(Options);
+  }
   return Options;
 }
 
@@ -472,15 +844,56 @@ ClangTidyOptions::OptionMap getCheckOptions(const ClangTidyOptions &Options) {
   return Factory.getCheckOptions();
 }
 
-void runClangTidy(clang::tidy::ClangTidyContext &Context,
-                  const CompilationDatabase &Compilations,
-                  ArrayRef<std::string> InputFiles, ProfileData *Profile) {
-  ClangTool Tool(Compilations, InputFiles);
+namespace {
 
+/// \brief Provides the options of a \c ClangTidyContext shared by contexts
+/// analyzing translation units on other threads.
+class SharedContextOptionsProvider : public ClangTidyOptionsProvider {
+public:
+  SharedContextOptionsProvider(const ClangTidyContext &Context)
+      : Context(Context) {}
+
+  const ClangTidyGlobalOptions &getGlobalOptions() override {
+    return Context.getGlobalOptions();
+  }
+
+  std::vector<OptionsSource> getRawOptions(StringRef FileName) override {
+    return {OptionsSource(*Context.getOptionsForFile(FileName),
+                          "shared clang-tidy context")};
+  }
+
+  std::shared_ptr<const ClangTidyOptions>
+  getSharedOptions(StringRef FileName) override {
+    return Context.getOptionsForFile(FileName);
+  }
+
+private:
+  const ClangTidyContext &Context;
+};
+
+} // end anonymous namespace
+
+/// \brief Passes the errors stored in \p Context to \p Sink and removes them
+/// from the context. Does nothing if there is no sink.
+static void flushErrors(ClangTidyContext &Context, ClangTidyErrorSink *Sink) {
+  if (!Sink || Context.getErrors().empty())
+    return;
+  Sink->handleErrors(Context.getErrors());
+  Context.clearErrors();
+}
+
+static void runClangTidyOnFiles(ClangTidyContext &Context,
+                                const CompilationDatabase &Compilations,
+                                ArrayRef<std::string> InputFiles,
+                                ProfileData *Profile,
+                                ClangTidyResultCache *Cache,
+                                ClangTidyErrorSink *Sink) {
   // Add extra arguments passed by the clang-tidy command-line.
   ArgumentsAdjuster PerFileExtraArgumentsInserter =
       [&Context](const CommandLineArguments &Args, StringRef Filename) {
-        ClangTidyOptions Opts = Context.getOptionsForFile(Filename);
+        std::shared_ptr<const ClangTidyOptions> Options =
+            Context.getOptionsForFile(Filename);
+        const ClangTidyOptions &Opts = *Options;
         CommandLineArguments AdjustedArgs = Args;
         if (Opts.ExtraArgsBefore) {
           auto I = AdjustedArgs.begin();
@@ -511,68 +924,329 @@ void runClangTidy(clang::tidy::ClangTidyContext &Context,
         return AdjustedArgs;
       };
 
-  Tool.appendArgumentsAdjuster(PerFileExtraArgumentsInserter);
-  Tool.appendArgumentsAdjuster(PluginArgumentsRemover);
   if (Profile)
     Context.setCheckProfileData(Profile);
 
   ClangTidyDiagnosticConsumer DiagConsumer(Context);
 
-  Tool.setDiagnosticConsumer(&DiagConsumer);
-
   class ActionFactory : public FrontendActionFactory {
   public:
-    ActionFactory(ClangTidyContext &Context) : ConsumerFactory(Context) {}
-    FrontendAction *create() override { return new Action(&ConsumerFactory); }
+    ActionFactory(ClangTidyContext &Context, ClangTidyErrorSink *Sink)
+        : Context(Context), Sink(Sink), ConsumerFactory(Context),
+          Dependencies(nullptr) {}
+    FrontendAction *create() override {
+      return new Action(&ConsumerFactory, Dependencies);
+    }
+
+    bool
+    runInvocation(std::shared_ptr<CompilerInvocation> Invocation,
+                  FileManager *Files,
+                  std::shared_ptr<PCHContainerOperations> PCHContainerOps,
+                  DiagnosticConsumer *DiagConsumer) override {
+      bool Success = FrontendActionFactory::runInvocation(
+          std::move(Invocation), Files, std::move(PCHContainerOps),
+          DiagConsumer);
+      // The diagnostic consumer has stored the errors of the translation unit
+      // in the context when the action finished.
+      flushErrors(Context, Sink);
+      return Success;
+    }
+
+    /// \brief Records the files each subsequently analyzed translation unit
+    /// depends on in \p Collector.
+    void setDependencyCollector(DependencyCollector *Collector) {
+      Dependencies = Collector;
+    }
 
   private:
     class Action : public ASTFrontendAction {
     public:
-      Action(ClangTidyASTConsumerFactory *Factory) : Factory(Factory) {}
+      Action(ClangTidyASTConsumerFactory *Factory,
+             DependencyCollector *Dependencies)
+          : Factory(Factory), Dependencies(Dependencies) {}
       std::unique_ptr<ASTConsumer> CreateASTConsumer(CompilerInstance &Compiler,
                                                      StringRef File) override {
+        if (Dependencies)
+          Dependencies->attachToPreprocessor(Compiler.getPreprocessor());
         return Factory->CreateASTConsumer(Compiler, File);
       }
 
     private:
       ClangTidyASTConsumerFactory *Factory;
+      DependencyCollector *Dependencies;
     };
 
+    ClangTidyContext &Context;
+    ClangTidyErrorSink *Sink;
     ClangTidyASTConsumerFactory ConsumerFactory;
+    DependencyCollector *Dependencies;
   };
 
-  ActionFactory Factory(Context);
-  Tool.run(&Factory);
+  // With a cache, the errors are flushed after they have been stored in it.
+  ActionFactory Factory(Context, Cache ? nullptr : Sink);
+  auto RunTool = [&](ArrayRef<std::string> Files) {
+    ClangTool Tool(Compilations, Files);
+    Tool.appendArgumentsAdjuster(PerFileExtraArgumentsInserter);
+    Tool.appendArgumentsAdjuster(PluginArgumentsRemover);
+    Tool.setDiagnosticConsumer(&DiagConsumer);
+    return Tool.run(&Factory);
+  };
+
+  if (!Cache) {
+    RunTool(InputFiles);
+    flushErrors(Context, Sink);
+    return;
+  }
+
+  // Each file is analyzed by a separate tool run, so that its errors can be
+  // told apart from the errors of other files and stored in the cache.
+  for (const std::string &File : InputFiles) {
+    std::string AbsolutePath = getAbsolutePath(File);
+    std::vector<CompileCommand> Commands =
+        Compilations.getCompileCommands(AbsolutePath);
+    std::string Key =
+        Cache->getKey(Commands, *Context.getOptionsForFile(AbsolutePath),
+                      Context.getGlobalOptions());
+    if (Cache->replay(Key, Context)) {
+      flushErrors(Context, Sink);
+      continue;
+    }
+
+    ResultCacheDependencyCollector Dependencies;
+    Factory.setDependencyCollector(&Dependencies);
+    size_t FirstError = Context.getErrors().size();
+    ClangTidyStats StatsBefore = Context.getStats();
+    int Status = RunTool(File);
+    Factory.setDependencyCollector(nullptr);
+
+    // Don't cache results of failed runs: compilation errors may be caused by
+    // missing files, which aren't recorded as dependencies.
+    ArrayRef<ClangTidyError> Errors = Context.getErrors().slice(FirstError);
+    if (Status != 0 || llvm::any_of(Errors, [](const ClangTidyError &Error) {
+          return Error.DiagLevel == ClangTidyError::Error;
+        })) {
+      flushErrors(Context, Sink);
+      continue;
+    }
+
+    const ClangTidyStats &StatsAfter = Context.getStats();
+    ClangTidyStats Stats;
+    Stats.ErrorsDisplayed =
+        StatsAfter.ErrorsDisplayed - StatsBefore.ErrorsDisplayed;
+    Stats.ErrorsIgnoredCheckFilter = StatsAfter.ErrorsIgnoredCheckFilter -
+                                     StatsBefore.ErrorsIgnoredCheckFilter;
+    Stats.ErrorsIgnoredNOLINT =
+        StatsAfter.ErrorsIgnoredNOLINT - StatsBefore.ErrorsIgnoredNOLINT;
+    Stats.ErrorsIgnoredNonUserCode = StatsAfter.ErrorsIgnoredNonUserCode -
+                                     StatsBefore.ErrorsIgnoredNonUserCode;
+    Stats.ErrorsIgnoredLineFilter = StatsAfter.ErrorsIgnoredLineFilter -
+                                    StatsBefore.ErrorsIgnoredLineFilter;
+
+    std::vector<std::string> DependencyFiles =
+        Dependencies.getDependencies().vec();
+    DependencyFiles.push_back(AbsolutePath);
+    Cache->store(Key, DependencyFiles,
+                 Commands.empty() ? StringRef()
+                                 : StringRef(Commands.front().Directory),
+                 Errors, Stats);
+    flushErrors(Context, Sink);
+  }
 }
 
-void handleErrors(ClangTidyContext &Context, bool Fix,
-                  unsigned &WarningsAsErrorsCount) {
-  ErrorReporter Reporter(Context, Fix);
-  vfs::FileSystem &FileSystem =
-      *Reporter.getSourceManager().getFileManager().getVirtualFileSystem();
-  auto InitialWorkingDir = FileSystem.getCurrentWorkingDirectory();
-  if (!InitialWorkingDir)
+namespace {
+
+/// \brief Remembers which errors were already reported without keeping a copy
+/// of every error: file paths, check names and messages are interned, so that
+/// each of them is stored only once.
+class ReportedErrorSet {
+public:
+  /// \brief Returns true if no error of the same check with the same location
+  /// and message was inserted before.
+  bool insert(const ClangTidyError &Error) {
+    return Keys
+        .emplace(intern(Error.Message.FilePath), Error.Message.FileOffset,
+                 intern(Error.DiagnosticName), intern(Error.Message.Message))
+        .second;
+  }
+
+private:
+  const char *intern(StringRef Str) {
+    return Strings.insert(Str).first->getKey().data();
+  }
+
+  llvm::StringSet<> Strings;
+  std::set<std::tuple<const char *, unsigned, const char *, const char *>>
+      Keys;
+};
+
+} // end anonymous namespace
+
+void runClangTidy(clang::tidy::ClangTidyContext &Context,
+                  const CompilationDatabase &Compilations,
+                  ArrayRef<std::string> InputFiles, ProfileData *Profile,
+                  ClangTidyResultCache *Cache, unsigned Jobs,
+                  ClangTidyErrorSink *Sink) {
+  if (Jobs <= 1 || InputFiles.size() <= 1) {
+    runClangTidyOnFiles(Context, Compilations, InputFiles, Profile, Cache,
+                        Sink);
+    return;
+  }
+
+  // ClangTool changes the process-wide working directory to the directory of
+  // each compile command and restores the initial one afterwards, so only
+  // translation units built in the same directory can be analyzed at the same
+  // time. Analyze the files of one directory after another and make it the
+  // working directory while doing so.
+  std::map<std::string, std::vector<std::string>> FilesByDirectory;
+  for (const std::string &File : InputFiles) {
+    std::string AbsolutePath = getAbsolutePath(File);
+    std::vector<CompileCommand> Commands =
+        Compilations.getCompileCommands(AbsolutePath);
+    FilesByDirectory[Commands.empty() ? "" : Commands.front().Directory]
+        .push_back(std::move(AbsolutePath));
+  }
+  SmallString<256> InitialDirectory;
+  if (llvm::sys::fs::current_path(InitialDirectory))
     llvm::report_fatal_error("Cannot get current working path.");
 
-  for (const ClangTidyError &Error : Context.getErrors()) {
-    if (!Error.BuildDirectory.empty()) {
-      // By default, the working directory of file system is the current
-      // clang-tidy running directory.
-      //
-      // Change the directory to the one used during the analysis.
-      FileSystem.setCurrentWorkingDirectory(Error.BuildDirectory);
+  // Each thread analyzes translation units with its own context and moves the
+  // errors into the shared context or the sink after each translation unit.
+  // Diagnostics in headers included by several translation units are stored
+  // and counted only once.
+  std::vector<std::unique_ptr<ClangTidyContext>> WorkerContexts;
+  std::vector<ProfileData> WorkerProfiles(Jobs);
+  for (unsigned I = 0; I < Jobs; ++I)
+    WorkerContexts.push_back(llvm::make_unique<ClangTidyContext>(
+        llvm::make_unique<SharedContextOptionsProvider>(Context)));
+  std::mutex ErrorsMutex;
+  ReportedErrorSet StoredErrors;
+  for (const ClangTidyError &Error : Context.getErrors())
+    StoredErrors.insert(Error);
+  unsigned DuplicateErrors = 0;
+
+  llvm::ThreadPool Pool(Jobs);
+  for (const auto &DirectoryAndFiles : FilesByDirectory) {
+    if (!DirectoryAndFiles.first.empty() &&
+        llvm::sys::fs::set_current_path(DirectoryAndFiles.first))
+      llvm::errs() << "Cannot change the working directory to "
+                   << DirectoryAndFiles.first << "\n";
+    ArrayRef<std::string> Files = DirectoryAndFiles.second;
+    std::atomic<size_t> NextFile(0);
+    for (unsigned I = 0; I < Jobs && I < Files.size(); ++I) {
+      Pool.async([&, I] {
+        ClangTidyContext &WorkerContext = *WorkerContexts[I];
+        for (size_t Index = NextFile++; Index < Files.size();
+             Index = NextFile++) {
+          runClangTidyOnFiles(WorkerContext, Compilations, Files[Index],
+                              Profile ? &WorkerProfiles[I] : nullptr, Cache,
+                              /*Sink=*/nullptr);
+          std::vector<ClangTidyError> NewErrors;
+          std::lock_guard<std::mutex> Lock(ErrorsMutex);
+          for (const ClangTidyError &Error : WorkerContext.getErrors()) {
+            if (StoredErrors.insert(Error))
+              NewErrors.push_back(Error);
+            else
+              ++DuplicateErrors;
+          }
+          if (Sink)
+            Sink->handleErrors(NewErrors);
+          else
+            Context.storeResults(NewErrors, ClangTidyStats());
+          WorkerContext.clearErrors();
+        }
+      });
     }
-    Reporter.reportDiagnostic(Error);
-    // Return to the initial directory to correctly resolve next Error.
-    FileSystem.setCurrentWorkingDirectory(InitialWorkingDir.get());
+    Pool.wait();
+  }
+  if (llvm::sys::fs::set_current_path(InitialDirectory))
+    llvm::report_fatal_error("Cannot restore the working directory.");
+
+  ClangTidyStats Stats;
+  for (unsigned I = 0; I < Jobs; ++I) {
+    const ClangTidyStats &WorkerStats = WorkerContexts[I]->getStats();
+    Stats.ErrorsDisplayed += WorkerStats.ErrorsDisplayed;
+    Stats.ErrorsIgnoredCheckFilter += WorkerStats.ErrorsIgnoredCheckFilter;
+    Stats.ErrorsIgnoredNOLINT += WorkerStats.ErrorsIgnoredNOLINT;
+    Stats.ErrorsIgnoredNonUserCode += WorkerStats.ErrorsIgnoredNonUserCode;
+    Stats.ErrorsIgnoredLineFilter += WorkerStats.ErrorsIgnoredLineFilter;
+    if (!Profile)
+      continue;
+    for (const auto &Record : WorkerProfiles[I].Records)
+      Profile->Records[Record.getKey()] += Record.getValue();
   }
+  // The duplicates were counted as displayed by each worker that found them.
+  Stats.ErrorsDisplayed -= DuplicateErrors;
+  Context.storeResults({}, Stats);
+}
+
+void handleErrors(ClangTidyContext &Context, bool Fix,
+                  unsigned &WarningsAsErrorsCount) {
+  ErrorReporter Reporter(Context, Fix);
+  Reporter.reportDiagnostics(Context.getErrors());
   Reporter.Finish();
   WarningsAsErrorsCount += Reporter.getWarningsAsErrorsCount();
 }
 
+ClangTidyErrorSink::~ClangTidyErrorSink() {}
+
+StreamingErrorHandler::StreamingErrorHandler(ClangTidyContext &Context,
+                                             bool Fix, bool FixErrors,
+                                             StringRef MainFilePath,
+                                             StringRef ExportFixesFile)
+    : Reporter(llvm::make_unique<ErrorReporter>(Context, Fix)),
+      FixErrors(FixErrors), MainFilePath(MainFilePath),
+      ExportFixesFile(ExportFixesFile), ExportFailed(false),
+      FoundCompilerErrors(false) {}
+
+StreamingErrorHandler::~StreamingErrorHandler() {}
+
+void StreamingErrorHandler::handleErrors(ArrayRef<ClangTidyError> Errors) {
+  // The fixes of a translation unit with compiler errors are dropped, the
+  // fixes of the other translation units are still applied.
+  bool HasCompilerErrors =
+      llvm::any_of(Errors, [](const ClangTidyError &Error) {
+        return Error.DiagLevel == ClangTidyError::Error;
+      });
+  if (HasCompilerErrors)
+    FoundCompilerErrors = true;
+  Reporter->reportDiagnostics(Errors,
+                              /*CollectFixes=*/!HasCompilerErrors || FixErrors);
+  if (ExportFixesFile.empty() || Errors.empty() || ExportFailed)
+    return;
+
+  // The diagnostics of each translation unit are written as a separate
+  // document, so that they don't need to be kept until the end of the run.
+  if (!ExportStream) {
+    std::error_code EC;
+    ExportStream = llvm::make_unique<llvm::raw_fd_ostream>(
+        ExportFixesFile, EC, llvm::sys::fs::F_None);
+    if (EC) {
+      llvm::errs() << "Error opening output file: " << EC.message() << '\n';
+      ExportStream.reset();
+      ExportFailed = true;
+      return;
+    }
+  }
+  exportReplacements(MainFilePath, Errors, *ExportStream);
+}
+
+bool StreamingErrorHandler::finish(unsigned &WarningsAsErrorsCount) {
+  Reporter->Finish();
+  WarningsAsErrorsCount += Reporter->getWarningsAsErrorsCount();
+  if (ExportStream) {
+    ExportStream->close();
+    if (ExportStream->has_error()) {
+      llvm::errs() << "Error writing output file " << ExportFixesFile << '\n';
+      ExportStream->clear_error();
+      ExportFailed = true;
+    }
+    ExportStream.reset();
+  }
+  return !ExportFailed;
+}
+
 void exportReplacements(const llvm::StringRef MainFilePath,
-                        const std::vector<ClangTidyError> &Errors,
-                        raw_ostream &OS) {
+                        ArrayRef<ClangTidyError> Errors, raw_ostream &OS) {
   TranslationUnitDiagnostics TUD;
   TUD.MainSourceFile = MainFilePath;
   for (const auto &Error : Errors) {
@@ -12,6 +12,7 @@
 
 #include "ClangTidyDiagnosticConsumer.h"
 #include "ClangTidyOptions.h"
+#include "ClangTidySharedVisitor.h"
 #include "clang/ASTMatchers/ASTMatchFinder.h"
 #include "clang/Basic/Diagnostic.h"
 #include "clang/Basic/SourceManager.h"
@@ -162,6 +163,39 @@ public:
   /// work in here.
   virtual void check(const ast_matchers::MatchFinder::MatchResult &Result) {}
 
+  /// \brief Override this to subscribe to node kinds with \p Visitor.
+  ///
+  /// This should be used instead of running a ``RecursiveASTVisitor`` over the
+  /// whole translation unit: all checks share a single traversal, which runs
+  /// before the matchers of the translation unit and calls ``visitStmt`` and
+  /// ``visitDecl`` for the nodes of the subscribed kinds.
+  virtual void registerSharedVisitorCallbacks(ClangTidySharedVisitor &Visitor) {
+  }
+
+  /// \brief Called by the shared traversal for each statement of a class the
+  /// check subscribed to in ``registerSharedVisitorCallbacks``.
+  virtual void visitStmt(const Stmt *S,
+                         const ast_matchers::MatchFinder::MatchResult &Result) {
+  }
+
+  /// \brief Called by the shared traversal for each declaration of a kind the
+  /// check subscribed to in ``registerSharedVisitorCallbacks``.
+  virtual void visitDecl(const Decl *D,
+                         const ast_matchers::MatchFinder::MatchResult &Result) {
+  }
+
+  /// \brief Override this to return \c true if the check needs to see the
+  /// whole translation unit, e.g. because it collects nodes and reports them
+  /// in ``onEndOfTranslationUnit`` or inserts headers with
+  /// \c utils::IncludeInserter, which inserts each header only once.
+  /// Checks subscribed to the shared traversal are always treated as
+  /// serial-only, as the traversal only runs in the main process.
+  ///
+  /// The matchers of all other checks may run on chunks of the translation
+  /// unit in worker processes, each with its own copy of the check, if
+  /// ``ClangTidyGlobalOptions::MatchingJobs`` is greater than 1.
+  virtual bool isSerialOnly() const { return false; }
+
   /// \brief Add a diagnostic with the check's name.
   DiagnosticBuilder diag(SourceLocation Loc, StringRef Description,
                          DiagnosticIDs::Level Level = DiagnosticIDs::Warning);
@@ -185,9 +219,24 @@ protected:
   StringRef getCurrentMainFile() const { return Context->getCurrentFile(); }
   /// \brief Returns the language options from the context.
   LangOptions getLangOpts() const { return Context->getLangOpts(); }
+  /// \brief Returns the parent map of the current translation unit. Prefer it
+  /// to \c ASTContext::getParents, which builds the parent map of the whole
+  /// translation unit.
+  ClangTidyParentMap &getParentMap() const { return Context->getParentMap(); }
+  /// \brief Returns the raw tokens of the current translation unit. Prefer
+  /// them to lexing the source again.
+  ClangTidyTokenCache &getTokenCache() const {
+    return Context->getTokenCache();
+  }
+  /// \brief Returns the inclusion directives of the current translation unit.
+  /// Attach it in \c registerPPCallbacks instead of recording them again.
+  ClangTidyIncludeGraph &getIncludeGraph() const {
+    return Context->getIncludeGraph();
+  }
 };
 
 class ClangTidyCheckFactories;
+class ClangTidyResultCache;
 
 class ClangTidyASTConsumerFactory {
 public:
@@ -205,7 +254,7 @@ public:
 
 private:
   ClangTidyContext &Context;
-  std::unique_ptr<ClangTidyCheckFactories> CheckFactories;
+  const ClangTidyCheckFactories &CheckFactories;
 };
 
 /// \brief Fills the list of check names that are enabled when the provided
@@ -220,14 +269,42 @@ std::vector<std::string> getCheckNames(const ClangTidyOptions &Options);
 /// Options.
 ClangTidyOptions::OptionMap getCheckOptions(const ClangTidyOptions &Options);
 
+/// \brief Receives the errors of each translation unit as soon as it has been
+/// analyzed, so that they don't need to be stored until the end of the run.
+class ClangTidyErrorSink {
+public:
+  virtual ~ClangTidyErrorSink();
+
+  /// \brief Called with the errors of every analyzed translation unit, which
+  /// are not stored in the context afterwards.
+  virtual void handleErrors(ArrayRef<ClangTidyError> Errors) = 0;
+};
+
 /// \brief Run a set of clang-tidy checks on a set of files.
 ///
 /// \param Profile if provided, it enables check profile collection in
 /// MatchFinder, and will contain the result of the profile.
+///
+/// \param Cache if provided, the results of translation units whose inputs
+/// didn't change since they were stored in the cache are replayed from it
+/// instead of analyzing them again. The results of all other translation units
+/// are stored in the cache.
+///
+/// \param Jobs the number of threads analyzing translation units
+/// concurrently. Each thread uses its own context and moves the errors of
+/// every analyzed translation unit into \p Context, skipping errors which are
+/// already stored there, e.g. diagnostics in headers included by several
+/// translation units. Only translation units compiled in the same directory
+/// are analyzed at the same time.
+///
+/// \param Sink if provided, receives the errors of each translation unit as
+/// soon as it is analyzed instead of storing them in \p Context.
 void runClangTidy(clang::tidy::ClangTidyContext &Context,
                   const tooling::CompilationDatabase &Compilations,
                   ArrayRef<std::string> InputFiles,
-                  ProfileData *Profile = nullptr);
+                  ProfileData *Profile = nullptr,
+                  ClangTidyResultCache *Cache = nullptr, unsigned Jobs = 1,
+                  ClangTidyErrorSink *Sink = nullptr);
 
 // FIXME: This interface will need to be significantly extended to be useful.
 // FIXME: Implement confidence levels for displaying/fixing errors.
@@ -238,11 +315,50 @@ void runClangTidy(clang::tidy::ClangTidyContext &Context,
 void handleErrors(ClangTidyContext &Context, bool Fix,
                   unsigned &WarningsAsErrorsCount);
 
+class ErrorReporter;
+
+/// \brief Displays the errors of each translation unit as soon as they are
+/// received and collects their fixes, so that only the fixes need to be kept
+/// until the end of the run. Exported errors are written as one YAML document
+/// per translation unit as soon as they are received.
+///
+/// Fixes are applied in \c finish(). Unless \p FixErrors is true, the fixes of
+/// translation units with compiler errors are dropped.
+class StreamingErrorHandler : public ClangTidyErrorSink {
+public:
+  /// \param Fix whether to apply fixes.
+  /// \param FixErrors whether to apply fixes even if there are compiler
+  /// errors.
+  /// \param MainFilePath the main source file of the exported diagnostics.
+  /// \param ExportFixesFile the file to export the diagnostics to, if not
+  /// empty. It is only created if there are diagnostics.
+  StreamingErrorHandler(ClangTidyContext &Context, bool Fix, bool FixErrors,
+                        StringRef MainFilePath, StringRef ExportFixesFile);
+  ~StreamingErrorHandler() override;
+
+  void handleErrors(ArrayRef<ClangTidyError> Errors) override;
+
+  /// \brief Applies the collected fixes and closes the export file. Returns
+  /// false if the diagnostics couldn't be exported.
+  bool finish(unsigned &WarningsAsErrorsCount);
+
+  /// \brief Returns true if any of the received errors is a compiler error.
+  bool foundCompilerErrors() const { return FoundCompilerErrors; }
+
+private:
+  std::unique_ptr<ErrorReporter> Reporter;
+  bool FixErrors;
+  std::string MainFilePath;
+  std::string ExportFixesFile;
+  std::unique_ptr<llvm::raw_fd_ostream> ExportStream;
+  bool ExportFailed;
+  bool FoundCompilerErrors;
+};
+
 /// \brief Serializes replacements into YAML and writes them to the specified
 /// output stream.
 void exportReplacements(StringRef MainFilePath,
-                        const std::vector<ClangTidyError> &Errors,
-                        raw_ostream &OS);
+                        ArrayRef<ClangTidyError> Errors, raw_ostream &OS);
 
 } // end namespace tidy
 } // end namespace clang
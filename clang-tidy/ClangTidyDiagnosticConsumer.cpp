@@ -22,6 +22,8 @@
 #include "clang/Basic/DiagnosticOptions.h"
 #include "clang/Frontend/DiagnosticRenderer.h"
 #include "llvm/ADT/SmallString.h"
+#include "llvm/Support/Path.h"
+#include <numeric>
 #include <tuple>
 #include <vector>
 using namespace clang;
@@ -156,7 +158,10 @@ bool GlobList::contains(StringRef S, bool Contains) {
 
 class ClangTidyContext::CachedGlobList {
 public:
-  CachedGlobList(StringRef Globs) : Globs(Globs) {}
+  CachedGlobList(StringRef Globs) : Source(Globs), Globs(Globs) {}
+
+  /// \brief Returns the globs this list was created from.
+  StringRef getSource() const { return Source; }
 
   bool contains(StringRef S) {
     switch (auto &Result = Cache[S]) {
@@ -170,6 +175,7 @@ public:
   }
 
 private:
+  std::string Source;
   GlobList Globs;
   enum Tristate { None, Yes, No };
   llvm::StringMap<Tristate> Cache;
@@ -178,7 +184,7 @@ private:
 ClangTidyContext::ClangTidyContext(
     std::unique_ptr<ClangTidyOptionsProvider> OptionsProvider)
     : DiagEngine(nullptr), OptionsProvider(std::move(OptionsProvider)),
-      Profile(nullptr) {
+      DefaultOptions(ClangTidyOptions::getDefaults()), Profile(nullptr) {
   // Before the first translation unit we can get errors related to command-line
   // parsing, use empty string for the file name in this case.
   setCurrentFile("");
@@ -197,6 +203,9 @@ DiagnosticBuilder ClangTidyContext::diag(
 }
 
 void ClangTidyContext::setDiagnosticsEngine(DiagnosticsEngine *Engine) {
+  // Custom diagnostic IDs are specific to the engine.
+  if (Engine != DiagEngine)
+    CheckNamesByDiagnosticID.clear();
   DiagEngine = Engine;
 }
 
@@ -207,14 +216,20 @@ void ClangTidyContext::setSourceManager(SourceManager *SourceMgr) {
 void ClangTidyContext::setCurrentFile(StringRef File) {
   CurrentFile = File;
   CurrentOptions = getOptionsForFile(CurrentFile);
-  CheckFilter = llvm::make_unique<CachedGlobList>(*getOptions().Checks);
-  WarningAsErrorFilter =
-      llvm::make_unique<CachedGlobList>(*getOptions().WarningsAsErrors);
+  // Most files share the same filters, keep the compiled ones in this case.
+  if (!CheckFilter || CheckFilter->getSource() != *getOptions().Checks)
+    CheckFilter = llvm::make_unique<CachedGlobList>(*getOptions().Checks);
+  if (!WarningAsErrorFilter ||
+      WarningAsErrorFilter->getSource() != *getOptions().WarningsAsErrors)
+    WarningAsErrorFilter =
+        llvm::make_unique<CachedGlobList>(*getOptions().WarningsAsErrors);
 }
 
 void ClangTidyContext::setASTContext(ASTContext *Context) {
   DiagEngine->SetArgToStringFn(&FormatASTNodeDiagnosticArgument, Context);
   LangOpts = Context->getLangOpts();
+  ParentMap.setASTContext(Context);
+  TokenCache.setASTContext(Context);
 }
 
 const ClangTidyGlobalOptions &ClangTidyContext::getGlobalOptions() const {
@@ -222,14 +237,24 @@ const ClangTidyGlobalOptions &ClangTidyContext::getGlobalOptions() const {
 }
 
 const ClangTidyOptions &ClangTidyContext::getOptions() const {
-  return CurrentOptions;
+  return *CurrentOptions;
 }
 
-ClangTidyOptions ClangTidyContext::getOptionsForFile(StringRef File) const {
-  // Merge options on top of getDefaults() as a safeguard against options with
-  // unset values.
-  return ClangTidyOptions::getDefaults().mergeWith(
-      OptionsProvider->getOptions(File));
+std::shared_ptr<const ClangTidyOptions>
+ClangTidyContext::getOptionsForFile(StringRef File) const {
+  std::shared_ptr<const ClangTidyOptions> Shared =
+      OptionsProvider->getSharedOptions(File);
+  std::lock_guard<std::mutex> Lock(OptionsMutex);
+  DirectoryOptions &Cached =
+      OptionsByDirectory[llvm::sys::path::parent_path(File)];
+  if (Cached.Shared != Shared) {
+    // Merge options on top of getDefaults() as a safeguard against options
+    // with unset values.
+    Cached.Merged = std::make_shared<const ClangTidyOptions>(
+        DefaultOptions.mergeWith(*Shared));
+    Cached.Shared = std::move(Shared);
+  }
+  return Cached.Merged;
 }
 
 void ClangTidyContext::setCheckProfileData(ProfileData *P) { Profile = P; }
@@ -249,6 +274,28 @@ void ClangTidyContext::storeError(const ClangTidyError &Error) {
   Errors.push_back(Error);
 }
 
+void ClangTidyContext::storeResults(ArrayRef<ClangTidyError> NewErrors,
+                                    const ClangTidyStats &NewStats) {
+  Errors.insert(Errors.end(), NewErrors.begin(), NewErrors.end());
+  Stats.ErrorsDisplayed += NewStats.ErrorsDisplayed;
+  Stats.ErrorsIgnoredCheckFilter += NewStats.ErrorsIgnoredCheckFilter;
+  Stats.ErrorsIgnoredNOLINT += NewStats.ErrorsIgnoredNOLINT;
+  Stats.ErrorsIgnoredNonUserCode += NewStats.ErrorsIgnoredNonUserCode;
+  Stats.ErrorsIgnoredLineFilter += NewStats.ErrorsIgnoredLineFilter;
+}
+
+void ClangTidyContext::addPendingErrors(ArrayRef<ClangTidyError> NewErrors,
+                                        const ClangTidyStats &NewStats) {
+  PendingErrors.insert(PendingErrors.end(), NewErrors.begin(), NewErrors.end());
+  storeResults({}, NewStats);
+}
+
+std::vector<ClangTidyError> ClangTidyContext::takePendingErrors() {
+  std::vector<ClangTidyError> Result;
+  Result.swap(PendingErrors);
+  return Result;
+}
+
 StringRef ClangTidyContext::getCheckName(unsigned DiagnosticID) const {
   llvm::DenseMap<unsigned, std::string>::const_iterator I =
       CheckNamesByDiagnosticID.find(DiagnosticID);
@@ -487,8 +534,8 @@ llvm::Regex *ClangTidyDiagnosticConsumer::getHeaderFilter() {
   return HeaderFilter.get();
 }
 
-void ClangTidyDiagnosticConsumer::removeIncompatibleErrors(
-    SmallVectorImpl<ClangTidyError> &Errors) const {
+void clang::tidy::removeIncompatibleErrors(
+    SmallVectorImpl<ClangTidyError> &Errors) {
   // Each error is modelled as the set of intervals in which it applies
   // replacements. To detect overlapping replacements, we use a sweep line
   // algorithm over these sets of intervals.
@@ -504,10 +551,12 @@ void ClangTidyDiagnosticConsumer::removeIncompatibleErrors(
       ET_End = -1,
     };
 
-    Event(unsigned Begin, unsigned End, EventType Type, unsigned ErrorId,
-          unsigned ErrorSize)
+    Event(unsigned FileId, unsigned Begin, unsigned End, EventType Type,
+          unsigned ErrorId, unsigned ErrorSize)
         : Type(Type), ErrorId(ErrorId) {
-      // The events are going to be sorted by their position. In case of draw:
+      // The events are sorted by file first, so that the events of all files
+      // can be swept in one pass. Within a file, they are going to be sorted by
+      // their position. In case of draw:
       //
       // * If an interval ends at the same position at which other interval
       //   begins, this is not an overlapping, so we want to remove the ending
@@ -533,9 +582,11 @@ void ClangTidyDiagnosticConsumer::removeIncompatibleErrors(
       //   end point of the first one will also be processed before,
       //   disallowing the first one.
       if (Type == ET_Begin)
-        Priority = std::make_tuple(Begin, Type, -End, -ErrorSize, ErrorId);
+        Priority =
+            std::make_tuple(FileId, Begin, Type, -End, -ErrorSize, ErrorId);
       else
-        Priority = std::make_tuple(End, Type, -Begin, ErrorSize, ErrorId);
+        Priority =
+            std::make_tuple(FileId, End, Type, -Begin, ErrorSize, ErrorId);
     }
 
     bool operator<(const Event &Other) const {
@@ -548,56 +599,61 @@ void ClangTidyDiagnosticConsumer::removeIncompatibleErrors(
     // belongs.
     unsigned ErrorId;
     // The events will be sorted based on this field.
-    std::tuple<unsigned, EventType, int, int, unsigned> Priority;
+    std::tuple<unsigned, unsigned, EventType, int, int, unsigned> Priority;
   };
 
-  // Compute error sizes.
+  // Compute error sizes and the number of events.
   std::vector<int> Sizes;
+  Sizes.reserve(Errors.size());
+  size_t NumEvents = 0;
   for (const auto &Error : Errors) {
     int Size = 0;
     for (const auto &FileAndReplaces : Error.Fix) {
       for (const auto &Replace : FileAndReplaces.second)
         Size += Replace.getLength();
+      NumEvents += 2 * FileAndReplaces.second.size();
     }
     Sizes.push_back(Size);
   }
 
-  // Build events from error intervals.
-  std::map<std::string, std::vector<Event>> FileEvents;
+  // Build events from error intervals. File paths are mapped to dense ids once
+  // per error and file, so that events don't need to be grouped by string keys.
+  llvm::StringMap<unsigned> FileIds;
+  std::vector<Event> Events;
+  Events.reserve(NumEvents);
   for (unsigned I = 0; I < Errors.size(); ++I) {
     for (const auto &FileAndReplace : Errors[I].Fix) {
+      unsigned FileId =
+          FileIds.insert(std::make_pair(FileAndReplace.first(), FileIds.size()))
+              .first->second;
       for (const auto &Replace : FileAndReplace.second) {
         unsigned Begin = Replace.getOffset();
         unsigned End = Begin + Replace.getLength();
-        const std::string &FilePath = Replace.getFilePath();
         // FIXME: Handle empty intervals, such as those from insertions.
         if (Begin == End)
           continue;
-        auto &Events = FileEvents[FilePath];
-        Events.emplace_back(Begin, End, Event::ET_Begin, I, Sizes[I]);
-        Events.emplace_back(Begin, End, Event::ET_End, I, Sizes[I]);
+        Events.emplace_back(FileId, Begin, End, Event::ET_Begin, I, Sizes[I]);
+        Events.emplace_back(FileId, Begin, End, Event::ET_End, I, Sizes[I]);
       }
     }
   }
 
+  // Sweep. All intervals of a file are closed before the events of the next
+  // file start, so the counter is back at 0 on each file boundary.
   std::vector<bool> Apply(Errors.size(), true);
-  for (auto &FileAndEvents : FileEvents) {
-    std::vector<Event> &Events = FileAndEvents.second;
-    // Sweep.
-    std::sort(Events.begin(), Events.end());
-    int OpenIntervals = 0;
-    for (const auto &Event : Events) {
-      if (Event.Type == Event::ET_End)
-        --OpenIntervals;
-      // This has to be checked after removing the interval from the count if it
-      // is an end event, or before adding it if it is a begin event.
-      if (OpenIntervals != 0)
-        Apply[Event.ErrorId] = false;
-      if (Event.Type == Event::ET_Begin)
-        ++OpenIntervals;
-    }
-    assert(OpenIntervals == 0 && "Amount of begin/end points doesn't match");
+  std::sort(Events.begin(), Events.end());
+  int OpenIntervals = 0;
+  for (const auto &Event : Events) {
+    if (Event.Type == Event::ET_End)
+      --OpenIntervals;
+    // This has to be checked after removing the interval from the count if it
+    // is an end event, or before adding it if it is a begin event.
+    if (OpenIntervals != 0)
+      Apply[Event.ErrorId] = false;
+    if (Event.Type == Event::ET_Begin)
+      ++OpenIntervals;
   }
+  assert(OpenIntervals == 0 && "Amount of begin/end points doesn't match");
 
   for (unsigned I = 0; I < Errors.size(); ++I) {
     if (!Apply[I]) {
@@ -608,31 +664,56 @@ void ClangTidyDiagnosticConsumer::removeIncompatibleErrors(
   }
 }
 
-namespace {
-struct LessClangTidyError {
-  bool operator()(const ClangTidyError &LHS, const ClangTidyError &RHS) const {
-    const tooling::DiagnosticMessage &M1 = LHS.Message;
-    const tooling::DiagnosticMessage &M2 = RHS.Message;
+/// \brief Sorts \p Errors by file path, offset and message and removes
+/// duplicates. The distinct file paths are sorted once and the errors are
+/// compared by the rank of their path, instead of comparing the paths as
+/// strings in every comparison.
+static void sortAndUniqueErrors(std::vector<ClangTidyError> &Errors) {
+  llvm::StringMap<unsigned> Ranks;
+  for (const ClangTidyError &Error : Errors)
+    Ranks.insert(std::make_pair(Error.Message.FilePath, 0u));
+  std::vector<StringRef> Paths;
+  Paths.reserve(Ranks.size());
+  for (const auto &Entry : Ranks)
+    Paths.push_back(Entry.getKey());
+  std::sort(Paths.begin(), Paths.end());
+  for (unsigned I = 0; I < Paths.size(); ++I)
+    Ranks[Paths[I]] = I;
+  std::vector<unsigned> FileRanks;
+  FileRanks.reserve(Errors.size());
+  for (const ClangTidyError &Error : Errors)
+    FileRanks.push_back(Ranks.find(Error.Message.FilePath)->second);
 
-    return std::tie(M1.FilePath, M1.FileOffset, M1.Message) <
-           std::tie(M2.FilePath, M2.FileOffset, M2.Message);
-  }
-};
-struct EqualClangTidyError {
-  bool operator()(const ClangTidyError &LHS, const ClangTidyError &RHS) const {
-    LessClangTidyError Less;
-    return !Less(LHS, RHS) && !Less(RHS, LHS);
-  }
-};
-} // end anonymous namespace
+  auto Key = [&](unsigned I) {
+    return std::tie(FileRanks[I], Errors[I].Message.FileOffset,
+                    Errors[I].Message.Message);
+  };
+  std::vector<unsigned> Order(Errors.size());
+  std::iota(Order.begin(), Order.end(), 0);
+  std::sort(Order.begin(), Order.end(),
+            [&](unsigned LHS, unsigned RHS) { return Key(LHS) < Key(RHS); });
+  // Decide which errors to keep before moving any of them.
+  std::vector<bool> Keep(Order.size(), true);
+  for (unsigned I = 1; I < Order.size(); ++I)
+    Keep[I] = Key(Order[I - 1]) != Key(Order[I]);
+  std::vector<ClangTidyError> Sorted;
+  Sorted.reserve(Errors.size());
+  for (unsigned I = 0; I < Order.size(); ++I)
+    if (Keep[I])
+      Sorted.push_back(std::move(Errors[Order[I]]));
+  Errors = std::move(Sorted);
+}
 
 // Flushes the internal diagnostics buffer to the ClangTidyContext.
 void ClangTidyDiagnosticConsumer::finish() {
   finalizeLastError();
 
-  std::sort(Errors.begin(), Errors.end(), LessClangTidyError());
-  Errors.erase(std::unique(Errors.begin(), Errors.end(), EqualClangTidyError()),
-               Errors.end());
+  // Sorting below makes the result independent of how the translation unit
+  // was split between processes.
+  for (ClangTidyError &Error : Context.takePendingErrors())
+    Errors.push_back(std::move(Error));
+
+  sortAndUniqueErrors(Errors);
 
   if (RemoveIncompatibleErrors)
     removeIncompatibleErrors(Errors);
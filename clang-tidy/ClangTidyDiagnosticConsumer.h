@@ -11,6 +11,9 @@
 #define LLVM_CLANG_TOOLS_EXTRA_CLANG_TIDY_CLANGTIDYDIAGNOSTICCONSUMER_H
 
 #include "ClangTidyOptions.h"
+#include "ClangTidyIncludeGraph.h"
+#include "ClangTidyParentMap.h"
+#include "ClangTidyTokenCache.h"
 #include "clang/Basic/Diagnostic.h"
 #include "clang/Basic/SourceManager.h"
 #include "clang/Tooling/Core/Diagnostic.h"
@@ -19,6 +22,8 @@
 #include "llvm/ADT/StringMap.h"
 #include "llvm/Support/Regex.h"
 #include "llvm/Support/Timer.h"
+#include <memory>
+#include <mutex>
 
 namespace clang {
 
@@ -134,6 +139,18 @@ public:
   /// \brief Gets the language options from the AST context.
   const LangOptions &getLangOpts() const { return LangOpts; }
 
+  /// \brief Returns the parent map of the current translation unit, shared
+  /// between all checks.
+  ClangTidyParentMap &getParentMap() { return ParentMap; }
+
+  /// \brief Returns the raw tokens of the files of the current translation
+  /// unit, shared between all checks.
+  ClangTidyTokenCache &getTokenCache() { return TokenCache; }
+
+  /// \brief Returns the inclusion directives of the current translation unit,
+  /// shared between all checks.
+  ClangTidyIncludeGraph &getIncludeGraph() { return IncludeGraph; }
+
   /// \brief Returns the name of the clang-tidy check which produced this
   /// diagnostic ID.
   StringRef getCheckName(unsigned DiagnosticID) const;
@@ -157,7 +174,12 @@ public:
 
   /// \brief Returns options for \c File. Does not change or depend on
   /// \c CurrentFile.
-  ClangTidyOptions getOptionsForFile(StringRef File) const;
+  ///
+  /// The options are merged once per directory and shared by all of its
+  /// files, as long as the options provider returns the same shared options
+  /// for them. Safe to call from multiple threads.
+  std::shared_ptr<const ClangTidyOptions>
+  getOptionsForFile(StringRef File) const;
 
   /// \brief Returns \c ClangTidyStats containing issued and ignored diagnostic
   /// counters.
@@ -169,6 +191,22 @@ public:
   /// \brief Clears collected errors.
   void clearErrors() { Errors.clear(); }
 
+  /// \brief Stores \p Errors and adds \p Stats to the statistics of this
+  /// context. Used to combine results collected elsewhere, e.g. by contexts
+  /// analyzing other translation units concurrently or by a result cache.
+  void storeResults(ArrayRef<ClangTidyError> Errors,
+                    const ClangTidyStats &Stats);
+
+  /// \brief Adds \p Errors of the current translation unit which were found
+  /// elsewhere, e.g. by worker processes matching parts of it, and \p Stats of
+  /// their diagnostics. The errors are merged with the errors reported through
+  /// the diagnostics engine when the translation unit is finished.
+  void addPendingErrors(ArrayRef<ClangTidyError> Errors,
+                        const ClangTidyStats &Stats);
+
+  /// \brief Returns and removes the errors added by \c addPendingErrors.
+  std::vector<ClangTidyError> takePendingErrors();
+
   /// \brief Set the output struct for profile data.
   ///
   /// Setting a non-null pointer here will enable profile collection in
@@ -199,16 +237,33 @@ private:
   void storeError(const ClangTidyError &Error);
 
   std::vector<ClangTidyError> Errors;
+  std::vector<ClangTidyError> PendingErrors;
   DiagnosticsEngine *DiagEngine;
   std::unique_ptr<ClangTidyOptionsProvider> OptionsProvider;
+  /// \brief \c ClangTidyOptions::getDefaults() computed once, as it
+  /// instantiates all registered modules.
+  ClangTidyOptions DefaultOptions;
+
+  /// \brief The options of the files in a directory and the shared options of
+  /// the provider they were merged from.
+  struct DirectoryOptions {
+    std::shared_ptr<const ClangTidyOptions> Shared;
+    std::shared_ptr<const ClangTidyOptions> Merged;
+  };
+  /// \brief Guards \c OptionsByDirectory.
+  mutable std::mutex OptionsMutex;
+  mutable llvm::StringMap<DirectoryOptions> OptionsByDirectory;
 
   std::string CurrentFile;
-  ClangTidyOptions CurrentOptions;
+  std::shared_ptr<const ClangTidyOptions> CurrentOptions;
   class CachedGlobList;
   std::unique_ptr<CachedGlobList> CheckFilter;
   std::unique_ptr<CachedGlobList> WarningAsErrorFilter;
 
   LangOptions LangOpts;
+  ClangTidyParentMap ParentMap;
+  ClangTidyTokenCache TokenCache;
+  ClangTidyIncludeGraph IncludeGraph;
 
   ClangTidyStats Stats;
 
@@ -219,6 +274,13 @@ private:
   ProfileData *Profile;
 };
 
+/// \brief Clears the fixes of all \p Errors whose replacements overlap with
+/// replacements of other errors, and adds a note explaining why to them.
+///
+/// When one fix contains another one, only the fix of the containing error is
+/// kept. Runs in O(N log N) time, where N is the total number of replacements.
+void removeIncompatibleErrors(SmallVectorImpl<ClangTidyError> &Errors);
+
 /// \brief A diagnostic consumer that turns each \c Diagnostic into a
 /// \c SourceManager-independent \c ClangTidyError.
 //
@@ -241,8 +303,6 @@ public:
 private:
   void finalizeLastError();
 
-  void removeIncompatibleErrors(SmallVectorImpl<ClangTidyError> &Errors) const;
-
   /// \brief Returns the \c HeaderFilter constructed for the options set in the
   /// context.
   llvm::Regex *getHeaderFilter();
@@ -0,0 +1,69 @@
+//===--- tools/extra/clang-tidy/ClangTidyIncludeGraph.cpp ----------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+///
+///  \file This file implements the inclusion directives shared between
+///  clang-tidy checks.
+///
+//===----------------------------------------------------------------------===//
+
+#include "ClangTidyIncludeGraph.h"
+#include "clang/Lex/PPCallbacks.h"
+#include "clang/Lex/Preprocessor.h"
+#include "clang/Lex/Token.h"
+
+namespace clang {
+namespace tidy {
+
+class ClangTidyIncludeGraph::Recorder : public PPCallbacks {
+public:
+  Recorder(ClangTidyIncludeGraph &Graph, const SourceManager &SourceMgr)
+      : Graph(Graph), SourceMgr(SourceMgr) {}
+
+  void InclusionDirective(SourceLocation HashLocation,
+                          const Token &IncludeToken, StringRef FileName,
+                          bool IsAngled, CharSourceRange /*FileNameRange*/,
+                          const FileEntry * /*IncludedFile*/,
+                          StringRef /*SearchPath*/, StringRef /*RelativePath*/,
+                          const Module * /*ImportedModule*/) override {
+    Graph.InclusionsByFile[SourceMgr.getFileID(HashLocation)].push_back(
+        Inclusion{FileName.str(), IsAngled, HashLocation,
+                  IncludeToken.getEndLoc()});
+  }
+
+private:
+  ClangTidyIncludeGraph &Graph;
+  const SourceManager &SourceMgr;
+};
+
+ClangTidyIncludeGraph::ClangTidyIncludeGraph() : AttachedPP(nullptr) {}
+
+ClangTidyIncludeGraph::~ClangTidyIncludeGraph() = default;
+
+void ClangTidyIncludeGraph::reset() {
+  AttachedPP = nullptr;
+  InclusionsByFile.clear();
+}
+
+void ClangTidyIncludeGraph::attach(Preprocessor &PP) {
+  if (AttachedPP == &PP)
+    return;
+  AttachedPP = &PP;
+  PP.addPPCallbacks(llvm::make_unique<Recorder>(*this, PP.getSourceManager()));
+}
+
+ArrayRef<ClangTidyIncludeGraph::Inclusion>
+ClangTidyIncludeGraph::getInclusions(FileID File) const {
+  auto Inclusions = InclusionsByFile.find(File);
+  if (Inclusions == InclusionsByFile.end())
+    return None;
+  return Inclusions->second;
+}
+
+} // namespace tidy
+} // namespace clang
@@ -0,0 +1,76 @@
+//===--- ClangTidyIncludeGraph.h - clang-tidy -------------------*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_CLANG_TOOLS_EXTRA_CLANG_TIDY_CLANGTIDYINCLUDEGRAPH_H
+#define LLVM_CLANG_TOOLS_EXTRA_CLANG_TIDY_CLANGTIDYINCLUDEGRAPH_H
+
+#include "clang/Basic/SourceLocation.h"
+#include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/DenseMap.h"
+#include <string>
+#include <vector>
+
+namespace clang {
+
+class Preprocessor;
+
+namespace tidy {
+
+/// \brief Inclusion directives of the files of the current translation unit,
+/// shared between checks.
+///
+/// The directives are recorded by a single \c PPCallbacks instance, which is
+/// registered when the first check attaches the graph to the preprocessor of
+/// the translation unit, instead of by one instance per check.
+class ClangTidyIncludeGraph {
+public:
+  /// \brief An inclusion directive in source order.
+  struct Inclusion {
+    /// \brief The file name as written, without quotes or angle brackets.
+    std::string FileName;
+    bool IsAngled;
+    /// \brief The location of the '#' of the directive.
+    SourceLocation HashLocation;
+    /// \brief The end location of the last token of the directive.
+    SourceLocation EndLocation;
+  };
+
+  ClangTidyIncludeGraph();
+  ~ClangTidyIncludeGraph();
+
+  /// \brief Drops all recorded directives and detaches the graph from the
+  /// preprocessor of the previous translation unit.
+  ///
+  /// Called before a new translation unit is preprocessed. Unlike the other
+  /// per translation unit caches, the graph isn't reset by
+  /// \c ClangTidyContext::setASTContext: worker processes matching chunks of
+  /// an already preprocessed translation unit set the \c ASTContext again and
+  /// still need the recorded directives.
+  void reset();
+
+  /// \brief Starts recording the inclusion directives processed by \p PP,
+  /// unless the graph is already attached to it.
+  ///
+  /// Checks call this from \c ClangTidyCheck::registerPPCallbacks.
+  void attach(Preprocessor &PP);
+
+  /// \brief Returns the inclusion directives of \p File in source order.
+  ArrayRef<Inclusion> getInclusions(FileID File) const;
+
+private:
+  class Recorder;
+
+  const Preprocessor *AttachedPP;
+  llvm::DenseMap<FileID, std::vector<Inclusion>> InclusionsByFile;
+};
+
+} // end namespace tidy
+} // end namespace clang
+
+#endif // LLVM_CLANG_TOOLS_EXTRA_CLANG_TIDY_CLANGTIDYINCLUDEGRAPH_H
@@ -12,6 +12,7 @@
 //===----------------------------------------------------------------------===//
 
 #include "ClangTidyModule.h"
+#include "ClangTidyModuleRegistry.h"
 
 namespace clang {
 namespace tidy {
@@ -23,13 +24,48 @@ void ClangTidyCheckFactories::registerCheckFactory(StringRef Name,
 
 void ClangTidyCheckFactories::createChecks(
     ClangTidyContext *Context,
-    std::vector<std::unique_ptr<ClangTidyCheck>> &Checks) {
+    std::vector<std::unique_ptr<ClangTidyCheck>> &Checks) const {
   for (const auto &Factory : Factories) {
     if (Context->isCheckEnabled(Factory.first))
       Checks.emplace_back(Factory.second(Factory.first, Context));
   }
 }
 
+const ClangTidyOptions::OptionMap &
+ClangTidyCheckFactories::getDefaultOptions(StringRef Name) const {
+  std::lock_guard<std::mutex> Lock(DefaultOptionsMutex);
+  auto Inserted = DefaultOptions.insert(
+      std::make_pair(Name, ClangTidyOptions::OptionMap()));
+  if (Inserted.second) {
+    auto Factory = Factories.find(Name.str());
+    if (Factory != Factories.end()) {
+      ClangTidyContext Context(llvm::make_unique<DefaultOptionsProvider>(
+          ClangTidyGlobalOptions(), ClangTidyOptions()));
+      std::unique_ptr<ClangTidyCheck> Check(
+          Factory->second(Factory->first, &Context));
+      Check->storeOptions(Inserted.first->second);
+    }
+  }
+  return Inserted.first->second;
+}
+
+const ClangTidyCheckFactories &ClangTidyCheckFactories::getRegistered() {
+  static const ClangTidyCheckFactories *Registered = [] {
+    auto *Factories = new ClangTidyCheckFactories;
+    for (ClangTidyModuleRegistry::iterator
+             I = ClangTidyModuleRegistry::begin(),
+             E = ClangTidyModuleRegistry::end();
+         I != E; ++I) {
+      std::unique_ptr<ClangTidyModule> Module(I->instantiate());
+      Module->addCheckFactories(*Factories);
+      Factories->ModuleOptions =
+          Factories->ModuleOptions.mergeWith(Module->getModuleOptions());
+    }
+    return Factories;
+  }();
+  return *Registered;
+}
+
 ClangTidyOptions ClangTidyModule::getModuleOptions() {
   return ClangTidyOptions();
 }
@@ -11,9 +11,11 @@
 #define LLVM_CLANG_TOOLS_EXTRA_CLANG_TIDY_CLANGTIDYMODULE_H
 
 #include "ClangTidy.h"
+#include "llvm/ADT/StringMap.h"
 #include "llvm/ADT/StringRef.h"
 #include <functional>
 #include <map>
+#include <mutex>
 #include <string>
 #include <utility>
 
@@ -68,7 +70,31 @@ public:
   ///
   /// The caller takes ownership of the return \c ClangTidyChecks.
   void createChecks(ClangTidyContext *Context,
-                    std::vector<std::unique_ptr<ClangTidyCheck>> &Checks);
+                    std::vector<std::unique_ptr<ClangTidyCheck>> &Checks) const;
+
+  /// \brief Returns true if a check named \p Name is registered.
+  bool isRegistered(StringRef Name) const {
+    return Factories.count(Name.str()) != 0;
+  }
+
+  /// \brief Returns the options the check \p Name stores when none of its
+  /// options are configured.
+  ///
+  /// The check is created once with empty \c CheckOptions on the first call
+  /// for \p Name and the result is reused afterwards.
+  const ClangTidyOptions::OptionMap &getDefaultOptions(StringRef Name) const;
+
+  /// \brief Returns the factories of all checks of the modules registered
+  /// with \c ClangTidyModuleRegistry.
+  ///
+  /// The modules are instantiated once per process on the first call. The
+  /// returned table is shared by all \c ClangTidyContexts and may be used from
+  /// multiple threads.
+  static const ClangTidyCheckFactories &getRegistered();
+
+  /// \brief Returns the merged \c ClangTidyModule::getModuleOptions() of the
+  /// modules in the table returned by \c getRegistered().
+  const ClangTidyOptions &getModuleOptions() const { return ModuleOptions; }
 
   typedef std::map<std::string, CheckFactory> FactoryMap;
   FactoryMap::const_iterator begin() const { return Factories.begin(); }
@@ -77,6 +103,10 @@ public:
 
 private:
   FactoryMap Factories;
+  ClangTidyOptions ModuleOptions;
+
+  mutable std::mutex DefaultOptionsMutex;
+  mutable llvm::StringMap<ClangTidyOptions::OptionMap> DefaultOptions;
 };
 
 /// \brief A clang-tidy module groups a number of \c ClangTidyChecks and gives
@@ -110,11 +110,8 @@ ClangTidyOptions ClangTidyOptions::getDefaults() {
   Options.AnalyzeTemporaryDtors = false;
   Options.FormatStyle = "none";
   Options.User = llvm::None;
-  for (ClangTidyModuleRegistry::iterator I = ClangTidyModuleRegistry::begin(),
-                                         E = ClangTidyModuleRegistry::end();
-       I != E; ++I)
-    Options = Options.mergeWith(I->instantiate()->getModuleOptions());
-  return Options;
+  return Options.mergeWith(
+      ClangTidyCheckFactories::getRegistered().getModuleOptions());
 }
 
 template <typename T>
@@ -175,6 +172,11 @@ ClangTidyOptionsProvider::getOptions(llvm::StringRef FileName) {
   return Result;
 }
 
+std::shared_ptr<const ClangTidyOptions>
+ClangTidyOptionsProvider::getSharedOptions(llvm::StringRef FileName) {
+  return std::make_shared<const ClangTidyOptions>(getOptions(FileName));
+}
+
 std::vector<OptionsSource>
 DefaultOptionsProvider::getRawOptions(llvm::StringRef FileName) {
   std::vector<OptionsSource> Result;
@@ -218,47 +220,88 @@ FileOptionsProvider::FileOptionsProvider(
     : DefaultOptionsProvider(GlobalOptions, DefaultOptions),
       OverrideOptions(OverrideOptions), ConfigHandlers(ConfigHandlers) {}
 
-// FIXME: This method has some common logic with clang::format::getStyle().
-// Consider pulling out common bits to a findParentFileWithName function or
-// similar.
 std::vector<OptionsSource>
 FileOptionsProvider::getRawOptions(StringRef FileName) {
   DEBUG(llvm::dbgs() << "Getting options for file " << FileName << "...\n");
 
   std::vector<OptionsSource> RawOptions =
       DefaultOptionsProvider::getRawOptions(FileName);
-  OptionsSource CommandLineOptions(OverrideOptions,
-                                   OptionsSourceTypeCheckCommandLineOption);
-  // Look for a suitable configuration file in all parent directories of the
-  // file. Start with the immediate parent directory and move up.
-  StringRef Path = llvm::sys::path::parent_path(FileName);
-  for (StringRef CurrentPath = Path; !CurrentPath.empty();
-       CurrentPath = llvm::sys::path::parent_path(CurrentPath)) {
-    llvm::Optional<OptionsSource> Result;
-
-    auto Iter = CachedOptions.find(CurrentPath);
-    if (Iter != CachedOptions.end())
-      Result = Iter->second;
+  std::shared_ptr<const DirectoryConfig> Config =
+      getDirectoryConfig(llvm::sys::path::parent_path(FileName));
+  if (Config->Source)
+    RawOptions.push_back(*Config->Source);
+  RawOptions.emplace_back(OverrideOptions,
+                          OptionsSourceTypeCheckCommandLineOption);
+  return RawOptions;
+}
 
-    if (!Result)
-      Result = tryReadConfigFile(CurrentPath);
+std::shared_ptr<const ClangTidyOptions>
+FileOptionsProvider::getSharedOptions(StringRef FileName) {
+  return getDirectoryConfig(llvm::sys::path::parent_path(FileName))->Options;
+}
 
-    if (Result) {
-      // Store cached value for all intermediate directories.
-      while (Path != CurrentPath) {
-        DEBUG(llvm::dbgs() << "Caching configuration for path " << Path
-                           << ".\n");
-        CachedOptions[Path] = *Result;
-        Path = llvm::sys::path::parent_path(Path);
-      }
-      CachedOptions[Path] = *Result;
+void FileOptionsProvider::clearCache() {
+  std::lock_guard<std::mutex> Lock(CacheMutex);
+  CachedOptions.clear();
+  NoConfig.reset();
+}
 
-      RawOptions.push_back(*Result);
+// FIXME: This method has some common logic with clang::format::getStyle().
+// Consider pulling out common bits to a findParentFileWithName function or
+// similar.
+std::shared_ptr<const FileOptionsProvider::DirectoryConfig>
+FileOptionsProvider::getDirectoryConfig(StringRef Directory) {
+  std::lock_guard<std::mutex> Lock(CacheMutex);
+  // Look for a suitable configuration file in all parent directories. Start
+  // with the immediate parent directory and move up until a directory with a
+  // configuration file or with a cached result is found.
+  std::shared_ptr<const DirectoryConfig> Result;
+  StringRef CurrentPath = Directory;
+  for (; !CurrentPath.empty();
+       CurrentPath = llvm::sys::path::parent_path(CurrentPath)) {
+    auto Iter = CachedOptions.find(CurrentPath);
+    if (Iter != CachedOptions.end()) {
+      Result = Iter->second;
+      break;
+    }
+    if (llvm::Optional<OptionsSource> Source = tryReadConfigFile(CurrentPath)) {
+      Result = createDirectoryConfig(std::move(Source));
       break;
     }
   }
-  RawOptions.push_back(CommandLineOptions);
-  return RawOptions;
+  if (!Result) {
+    if (!NoConfig)
+      NoConfig = createDirectoryConfig(llvm::None);
+    Result = NoConfig;
+  }
+
+  // Store cached value for all intermediate directories, including the ones
+  // without a configuration file in any of their parents, so that subsequent
+  // lookups in these directories don't touch the file system.
+  for (StringRef Path = Directory; !Path.empty() && Path != CurrentPath;
+       Path = llvm::sys::path::parent_path(Path)) {
+    DEBUG(llvm::dbgs() << "Caching configuration for path " << Path << ".\n");
+    CachedOptions[Path] = Result;
+  }
+  if (!CurrentPath.empty())
+    CachedOptions[CurrentPath] = Result;
+  return Result;
+}
+
+std::shared_ptr<const FileOptionsProvider::DirectoryConfig>
+FileOptionsProvider::createDirectoryConfig(
+    llvm::Optional<OptionsSource> Source) {
+  ClangTidyOptions Options;
+  for (const auto &Default : DefaultOptionsProvider::getRawOptions(""))
+    Options = Options.mergeWith(Default.first);
+  if (Source)
+    Options = Options.mergeWith(Source->first);
+  Options = Options.mergeWith(OverrideOptions);
+
+  auto Config = std::make_shared<DirectoryConfig>();
+  Config->Source = std::move(Source);
+  Config->Options = std::make_shared<const ClangTidyOptions>(Options);
+  return Config;
 }
 
 llvm::Optional<OptionsSource>
@@ -16,6 +16,8 @@
 #include "llvm/Support/ErrorOr.h"
 #include <functional>
 #include <map>
+#include <memory>
+#include <mutex>
 #include <string>
 #include <system_error>
 #include <utility>
@@ -39,9 +41,21 @@ struct FileFilter {
 /// \brief Global options. These options are neither stored nor read from
 /// configuration files.
 struct ClangTidyGlobalOptions {
+  ClangTidyGlobalOptions() : RestrictToLineFilter(false), MatchingJobs(1) {}
+
   /// \brief Output warnings from certain line ranges of certain files only.
   /// If empty, no warnings will be filtered.
   std::vector<FileFilter> LineFilter;
+
+  /// \brief Only run AST matchers on top-level declarations that intersect
+  /// the line ranges in \c LineFilter, instead of on the whole translation
+  /// unit.
+  bool RestrictToLineFilter;
+
+  /// \brief The number of worker processes matching chunks of the top-level
+  /// declarations of each translation unit with the checks that aren't
+  /// serial-only. Matching happens in this process if it is 1.
+  unsigned MatchingJobs;
 };
 
 /// \brief Contains options for clang-tidy. These options may be read from
@@ -140,6 +154,11 @@ public:
   /// \brief Returns options applying to a specific translation unit with the
   /// specified \p FileName.
   ClangTidyOptions getOptions(llvm::StringRef FileName);
+
+  /// \brief Returns the same options as \c getOptions, but allows providers to
+  /// share one instance of the merged options between many files.
+  virtual std::shared_ptr<const ClangTidyOptions>
+  getSharedOptions(llvm::StringRef FileName);
 };
 
 /// \brief Implementation of the \c ClangTidyOptionsProvider interface, which
@@ -182,6 +201,12 @@ private:
 /// \c clang::tidy::parseConfiguration function will be used for parsing, but a
 /// custom set of configuration file names and parsing functions can be
 /// specified using the appropriate constructor.
+///
+/// The configuration found for each directory is cached, including the fact
+/// that there is none, so the file system is only accessed for directories
+/// that haven't been seen before. The effective options are merged once per
+/// configuration file and shared between all directories it applies to. All
+/// methods are safe to call from multiple threads.
 class FileOptionsProvider : public DefaultOptionsProvider {
 public:
   // \brief A pair of configuration file base name and a function parsing
@@ -247,12 +272,44 @@ public:
 
   std::vector<OptionsSource> getRawOptions(llvm::StringRef FileName) override;
 
+  std::shared_ptr<const ClangTidyOptions>
+  getSharedOptions(llvm::StringRef FileName) override;
+
+  /// \brief Forgets the configuration of all directories, so that later
+  /// lookups see configuration files changed, added or removed since.
+  ///
+  /// Long-lived users, like the clang-tidy plugin in a build daemon, call this
+  /// before each translation unit.
+  void clearCache();
+
 protected:
+  /// \brief The configuration applying to all files in a directory.
+  struct DirectoryConfig {
+    /// \brief The configuration file in the closest parent directory, if any.
+    llvm::Optional<OptionsSource> Source;
+    /// \brief The default options, \c Source and the override options merged.
+    std::shared_ptr<const ClangTidyOptions> Options;
+  };
+
   /// \brief Try to read configuration files from \p Directory using registered
   /// \c ConfigHandlers.
   llvm::Optional<OptionsSource> tryReadConfigFile(llvm::StringRef Directory);
 
-  llvm::StringMap<OptionsSource> CachedOptions;
+  /// \brief Returns the configuration applying to files in \p Directory and
+  /// caches it for all directories visited on the way up to the closest
+  /// configuration file.
+  std::shared_ptr<const DirectoryConfig>
+  getDirectoryConfig(llvm::StringRef Directory);
+
+  std::shared_ptr<const DirectoryConfig>
+  createDirectoryConfig(llvm::Optional<OptionsSource> Source);
+
+  /// \brief Guards \c CachedOptions and \c NoConfig.
+  std::mutex CacheMutex;
+  llvm::StringMap<std::shared_ptr<const DirectoryConfig>> CachedOptions;
+  /// \brief Shared by all directories without a configuration file in any of
+  /// their parents.
+  std::shared_ptr<const DirectoryConfig> NoConfig;
   ClangTidyOptions OverrideOptions;
   ConfigFileHandlers ConfigHandlers;
 };
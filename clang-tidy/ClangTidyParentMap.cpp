@@ -0,0 +1,213 @@
+//===--- tools/extra/clang-tidy/ClangTidyParentMap.cpp -------------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+///
+///  \file This file implements the map of AST node parents shared between
+///  clang-tidy checks.
+///
+//===----------------------------------------------------------------------===//
+
+#include "ClangTidyParentMap.h"
+#include "clang/AST/RecursiveASTVisitor.h"
+#include <algorithm>
+#include <tuple>
+
+namespace clang {
+namespace tidy {
+
+using ast_type_traits::DynTypedNode;
+
+/// \brief Records the parents of all declarations and statements in a
+/// top-level declaration. This mirrors the traversal \c ASTContext uses to
+/// build its parent map, so that the parents are the same.
+class ClangTidyParentMap::Builder : public RecursiveASTVisitor<Builder> {
+  typedef RecursiveASTVisitor<Builder> Base;
+
+public:
+  explicit Builder(RootParents &Parents) : Parents(Parents) {}
+
+  bool shouldVisitTemplateInstantiations() const { return true; }
+  bool shouldVisitImplicitCode() const { return true; }
+
+  bool TraverseDecl(Decl *D) {
+    if (!D)
+      return true;
+    addParent(D);
+    ParentStack.push_back(DynTypedNode::create(*D));
+    bool Result = Base::TraverseDecl(D);
+    ParentStack.pop_back();
+    return Result;
+  }
+
+  bool TraverseStmt(Stmt *S) {
+    if (!S)
+      return true;
+    addParent(S);
+    ParentStack.push_back(DynTypedNode::create(*S));
+    bool Result = Base::TraverseStmt(S);
+    ParentStack.pop_back();
+    return Result;
+  }
+
+  // Type locations and nested name specifiers can be parents of statements,
+  // e.g. of array sizes.
+  bool TraverseTypeLoc(TypeLoc TL) {
+    if (!TL)
+      return true;
+    ParentStack.push_back(DynTypedNode::create(TL));
+    bool Result = Base::TraverseTypeLoc(TL);
+    ParentStack.pop_back();
+    return Result;
+  }
+
+  bool TraverseNestedNameSpecifierLoc(NestedNameSpecifierLoc NNS) {
+    if (!NNS)
+      return true;
+    ParentStack.push_back(DynTypedNode::create(NNS));
+    bool Result = Base::TraverseNestedNameSpecifierLoc(NNS);
+    ParentStack.pop_back();
+    return Result;
+  }
+
+private:
+  void addParent(const void *Node) {
+    if (ParentStack.empty())
+      return;
+    ParentVector &NodeParents = Parents[Node];
+    // Like ASTContext, skip duplicates of parents with memoization data.
+    const DynTypedNode &Parent = ParentStack.back();
+    if (Parent.getMemoizationData() &&
+        std::find(NodeParents.begin(), NodeParents.end(), Parent) !=
+            NodeParents.end())
+      return;
+    NodeParents.push_back(Parent);
+  }
+
+  RootParents &Parents;
+  SmallVector<DynTypedNode, 16> ParentStack;
+};
+
+ClangTidyParentMap::ClangTidyParentMap() : Context(nullptr) {}
+
+ClangTidyParentMap::~ClangTidyParentMap() = default;
+
+void ClangTidyParentMap::setASTContext(ASTContext *NewContext) {
+  Context = NewContext;
+  Indexes.clear();
+  Roots.clear();
+  RootDeclParents.clear();
+}
+
+ASTContext::DynTypedNodeList
+ClangTidyParentMap::getParents(const DynTypedNode &Node) {
+  assert(Context && "no AST context set");
+  const void *Key = nullptr;
+  SourceLocation Loc;
+  if (const auto *D = Node.get<Decl>()) {
+    if (isa<TranslationUnitDecl>(D))
+      return ArrayRef<DynTypedNode>();
+    Key = D;
+    Loc = D->getLocation();
+  } else if (const auto *S = Node.get<Stmt>()) {
+    Key = S;
+    Loc = S->getLocStart();
+  }
+
+  if (Key && Loc.isValid()) {
+    const SourceManager &SM = Context->getSourceManager();
+    std::pair<FileID, unsigned> Decomposed =
+        SM.getDecomposedLoc(SM.getExpansionLoc(Loc));
+    if (const ParentVector *Parents =
+            findParents(Context->getTranslationUnitDecl(), Key,
+                        Decomposed.first, Decomposed.second))
+      return ArrayRef<DynTypedNode>(*Parents);
+  }
+  return Context->getParents(Node);
+}
+
+const ClangTidyParentMap::DeclContextIndex &
+ClangTidyParentMap::getIndex(const DeclContext *DC) {
+  std::unique_ptr<DeclContextIndex> &Index = Indexes[DC];
+  if (Index)
+    return *Index;
+
+  Index = llvm::make_unique<DeclContextIndex>();
+  const SourceManager &SM = Context->getSourceManager();
+  for (Decl *D : DC->decls()) {
+    SourceRange Range = D->getSourceRange();
+    if (Range.isInvalid())
+      continue;
+    std::pair<FileID, unsigned> Begin =
+        SM.getDecomposedLoc(SM.getExpansionLoc(Range.getBegin()));
+    std::pair<FileID, unsigned> End =
+        SM.getDecomposedLoc(SM.getExpansionLoc(Range.getEnd()));
+    if (Begin.first != End.first)
+      continue;
+    Index->Entries.push_back({Begin.first, Begin.second, End.second, D});
+  }
+  std::stable_sort(Index->Entries.begin(), Index->Entries.end(),
+                   [](const DeclContextIndex::Entry &LHS,
+                      const DeclContextIndex::Entry &RHS) {
+                     return std::tie(LHS.File, LHS.Begin) <
+                            std::tie(RHS.File, RHS.Begin);
+                   });
+  return *Index;
+}
+
+const ClangTidyParentMap::RootParents &
+ClangTidyParentMap::getRootParents(Decl *Root) {
+  std::unique_ptr<RootParents> &Parents = Roots[Root];
+  if (!Parents) {
+    Parents = llvm::make_unique<RootParents>();
+    Builder(*Parents).TraverseDecl(Root);
+  }
+  return *Parents;
+}
+
+const ClangTidyParentMap::ParentVector *
+ClangTidyParentMap::findParents(const DeclContext *DC, const void *Node,
+                                FileID File, unsigned Offset) {
+  const std::vector<DeclContextIndex::Entry> &Entries = getIndex(DC).Entries;
+  auto It = std::upper_bound(
+      Entries.begin(), Entries.end(), std::make_pair(File, Offset),
+      [](const std::pair<FileID, unsigned> &Loc,
+         const DeclContextIndex::Entry &Entry) {
+        return Loc < std::make_pair(Entry.File, Entry.Begin);
+      });
+  // Top-level declarations don't nest, except for declarations sharing a
+  // declaration specifier, e.g. "int a, b;", which all begin at the same
+  // location. Stop at the first declaration ending before the offset.
+  while (It != Entries.begin()) {
+    const DeclContextIndex::Entry &Entry = *--It;
+    if (Entry.File != File || Entry.End < Offset)
+      break;
+    Decl *D = Entry.D;
+    if (D == Node) {
+      std::unique_ptr<ParentVector> &Parents = RootDeclParents[D];
+      if (!Parents)
+        Parents = llvm::make_unique<ParentVector>(
+            1, DynTypedNode::create(*Decl::castFromDeclContext(DC)));
+      return Parents.get();
+    }
+    // Namespaces usually span many top-level declarations, look into them.
+    if (isa<NamespaceDecl>(D) || isa<LinkageSpecDecl>(D)) {
+      if (const ParentVector *Parents =
+              findParents(cast<DeclContext>(D), Node, File, Offset))
+        return Parents;
+      continue;
+    }
+    const RootParents &Parents = getRootParents(D);
+    auto Found = Parents.find(Node);
+    if (Found != Parents.end())
+      return &Found->second;
+  }
+  return nullptr;
+}
+
+} // namespace tidy
+} // namespace clang
@@ -0,0 +1,92 @@
+//===--- ClangTidyParentMap.h - clang-tidy ----------------------*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_CLANG_TOOLS_EXTRA_CLANG_TIDY_CLANGTIDYPARENTMAP_H
+#define LLVM_CLANG_TOOLS_EXTRA_CLANG_TIDY_CLANGTIDYPARENTMAP_H
+
+#include "clang/AST/ASTContext.h"
+#include "clang/AST/ASTTypeTraits.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/SmallVector.h"
+#include <memory>
+#include <vector>
+
+namespace clang {
+namespace tidy {
+
+/// \brief Provides the parents of AST nodes like \c ASTContext::getParents,
+/// without building the parent map of the whole translation unit.
+///
+/// The first \c ASTContext::getParents call traverses the whole translation
+/// unit, including all headers, and stores the parents of every node. Instead,
+/// this map finds the top-level declaration (in the translation unit or in a
+/// namespace) containing the queried node by its location and only traverses
+/// this declaration, in the same way \c ASTContext does. The parents of each
+/// traversed top-level declaration are kept until the end of the translation
+/// unit, so they are shared between all checks querying nodes in it.
+///
+/// Queries for nodes other than declarations and statements, and for nodes
+/// that can't be found this way, are forwarded to \c ASTContext::getParents.
+class ClangTidyParentMap {
+public:
+  ClangTidyParentMap();
+  ~ClangTidyParentMap();
+
+  /// \brief Drops all parents and uses \p Context for subsequent queries.
+  void setASTContext(ASTContext *Context);
+
+  /// \brief Returns the parents of \p Node, see \c ASTContext::getParents.
+  template <typename NodeT>
+  ASTContext::DynTypedNodeList getParents(const NodeT &Node) {
+    return getParents(ast_type_traits::DynTypedNode::create(Node));
+  }
+
+  ASTContext::DynTypedNodeList
+  getParents(const ast_type_traits::DynTypedNode &Node);
+
+private:
+  using ParentVector = SmallVector<ast_type_traits::DynTypedNode, 1>;
+  /// \brief Parents of the declarations and statements in a top-level
+  /// declaration.
+  using RootParents = llvm::DenseMap<const void *, ParentVector>;
+  class Builder;
+
+  /// \brief The top-level declarations of a declaration context that begin
+  /// and end in the same file, sorted by their begin offsets.
+  struct DeclContextIndex {
+    struct Entry {
+      FileID File;
+      unsigned Begin;
+      unsigned End;
+      Decl *D;
+    };
+    std::vector<Entry> Entries;
+  };
+
+  const DeclContextIndex &getIndex(const DeclContext *DC);
+  const RootParents &getRootParents(Decl *Root);
+  /// \brief Looks for \p Node in the top-level declarations of \p DC which
+  /// contain the file offset \p Offset in \p File. Returns null if the node
+  /// wasn't found.
+  const ParentVector *findParents(const DeclContext *DC, const void *Node,
+                                  FileID File, unsigned Offset);
+
+  ASTContext *Context;
+  llvm::DenseMap<const DeclContext *, std::unique_ptr<DeclContextIndex>>
+      Indexes;
+  llvm::DenseMap<const Decl *, std::unique_ptr<RootParents>> Roots;
+  /// \brief Storage for the parents of top-level declarations. Returned
+  /// lists refer to it, so the vectors must not move.
+  llvm::DenseMap<const Decl *, std::unique_ptr<ParentVector>> RootDeclParents;
+};
+
+} // end namespace tidy
+} // end namespace clang
+
+#endif // LLVM_CLANG_TOOLS_EXTRA_CLANG_TIDY_CLANGTIDYPARENTMAP_H
@@ -0,0 +1,365 @@
+//===--- tools/extra/clang-tidy/ClangTidyResultCache.cpp -----------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+///
+///  \file This file implements the on-disk cache of clang-tidy results of
+///  single translation units.
+///
+//===----------------------------------------------------------------------===//
+
+#include "ClangTidyResultCache.h"
+#include "clang/Basic/Version.h"
+#include "clang/Tooling/ReplacementsYaml.h"
+#include "llvm/ADT/SmallString.h"
+#include "llvm/ADT/StringExtras.h"
+#include "llvm/ADT/StringSet.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/MD5.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/Path.h"
+#include "llvm/Support/YAMLTraits.h"
+#include "llvm/Support/raw_ostream.h"
+
+using namespace clang;
+using namespace clang::tidy;
+
+namespace {
+struct CachedMessage {
+  CachedMessage() : FileOffset(0) {}
+  std::string Message;
+  std::string FilePath;
+  unsigned FileOffset;
+};
+
+struct CachedError {
+  CachedError() : IsError(false), IsWarningAsError(false) {}
+  std::string DiagnosticName;
+  bool IsError;
+  bool IsWarningAsError;
+  std::string BuildDirectory;
+  CachedMessage Message;
+  std::vector<CachedMessage> Notes;
+  std::vector<tooling::Replacement> Replacements;
+};
+
+struct CachedDependency {
+  std::string Path;
+  std::string Hash;
+};
+
+struct CacheEntry {
+  std::vector<CachedDependency> Dependencies;
+  ClangTidyStats Stats;
+  std::vector<CachedError> Errors;
+};
+
+struct CachedResults {
+  ClangTidyStats Stats;
+  std::vector<CachedError> Errors;
+};
+} // end anonymous namespace
+
+LLVM_YAML_IS_SEQUENCE_VECTOR(CachedMessage)
+LLVM_YAML_IS_SEQUENCE_VECTOR(CachedError)
+LLVM_YAML_IS_SEQUENCE_VECTOR(CachedDependency)
+
+namespace llvm {
+namespace yaml {
+
+template <> struct MappingTraits<CachedMessage> {
+  static void mapping(IO &IO, CachedMessage &Message) {
+    IO.mapRequired("Message", Message.Message);
+    IO.mapRequired("FilePath", Message.FilePath);
+    IO.mapRequired("FileOffset", Message.FileOffset);
+  }
+};
+
+template <> struct MappingTraits<CachedError> {
+  static void mapping(IO &IO, CachedError &Error) {
+    IO.mapRequired("DiagnosticName", Error.DiagnosticName);
+    IO.mapOptional("IsError", Error.IsError, false);
+    IO.mapOptional("IsWarningAsError", Error.IsWarningAsError, false);
+    IO.mapOptional("BuildDirectory", Error.BuildDirectory);
+    IO.mapRequired("Message", Error.Message);
+    IO.mapOptional("Notes", Error.Notes);
+    IO.mapOptional("Replacements", Error.Replacements);
+  }
+};
+
+template <> struct MappingTraits<CachedDependency> {
+  static void mapping(IO &IO, CachedDependency &Dependency) {
+    IO.mapRequired("Path", Dependency.Path);
+    IO.mapRequired("Hash", Dependency.Hash);
+  }
+};
+
+template <> struct MappingTraits<ClangTidyStats> {
+  static void mapping(IO &IO, ClangTidyStats &Stats) {
+    IO.mapOptional("ErrorsDisplayed", Stats.ErrorsDisplayed, 0u);
+    IO.mapOptional("ErrorsIgnoredCheckFilter", Stats.ErrorsIgnoredCheckFilter,
+                   0u);
+    IO.mapOptional("ErrorsIgnoredNOLINT", Stats.ErrorsIgnoredNOLINT, 0u);
+    IO.mapOptional("ErrorsIgnoredNonUserCode", Stats.ErrorsIgnoredNonUserCode,
+                   0u);
+    IO.mapOptional("ErrorsIgnoredLineFilter", Stats.ErrorsIgnoredLineFilter,
+                   0u);
+  }
+};
+
+template <> struct MappingTraits<CacheEntry> {
+  static void mapping(IO &IO, CacheEntry &Entry) {
+    IO.mapRequired("Dependencies", Entry.Dependencies);
+    IO.mapRequired("Stats", Entry.Stats);
+    IO.mapOptional("Errors", Entry.Errors);
+  }
+};
+
+template <> struct MappingTraits<CachedResults> {
+  static void mapping(IO &IO, CachedResults &Results) {
+    IO.mapRequired("Stats", Results.Stats);
+    IO.mapOptional("Errors", Results.Errors);
+  }
+};
+
+} // namespace yaml
+} // namespace llvm
+
+static std::string hashContents(StringRef Contents) {
+  llvm::MD5 Hash;
+  Hash.update(Contents);
+  llvm::MD5::MD5Result Result;
+  Hash.final(Result);
+  SmallString<32> Text;
+  llvm::MD5::stringifyResult(Result, Text);
+  return Text.str();
+}
+
+static bool hashFile(StringRef Path, std::string &Hash) {
+  llvm::ErrorOr<std::unique_ptr<llvm::MemoryBuffer>> Buffer =
+      llvm::MemoryBuffer::getFile(Path);
+  if (!Buffer)
+    return false;
+  Hash = hashContents((*Buffer)->getBuffer());
+  return true;
+}
+
+static CachedMessage
+toCachedMessage(const tooling::DiagnosticMessage &Message) {
+  CachedMessage Result;
+  Result.Message = Message.Message;
+  Result.FilePath = Message.FilePath;
+  Result.FileOffset = Message.FileOffset;
+  return Result;
+}
+
+static tooling::DiagnosticMessage
+fromCachedMessage(const CachedMessage &Message) {
+  tooling::DiagnosticMessage Result(Message.Message);
+  Result.FilePath = Message.FilePath;
+  Result.FileOffset = Message.FileOffset;
+  return Result;
+}
+
+static CachedError toCachedError(const ClangTidyError &Error) {
+  CachedError Cached;
+  Cached.DiagnosticName = Error.DiagnosticName;
+  Cached.IsError = Error.DiagLevel == ClangTidyError::Error;
+  Cached.IsWarningAsError = Error.IsWarningAsError;
+  Cached.BuildDirectory = Error.BuildDirectory;
+  Cached.Message = toCachedMessage(Error.Message);
+  for (const tooling::DiagnosticMessage &Note : Error.Notes)
+    Cached.Notes.push_back(toCachedMessage(Note));
+  for (const auto &FileAndReplacements : Error.Fix)
+    Cached.Replacements.insert(Cached.Replacements.end(),
+                               FileAndReplacements.second.begin(),
+                               FileAndReplacements.second.end());
+  return Cached;
+}
+
+static bool fromCachedErrors(ArrayRef<CachedError> CachedErrors,
+                             std::vector<ClangTidyError> &Errors) {
+  for (const CachedError &Cached : CachedErrors) {
+    Errors.emplace_back(Cached.DiagnosticName,
+                        Cached.IsError ? ClangTidyError::Error
+                                       : ClangTidyError::Warning,
+                        Cached.BuildDirectory, Cached.IsWarningAsError);
+    ClangTidyError &Error = Errors.back();
+    Error.Message = fromCachedMessage(Cached.Message);
+    for (const CachedMessage &Note : Cached.Notes)
+      Error.Notes.push_back(fromCachedMessage(Note));
+    for (const tooling::Replacement &Replacement : Cached.Replacements) {
+      // The replacements were consistent when they were written, so a
+      // conflict means that the input is corrupted.
+      if (llvm::Error Err = Error.Fix[Replacement.getFilePath()].add(
+              Replacement)) {
+        llvm::consumeError(std::move(Err));
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+ClangTidyResultCache::ClangTidyResultCache(StringRef Directory)
+    : Directory(Directory) {}
+
+std::string ClangTidyResultCache::getKey(
+    ArrayRef<tooling::CompileCommand> Commands, const ClangTidyOptions &Options,
+    const ClangTidyGlobalOptions &GlobalOptions) const {
+  llvm::MD5 Hash;
+  auto AddString = [&Hash](StringRef S) {
+    Hash.update(S);
+    // Terminate each string, so that the same text split in different ways
+    // doesn't produce the same key.
+    Hash.update(StringRef("\0", 1));
+  };
+
+  AddString(getClangFullVersion());
+  for (const tooling::CompileCommand &Command : Commands) {
+    AddString(Command.Directory);
+    AddString(Command.Filename);
+    for (const std::string &Arg : Command.CommandLine)
+      AddString(Arg);
+  }
+  AddString(configurationAsText(Options));
+  // SystemHeaders is not a part of the configuration file format.
+  AddString(Options.SystemHeaders && *Options.SystemHeaders ? "true" : "false");
+  AddString(GlobalOptions.RestrictToLineFilter ? "true" : "false");
+  for (const FileFilter &Filter : GlobalOptions.LineFilter) {
+    AddString(Filter.Name);
+    for (const FileFilter::LineRange &Range : Filter.LineRanges) {
+      AddString(llvm::utostr(Range.first));
+      AddString(llvm::utostr(Range.second));
+    }
+  }
+
+  llvm::MD5::MD5Result Result;
+  Hash.final(Result);
+  SmallString<32> Key;
+  llvm::MD5::stringifyResult(Result, Key);
+  return Key.str();
+}
+
+std::string ClangTidyResultCache::getEntryPath(StringRef Key) const {
+  SmallString<256> Path(Directory);
+  llvm::sys::path::append(Path, Key + ".yaml");
+  return Path.str();
+}
+
+bool ClangTidyResultCache::replay(StringRef Key,
+                                  ClangTidyContext &Context) const {
+  llvm::ErrorOr<std::unique_ptr<llvm::MemoryBuffer>> Text =
+      llvm::MemoryBuffer::getFile(getEntryPath(Key));
+  if (!Text)
+    return false;
+
+  CacheEntry Entry;
+  llvm::yaml::Input Input((*Text)->getBuffer());
+  Input >> Entry;
+  if (Input.error())
+    return false;
+
+  for (const CachedDependency &Dependency : Entry.Dependencies) {
+    std::string Hash;
+    if (!hashFile(Dependency.Path, Hash) || Hash != Dependency.Hash)
+      return false;
+  }
+
+  std::vector<ClangTidyError> Errors;
+  if (!fromCachedErrors(Entry.Errors, Errors))
+    return false;
+
+  Context.storeResults(Errors, Entry.Stats);
+  return true;
+}
+
+void ClangTidyResultCache::store(StringRef Key,
+                                 ArrayRef<std::string> Dependencies,
+                                 StringRef BuildDirectory,
+                                 ArrayRef<ClangTidyError> Errors,
+                                 const ClangTidyStats &Stats) const {
+  CacheEntry Entry;
+  Entry.Stats = Stats;
+
+  llvm::StringSet<> SeenDependencies;
+  for (StringRef Dependency : Dependencies) {
+    SmallString<256> Path;
+    if (llvm::sys::path::is_absolute(Dependency))
+      Path = Dependency;
+    else {
+      Path = BuildDirectory;
+      llvm::sys::path::append(Path, Dependency);
+    }
+    if (!SeenDependencies.insert(Path).second)
+      continue;
+
+    CachedDependency Cached;
+    Cached.Path = Path.str();
+    // Don't store entries we won't be able to validate.
+    if (!hashFile(Cached.Path, Cached.Hash))
+      return;
+    Entry.Dependencies.push_back(std::move(Cached));
+  }
+
+  for (const ClangTidyError &Error : Errors)
+    Entry.Errors.push_back(toCachedError(Error));
+
+  if (std::error_code EC = llvm::sys::fs::create_directories(Directory)) {
+    llvm::errs() << "Can't create result cache directory " << Directory << ": "
+                 << EC.message() << "\n";
+    return;
+  }
+
+  // Write the entry to a temporary file first and move it into place, so that
+  // concurrent clang-tidy processes sharing the cache never read a partially
+  // written entry.
+  SmallString<256> Model(Directory);
+  llvm::sys::path::append(Model, Key + "-%%%%%%%%.tmp");
+  SmallString<256> TempPath;
+  int FD;
+  if (std::error_code EC =
+          llvm::sys::fs::createUniqueFile(Model, FD, TempPath)) {
+    llvm::errs() << "Can't create result cache entry in " << Directory << ": "
+                 << EC.message() << "\n";
+    return;
+  }
+  {
+    llvm::raw_fd_ostream OS(FD, /*shouldClose=*/true);
+    llvm::yaml::Output YAML(OS);
+    YAML << Entry;
+  }
+  if (std::error_code EC =
+          llvm::sys::fs::rename(TempPath, getEntryPath(Key))) {
+    llvm::errs() << "Can't store result cache entry " << getEntryPath(Key)
+                 << ": " << EC.message() << "\n";
+    llvm::sys::fs::remove(TempPath);
+  }
+}
+
+void clang::tidy::writeResults(ArrayRef<ClangTidyError> Errors,
+                               const ClangTidyStats &Stats,
+                               llvm::raw_ostream &OS) {
+  CachedResults Results;
+  Results.Stats = Stats;
+  for (const ClangTidyError &Error : Errors)
+    Results.Errors.push_back(toCachedError(Error));
+  llvm::yaml::Output YAML(OS);
+  YAML << Results;
+}
+
+bool clang::tidy::readResults(StringRef Text,
+                              std::vector<ClangTidyError> &Errors,
+                              ClangTidyStats &Stats) {
+  CachedResults Results;
+  llvm::yaml::Input Input(Text);
+  Input >> Results;
+  if (Input.error())
+    return false;
+  Stats = Results.Stats;
+  return fromCachedErrors(Results.Errors, Errors);
+}
@@ -0,0 +1,76 @@
+//===--- ClangTidyResultCache.h - clang-tidy --------------------*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_CLANG_TOOLS_EXTRA_CLANG_TIDY_CLANGTIDYRESULTCACHE_H
+#define LLVM_CLANG_TOOLS_EXTRA_CLANG_TIDY_CLANGTIDYRESULTCACHE_H
+
+#include "ClangTidyDiagnosticConsumer.h"
+#include "ClangTidyOptions.h"
+#include "clang/Tooling/CompilationDatabase.h"
+#include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/StringRef.h"
+#include <string>
+#include <vector>
+
+namespace clang {
+namespace tidy {
+
+/// \brief Stores the results of running clang-tidy on single translation units
+/// in a directory, so that they can be replayed on subsequent runs with the
+/// same inputs instead of parsing the translation unit again.
+///
+/// An entry is keyed by a hash of the compile commands of the translation
+/// unit, the effective \c ClangTidyOptions, the global options and the
+/// clang-tidy version. Each entry records the files the translation unit
+/// depended on together with a hash of their contents, and is only used if
+/// none of these files has changed since the entry was stored.
+class ClangTidyResultCache {
+public:
+  /// \brief Initializes the cache stored in \p Directory. The directory is
+  /// created when the first entry is stored.
+  explicit ClangTidyResultCache(StringRef Directory);
+
+  /// \brief Computes the key of the cache entry for a translation unit
+  /// compiled with \p Commands and analyzed with \p Options.
+  std::string getKey(ArrayRef<tooling::CompileCommand> Commands,
+                     const ClangTidyOptions &Options,
+                     const ClangTidyGlobalOptions &GlobalOptions) const;
+
+  /// \brief Stores the errors and statistics of the entry \p Key in the
+  /// \p Context if the entry exists and all of its dependencies are
+  /// unchanged. Returns \c true on a cache hit.
+  bool replay(StringRef Key, ClangTidyContext &Context) const;
+
+  /// \brief Stores \p Errors and \p Stats of a translation unit depending on
+  /// the files \p Dependencies under \p Key. Relative paths in
+  /// \p Dependencies are resolved against \p BuildDirectory.
+  void store(StringRef Key, ArrayRef<std::string> Dependencies,
+             StringRef BuildDirectory, ArrayRef<ClangTidyError> Errors,
+             const ClangTidyStats &Stats) const;
+
+private:
+  std::string getEntryPath(StringRef Key) const;
+
+  std::string Directory;
+};
+
+/// \brief Writes \p Errors and \p Stats to \p OS as YAML, in the format of
+/// the cache entries. Used to pass results between processes.
+void writeResults(ArrayRef<ClangTidyError> Errors, const ClangTidyStats &Stats,
+                  raw_ostream &OS);
+
+/// \brief Reads results written by \c writeResults from \p Text. Returns
+/// \c false if \p Text is malformed.
+bool readResults(StringRef Text, std::vector<ClangTidyError> &Errors,
+                 ClangTidyStats &Stats);
+
+} // end namespace tidy
+} // end namespace clang
+
+#endif // LLVM_CLANG_TOOLS_EXTRA_CLANG_TIDY_CLANGTIDYRESULTCACHE_H
@@ -0,0 +1,92 @@
+//===--- tools/extra/clang-tidy/ClangTidySharedVisitor.cpp ---------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+///
+///  \file This file implements the traversal of translation units shared
+///  between clang-tidy checks.
+///
+//===----------------------------------------------------------------------===//
+
+#include "ClangTidySharedVisitor.h"
+#include "ClangTidy.h"
+#include "clang/AST/RecursiveASTVisitor.h"
+
+using namespace clang::ast_matchers;
+
+namespace clang {
+namespace tidy {
+
+class ClangTidySharedVisitor::Visitor : public RecursiveASTVisitor<Visitor> {
+public:
+  Visitor(const ClangTidySharedVisitor &Shared,
+          const MatchFinder::MatchResult &Result)
+      : Shared(Shared), Result(Result) {}
+
+  bool VisitStmt(Stmt *S) {
+    unsigned Class = S->getStmtClass();
+    if (Class < Shared.StmtCallbacks.size())
+      for (ClangTidyCheck *Check : Shared.StmtCallbacks[Class])
+        Check->visitStmt(S, Result);
+    return true;
+  }
+
+  bool VisitDecl(Decl *D) {
+    unsigned Kind = D->getKind();
+    if (Kind < Shared.DeclCallbacks.size())
+      for (ClangTidyCheck *Check : Shared.DeclCallbacks[Kind])
+        Check->visitDecl(D, Result);
+    return true;
+  }
+
+private:
+  const ClangTidySharedVisitor &Shared;
+  const MatchFinder::MatchResult &Result;
+};
+
+ClangTidySharedVisitor::ClangTidySharedVisitor(ClangTidyContext &Context)
+    : Context(Context) {}
+
+ClangTidySharedVisitor::~ClangTidySharedVisitor() = default;
+
+void ClangTidySharedVisitor::addStmtCallback(ClangTidyCheck *Check,
+                                             Stmt::StmtClass First,
+                                             Stmt::StmtClass Last) {
+  assert(First <= Last && "invalid statement class range");
+  if (StmtCallbacks.size() <= static_cast<unsigned>(Last))
+    StmtCallbacks.resize(Last + 1);
+  for (unsigned Class = First; Class <= static_cast<unsigned>(Last); ++Class)
+    StmtCallbacks[Class].push_back(Check);
+  Subscribers.insert(Check);
+}
+
+void ClangTidySharedVisitor::addDeclCallback(ClangTidyCheck *Check,
+                                             Decl::Kind First,
+                                             Decl::Kind Last) {
+  assert(First <= Last && "invalid declaration kind range");
+  if (DeclCallbacks.size() <= static_cast<unsigned>(Last))
+    DeclCallbacks.resize(Last + 1);
+  for (unsigned Kind = First; Kind <= static_cast<unsigned>(Last); ++Kind)
+    DeclCallbacks[Kind].push_back(Check);
+  Subscribers.insert(Check);
+}
+
+void ClangTidySharedVisitor::registerMatchers(MatchFinder *Finder) {
+  // The translation unit is the first node matched, so the traversal runs
+  // before all other matchers.
+  if (!StmtCallbacks.empty() || !DeclCallbacks.empty())
+    Finder->addMatcher(translationUnitDecl().bind("tu"), this);
+}
+
+void ClangTidySharedVisitor::run(const MatchFinder::MatchResult &Result) {
+  Context.setSourceManager(Result.SourceManager);
+  const auto *TU = Result.Nodes.getNodeAs<TranslationUnitDecl>("tu");
+  Visitor(*this, Result).TraverseDecl(const_cast<TranslationUnitDecl *>(TU));
+}
+
+} // namespace tidy
+} // namespace clang
@@ -0,0 +1,86 @@
+//===--- ClangTidySharedVisitor.h - clang-tidy ------------------*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_CLANG_TOOLS_EXTRA_CLANG_TIDY_CLANGTIDYSHAREDVISITOR_H
+#define LLVM_CLANG_TOOLS_EXTRA_CLANG_TIDY_CLANGTIDYSHAREDVISITOR_H
+
+#include "clang/AST/DeclBase.h"
+#include "clang/AST/Stmt.h"
+#include "clang/ASTMatchers/ASTMatchFinder.h"
+#include "llvm/ADT/SmallPtrSet.h"
+#include "llvm/ADT/SmallVector.h"
+#include <vector>
+
+namespace clang {
+namespace tidy {
+
+class ClangTidyCheck;
+class ClangTidyContext;
+
+/// \brief Traverses each translation unit once on behalf of all checks that
+/// need to look at every node of some kinds, instead of each of these checks
+/// running its own \c RecursiveASTVisitor over the whole translation unit.
+///
+/// Checks subscribe to node kinds in
+/// \c ClangTidyCheck::registerSharedVisitorCallbacks and receive the nodes in
+/// \c ClangTidyCheck::visitStmt and \c ClangTidyCheck::visitDecl. Nodes are
+/// visited in pre-order and, like with a default \c RecursiveASTVisitor,
+/// template instantiations and implicit code are not visited. The traversal
+/// runs before any other matcher of the translation unit, so checks can use it
+/// to collect information needed in \c ClangTidyCheck::check.
+class ClangTidySharedVisitor : public ast_matchers::MatchFinder::MatchCallback {
+public:
+  explicit ClangTidySharedVisitor(ClangTidyContext &Context);
+  ~ClangTidySharedVisitor() override;
+
+  /// \brief Calls \c ClangTidyCheck::visitStmt of \p Check for all statements
+  /// with a class in the range [\p First, \p Last], e.g.
+  /// \c Stmt::firstCallExprConstant and \c Stmt::lastCallExprConstant for all
+  /// kinds of calls.
+  void addStmtCallback(ClangTidyCheck *Check, Stmt::StmtClass First,
+                       Stmt::StmtClass Last);
+  void addStmtCallback(ClangTidyCheck *Check, Stmt::StmtClass Class) {
+    addStmtCallback(Check, Class, Class);
+  }
+
+  /// \brief Calls \c ClangTidyCheck::visitDecl of \p Check for all
+  /// declarations with a kind in the range [\p First, \p Last].
+  void addDeclCallback(ClangTidyCheck *Check, Decl::Kind First,
+                       Decl::Kind Last);
+  void addDeclCallback(ClangTidyCheck *Check, Decl::Kind Kind) {
+    addDeclCallback(Check, Kind, Kind);
+  }
+
+  /// \brief Returns true if \p Check subscribed to any node kind.
+  bool isSubscribed(const ClangTidyCheck *Check) const {
+    return Subscribers.count(Check);
+  }
+
+  /// \brief Registers the traversal with \p Finder, if any check subscribed
+  /// to a node kind.
+  void registerMatchers(ast_matchers::MatchFinder *Finder);
+
+private:
+  class Visitor;
+
+  void run(const ast_matchers::MatchFinder::MatchResult &Result) override;
+  StringRef getID() const override { return "clang-tidy-shared-visitor"; }
+
+  ClangTidyContext &Context;
+  /// \brief Subscribed checks, indexed by \c Stmt::StmtClass.
+  std::vector<SmallVector<ClangTidyCheck *, 2>> StmtCallbacks;
+  /// \brief Subscribed checks, indexed by \c Decl::Kind.
+  std::vector<SmallVector<ClangTidyCheck *, 2>> DeclCallbacks;
+  llvm::SmallPtrSet<const ClangTidyCheck *, 4> Subscribers;
+};
+
+} // end namespace tidy
+} // end namespace clang
+
+#endif // LLVM_CLANG_TOOLS_EXTRA_CLANG_TIDY_CLANGTIDYSHAREDVISITOR_H
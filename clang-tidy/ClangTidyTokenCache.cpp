@@ -0,0 +1,123 @@
+//===--- tools/extra/clang-tidy/ClangTidyTokenCache.cpp ------------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+///
+///  \file This file implements the cache of raw tokens shared between
+///  clang-tidy checks.
+///
+//===----------------------------------------------------------------------===//
+
+#include "ClangTidyTokenCache.h"
+#include "clang/Lex/Lexer.h"
+#include <algorithm>
+
+namespace clang {
+namespace tidy {
+
+static Token makeUnknownToken() {
+  Token Tok;
+  Tok.startToken();
+  Tok.setKind(tok::unknown);
+  return Tok;
+}
+
+ClangTidyTokenCache::ClangTidyTokenCache() : Context(nullptr) {}
+
+ClangTidyTokenCache::~ClangTidyTokenCache() = default;
+
+void ClangTidyTokenCache::setASTContext(ASTContext *NewContext) {
+  Context = NewContext;
+  Files.clear();
+}
+
+ArrayRef<Token> ClangTidyTokenCache::getTokens(FileID File) {
+  assert(Context && "no AST context set");
+  std::unique_ptr<std::vector<Token>> &Tokens = Files[File.getHashValue()];
+  if (Tokens)
+    return *Tokens;
+
+  Tokens = llvm::make_unique<std::vector<Token>>();
+  const SourceManager &SM = Context->getSourceManager();
+  bool Invalid = false;
+  StringRef Buffer = SM.getBufferData(File, &Invalid);
+  if (Invalid)
+    return *Tokens;
+
+  Lexer RawLexer(SM.getLocForStartOfFile(File), Context->getLangOpts(),
+                 Buffer.begin(), Buffer.begin(), Buffer.end());
+  RawLexer.SetCommentRetentionState(true);
+  Token Tok;
+  do {
+    RawLexer.LexFromRawLexer(Tok);
+    Tokens->push_back(Tok);
+  } while (Tok.isNot(tok::eof));
+  return *Tokens;
+}
+
+ArrayRef<Token> ClangTidyTokenCache::lookup(SourceLocation Loc, size_t &Pos) {
+  Pos = 0;
+  if (Loc.isInvalid() || !Loc.isFileID())
+    return None;
+  const SourceManager &SM = Context->getSourceManager();
+  ArrayRef<Token> Tokens = getTokens(SM.getFileID(Loc));
+  // Locations in the same file are ordered like their offsets.
+  Pos = std::lower_bound(Tokens.begin(), Tokens.end(), Loc,
+                         [](const Token &Tok, SourceLocation Loc) {
+                           return Tok.getLocation() < Loc;
+                         }) -
+        Tokens.begin();
+  return Tokens;
+}
+
+ArrayRef<Token> ClangTidyTokenCache::getTokensInRange(CharSourceRange Range) {
+  size_t Begin, End;
+  ArrayRef<Token> Tokens = lookup(Range.getBegin(), Begin);
+  if (Tokens.empty() || lookup(Range.getEnd(), End).data() != Tokens.data() ||
+      End < Begin)
+    return None;
+  return Tokens.slice(Begin, End - Begin);
+}
+
+const Token *ClangTidyTokenCache::getTokenAt(SourceLocation Loc) {
+  size_t Pos;
+  ArrayRef<Token> Tokens = lookup(Loc, Pos);
+  if (Pos < Tokens.size() && Tokens[Pos].getLocation() == Loc)
+    return &Tokens[Pos];
+  if (Pos == 0 || Pos > Tokens.size())
+    return nullptr;
+  const Token &Previous = Tokens[Pos - 1];
+  if (Loc < Previous.getLocation().getLocWithOffset(Previous.getLength()))
+    return &Previous;
+  return nullptr;
+}
+
+Token ClangTidyTokenCache::getPreviousToken(SourceLocation Loc,
+                                            bool SkipComments) {
+  size_t Pos;
+  ArrayRef<Token> Tokens = lookup(Loc, Pos);
+  while (Pos > 0 && Pos <= Tokens.size()) {
+    const Token &Tok = Tokens[--Pos];
+    if (!SkipComments || Tok.isNot(tok::comment))
+      return Tok;
+  }
+  return makeUnknownToken();
+}
+
+Token ClangTidyTokenCache::getNextToken(SourceLocation Loc, bool SkipComments) {
+  size_t Pos;
+  ArrayRef<Token> Tokens = lookup(Loc, Pos);
+  for (; Pos < Tokens.size(); ++Pos) {
+    const Token &Tok = Tokens[Pos];
+    if (!SkipComments || Tok.isNot(tok::comment))
+      return Tok;
+  }
+  return makeUnknownToken();
+}
+
+} // namespace tidy
+} // namespace clang
@@ -0,0 +1,73 @@
+//===--- ClangTidyTokenCache.h - clang-tidy ---------------------*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_CLANG_TOOLS_EXTRA_CLANG_TIDY_CLANGTIDYTOKENCACHE_H
+#define LLVM_CLANG_TOOLS_EXTRA_CLANG_TIDY_CLANGTIDYTOKENCACHE_H
+
+#include "clang/AST/ASTContext.h"
+#include "clang/Lex/Token.h"
+#include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/DenseMap.h"
+#include <memory>
+#include <vector>
+
+namespace clang {
+namespace tidy {
+
+/// \brief Raw tokens of the files of the current translation unit, shared
+/// between checks.
+///
+/// Each file is raw-lexed once, with comments, the first time one of its
+/// tokens is requested. Queries for tokens at or around a location are binary
+/// searches in the cached tokens instead of lexing the source again.
+///
+/// All locations passed to the queries must be file locations, queries for
+/// macro locations find no tokens. Identifiers are returned as
+/// \c tok::raw_identifier tokens.
+class ClangTidyTokenCache {
+public:
+  ClangTidyTokenCache();
+  ~ClangTidyTokenCache();
+
+  /// \brief Drops all tokens and uses \p Context for subsequent queries.
+  void setASTContext(ASTContext *Context);
+
+  /// \brief Returns all tokens of \p File, ending with a \c tok::eof token.
+  ArrayRef<Token> getTokens(FileID File);
+
+  /// \brief Returns the tokens beginning in the character range \p Range.
+  ArrayRef<Token> getTokensInRange(CharSourceRange Range);
+
+  /// \brief Returns the token containing \p Loc, or null if \p Loc is not in
+  /// a token.
+  const Token *getTokenAt(SourceLocation Loc);
+
+  /// \brief Returns the last token beginning before \p Loc, or a
+  /// \c tok::unknown token if there is none.
+  Token getPreviousToken(SourceLocation Loc, bool SkipComments = true);
+
+  /// \brief Returns the first token beginning at or after \p Loc, or a
+  /// \c tok::unknown token if there is none.
+  Token getNextToken(SourceLocation Loc, bool SkipComments = true);
+
+private:
+  /// \brief Returns the tokens of the file containing \p Loc and sets \p Pos
+  /// to the index of the first token beginning at or after \p Loc.
+  ArrayRef<Token> lookup(SourceLocation Loc, size_t &Pos);
+
+  ASTContext *Context;
+  /// \brief Tokens by \c FileID hash value. The vectors must not move, as
+  /// returned token ranges refer to them.
+  llvm::DenseMap<unsigned, std::unique_ptr<std::vector<Token>>> Files;
+};
+
+} // end namespace tidy
+} // end namespace clang
+
+#endif // LLVM_CLANG_TOOLS_EXTRA_CLANG_TIDY_CLANGTIDYTOKENCACHE_H
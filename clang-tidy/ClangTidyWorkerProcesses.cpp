@@ -0,0 +1,179 @@
+//===--- tools/extra/clang-tidy/ClangTidyWorkerProcesses.cpp -------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+///
+///  \file This file implements matching chunks of a translation unit in
+///  worker processes.
+///
+//===----------------------------------------------------------------------===//
+
+#include "ClangTidyWorkerProcesses.h"
+#include "ClangTidyResultCache.h"
+#include "llvm/Config/llvm-config.h"
+#include "llvm/Support/raw_ostream.h"
+#include <cerrno>
+#include <string>
+#include <vector>
+
+#ifdef LLVM_ON_UNIX
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+namespace clang {
+namespace tidy {
+
+#ifdef LLVM_ON_UNIX
+
+static ClangTidyStats getStatsSince(const ClangTidyStats &Before,
+                                    const ClangTidyStats &After) {
+  ClangTidyStats Stats;
+  Stats.ErrorsDisplayed = After.ErrorsDisplayed - Before.ErrorsDisplayed;
+  Stats.ErrorsIgnoredCheckFilter =
+      After.ErrorsIgnoredCheckFilter - Before.ErrorsIgnoredCheckFilter;
+  Stats.ErrorsIgnoredNOLINT =
+      After.ErrorsIgnoredNOLINT - Before.ErrorsIgnoredNOLINT;
+  Stats.ErrorsIgnoredNonUserCode =
+      After.ErrorsIgnoredNonUserCode - Before.ErrorsIgnoredNonUserCode;
+  Stats.ErrorsIgnoredLineFilter =
+      After.ErrorsIgnoredLineFilter - Before.ErrorsIgnoredLineFilter;
+  return Stats;
+}
+
+static bool writeAll(int FD, StringRef Data) {
+  while (!Data.empty()) {
+    ssize_t Written = ::write(FD, Data.data(), Data.size());
+    if (Written < 0) {
+      if (errno == EINTR)
+        continue;
+      return false;
+    }
+    Data = Data.drop_front(Written);
+  }
+  return true;
+}
+
+static bool readAll(int FD, std::string &Data) {
+  char Buffer[4096];
+  while (true) {
+    ssize_t Read = ::read(FD, Buffer, sizeof(Buffer));
+    if (Read < 0) {
+      if (errno == EINTR)
+        continue;
+      return false;
+    }
+    if (Read == 0)
+      return true;
+    Data.append(Buffer, Read);
+  }
+}
+
+/// \brief Matches \p Chunk in a freshly forked worker process, writes the
+/// errors to \p FD and exits.
+LLVM_ATTRIBUTE_NORETURN static void
+runWorker(ClangTidyContext &Context, ASTContext &AST, unsigned Chunk,
+          llvm::function_ref<void(unsigned)> MatchChunk, int FD) {
+  // The diagnostic consumer of this process may hold errors of the parent
+  // which aren't finalized yet. Report the errors of the chunk to a fresh one.
+  ClangTidyDiagnosticConsumer WorkerConsumer(
+      Context, /*RemoveIncompatibleErrors=*/false);
+  Context.setSourceManager(&AST.getSourceManager());
+  Context.setASTContext(&AST);
+  Context.clearErrors();
+  Context.takePendingErrors();
+  ClangTidyStats StatsBefore = Context.getStats();
+
+  MatchChunk(Chunk);
+  WorkerConsumer.finish();
+
+  std::string Results;
+  llvm::raw_string_ostream OS(Results);
+  writeResults(Context.getErrors(),
+               getStatsSince(StatsBefore, Context.getStats()), OS);
+  OS.flush();
+  bool Success = writeAll(FD, Results);
+  ::close(FD);
+  // Don't run destructors or atexit handlers, they belong to the parent.
+  ::_exit(Success ? 0 : 1);
+}
+
+void matchInWorkerProcesses(ClangTidyContext &Context, ASTContext &AST,
+                            unsigned NumChunks,
+                            llvm::function_ref<void(unsigned)> MatchChunk,
+                            llvm::function_ref<void()> MatchInParent) {
+  struct Worker {
+    pid_t Pid;
+    int FD;
+  };
+  // Workers must not write out the buffered output of this process again.
+  llvm::outs().flush();
+  llvm::errs().flush();
+
+  std::vector<Worker> Workers(NumChunks, Worker{-1, -1});
+  for (unsigned Chunk = 0; Chunk < NumChunks; ++Chunk) {
+    int Pipe[2];
+    if (::pipe(Pipe) != 0)
+      continue;
+    pid_t Pid = ::fork();
+    if (Pid == 0) {
+      ::close(Pipe[0]);
+      runWorker(Context, AST, Chunk, MatchChunk, Pipe[1]);
+    }
+    ::close(Pipe[1]);
+    if (Pid < 0) {
+      ::close(Pipe[0]);
+      continue;
+    }
+    Workers[Chunk] = Worker{Pid, Pipe[0]};
+  }
+
+  MatchInParent();
+
+  // Collect the results in the order of the chunks and match the chunks of
+  // failed workers here.
+  for (unsigned Chunk = 0; Chunk < NumChunks; ++Chunk) {
+    const Worker &W = Workers[Chunk];
+    bool Success = false;
+    std::vector<ClangTidyError> Errors;
+    ClangTidyStats Stats;
+    if (W.Pid > 0) {
+      std::string Results;
+      bool Read = readAll(W.FD, Results);
+      ::close(W.FD);
+      int Status = 0;
+      pid_t Waited;
+      do
+        Waited = ::waitpid(W.Pid, &Status, 0);
+      while (Waited < 0 && errno == EINTR);
+      Success = Read && Waited == W.Pid && WIFEXITED(Status) &&
+                WEXITSTATUS(Status) == 0 &&
+                readResults(Results, Errors, Stats);
+    }
+    if (Success)
+      Context.addPendingErrors(Errors, Stats);
+    else
+      MatchChunk(Chunk);
+  }
+}
+
+#else
+
+void matchInWorkerProcesses(ClangTidyContext &Context, ASTContext &AST,
+                            unsigned NumChunks,
+                            llvm::function_ref<void(unsigned)> MatchChunk,
+                            llvm::function_ref<void()> MatchInParent) {
+  MatchInParent();
+  for (unsigned Chunk = 0; Chunk < NumChunks; ++Chunk)
+    MatchChunk(Chunk);
+}
+
+#endif
+
+} // namespace tidy
+} // namespace clang
@@ -0,0 +1,43 @@
+//===--- ClangTidyWorkerProcesses.h - clang-tidy ----------------*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_CLANG_TOOLS_EXTRA_CLANG_TIDY_CLANGTIDYWORKERPROCESSES_H
+#define LLVM_CLANG_TOOLS_EXTRA_CLANG_TIDY_CLANGTIDYWORKERPROCESSES_H
+
+#include "ClangTidyDiagnosticConsumer.h"
+#include "clang/AST/ASTContext.h"
+#include "llvm/ADT/STLExtras.h"
+
+namespace clang {
+namespace tidy {
+
+/// \brief Runs \p MatchChunk for the chunks 0 to \p NumChunks - 1 of the
+/// translation unit of \p AST, each in a worker process forked from this one,
+/// and \p MatchInParent in this process while the workers run.
+///
+/// The AST is not safe to share between threads: \c SourceManager and
+/// \c ASTContext fill caches while matchers query them. Each worker gets its
+/// own copy of the whole process instead, including the checks and their
+/// state.
+///
+/// The errors reported through the diagnostics engine of \p Context in a
+/// worker are added to \p Context with \c ClangTidyContext::addPendingErrors,
+/// so that they are merged with the other errors of the translation unit when
+/// it is finished. Chunks whose worker can't be started or fails are matched
+/// in this process. All chunks are matched in this process on platforms
+/// without \c fork().
+void matchInWorkerProcesses(ClangTidyContext &Context, ASTContext &AST,
+                            unsigned NumChunks,
+                            llvm::function_ref<void(unsigned)> MatchChunk,
+                            llvm::function_ref<void()> MatchInParent);
+
+} // end namespace tidy
+} // end namespace clang
+
+#endif // LLVM_CLANG_TOOLS_EXTRA_CLANG_TIDY_CLANGTIDYWORKERPROCESSES_H
@@ -37,8 +37,7 @@ void ProBoundsConstantArrayIndexCheck::registerPPCallbacks(
     return;
 
   Inserter.reset(new utils::IncludeInserter(
-      Compiler.getSourceManager(), Compiler.getLangOpts(), IncludeStyle));
-  Compiler.getPreprocessor().addPPCallbacks(Inserter->CreatePPCallbacks());
+      getIncludeGraph(), Compiler.getPreprocessor(), IncludeStyle));
 }
 
 void ProBoundsConstantArrayIndexCheck::registerMatchers(MatchFinder *Finder) {
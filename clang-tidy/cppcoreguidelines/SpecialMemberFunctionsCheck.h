@@ -30,6 +30,7 @@ public:
   void registerMatchers(ast_matchers::MatchFinder *Finder) override;
   void check(const ast_matchers::MatchFinder::MatchResult &Result) override;
   void onEndOfTranslationUnit() override;
+  bool isSerialOnly() const override { return true; }
 
   enum class SpecialMemberFunctionKind : uint8_t {
     Destructor,
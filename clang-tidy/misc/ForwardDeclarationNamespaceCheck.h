@@ -45,6 +45,7 @@ public:
   void registerMatchers(ast_matchers::MatchFinder *Finder) override;
   void check(const ast_matchers::MatchFinder::MatchResult &Result) override;
   void onEndOfTranslationUnit() override;
+  bool isSerialOnly() const override { return true; }
 
 private:
   llvm::StringMap<std::vector<const CXXRecordDecl *>> DeclNameToDefinitions;
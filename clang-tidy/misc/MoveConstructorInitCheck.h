@@ -31,6 +31,7 @@ public:
   void check(const ast_matchers::MatchFinder::MatchResult &Result) override;
   void registerPPCallbacks(clang::CompilerInstance &Compiler) override;
   void storeOptions(ClangTidyOptions::OptionMap &Opts) override;
+  bool isSerialOnly() const override { return true; }
 
 private:
   std::unique_ptr<utils::IncludeInserter> Inserter;
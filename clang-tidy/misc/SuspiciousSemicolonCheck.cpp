@@ -8,7 +8,6 @@
 //===----------------------------------------------------------------------===//
 
 #include "SuspiciousSemicolonCheck.h"
-#include "../utils/LexerUtils.h"
 #include "clang/AST/ASTContext.h"
 #include "clang/ASTMatchers/ASTMatchFinder.h"
 
@@ -39,8 +38,7 @@ void SuspiciousSemicolonCheck::check(const MatchFinder::MatchResult &Result) {
   if (LocStart.isMacroID())
     return;
 
-  ASTContext &Ctxt = *Result.Context;
-  auto Token = utils::lexer::getPreviousToken(Ctxt, LocStart);
+  auto Token = getTokenCache().getPreviousToken(LocStart);
   auto &SM = *Result.SourceManager;
   unsigned SemicolonLine = SM.getSpellingLineNumber(LocStart);
 
@@ -52,12 +50,8 @@ void SuspiciousSemicolonCheck::check(const MatchFinder::MatchResult &Result) {
     return;
 
   SourceLocation LocEnd = Semicolon->getLocEnd();
-  FileID FID = SM.getFileID(LocEnd);
-  llvm::MemoryBuffer *Buffer = SM.getBuffer(FID, LocEnd);
-  Lexer Lexer(SM.getLocForStartOfFile(FID), Ctxt.getLangOpts(),
-              Buffer->getBufferStart(), SM.getCharacterData(LocEnd) + 1,
-              Buffer->getBufferEnd());
-  if (Lexer.LexFromRawLexer(Token))
+  Token = getTokenCache().getNextToken(LocEnd.getLocWithOffset(1));
+  if (Token.getLocation().isInvalid() || Token.is(tok::eof))
     return;
 
   unsigned BaseIndent = SM.getSpellingColumnNumber(Statement->getLocStart());
@@ -9,10 +9,8 @@
 
 #include "UnusedParametersCheck.h"
 #include "clang/AST/ASTContext.h"
-#include "clang/AST/RecursiveASTVisitor.h"
 #include "clang/ASTMatchers/ASTMatchFinder.h"
 #include "clang/Lex/Lexer.h"
-#include <unordered_set>
 
 using namespace clang::ast_matchers;
 
@@ -70,55 +68,6 @@ static FixItHint removeArgument(const MatchFinder::MatchResult &Result,
       Index + 1 < Call->getNumArgs() ? Call->getArg(Index + 1) : nullptr));
 }
 
-class UnusedParametersCheck::IndexerVisitor
-    : public RecursiveASTVisitor<IndexerVisitor> {
-public:
-  IndexerVisitor(TranslationUnitDecl *Top) { TraverseDecl(Top); }
-
-  const std::unordered_set<const CallExpr *> &
-  getFnCalls(const FunctionDecl *Fn) {
-    return Index[Fn->getCanonicalDecl()].Calls;
-  }
-
-  const std::unordered_set<const DeclRefExpr *> &
-  getOtherRefs(const FunctionDecl *Fn) {
-    return Index[Fn->getCanonicalDecl()].OtherRefs;
-  }
-
-  bool shouldTraversePostOrder() const { return true; }
-
-  bool WalkUpFromDeclRefExpr(DeclRefExpr *DeclRef) {
-    if (const auto *Fn = dyn_cast<FunctionDecl>(DeclRef->getDecl())) {
-      Fn = Fn->getCanonicalDecl();
-      Index[Fn].OtherRefs.insert(DeclRef);
-    }
-    return true;
-  }
-
-  bool WalkUpFromCallExpr(CallExpr *Call) {
-    if (const auto *Fn =
-            dyn_cast_or_null<FunctionDecl>(Call->getCalleeDecl())) {
-      Fn = Fn->getCanonicalDecl();
-      if (const auto *Ref =
-              dyn_cast<DeclRefExpr>(Call->getCallee()->IgnoreImplicit())) {
-        Index[Fn].OtherRefs.erase(Ref);
-      }
-      Index[Fn].Calls.insert(Call);
-    }
-    return true;
-  }
-
-private:
-  struct IndexEntry {
-    std::unordered_set<const CallExpr *> Calls;
-    std::unordered_set<const DeclRefExpr *> OtherRefs;
-  };
-
-  std::unordered_map<const FunctionDecl *, IndexEntry> Index;
-};
-
-UnusedParametersCheck::~UnusedParametersCheck() = default;
-
 UnusedParametersCheck::UnusedParametersCheck(StringRef Name,
                                              ClangTidyContext *Context)
     : ClangTidyCheck(Name, Context) {}
@@ -129,15 +78,12 @@ void UnusedParametersCheck::warnOnUnusedParameter(
   const auto *Param = Function->getParamDecl(ParamIndex);
   auto MyDiag = diag(Param->getLocation(), "parameter %0 is unused") << Param;
 
-  if (!Indexer) {
-    Indexer = llvm::make_unique<IndexerVisitor>(
-        Result.Context->getTranslationUnitDecl());
-  }
+  const IndexEntry &Entry = Index[Function->getCanonicalDecl()];
 
   // Comment out parameter name for non-local functions.
   if (Function->isExternallyVisible() ||
       !Result.SourceManager->isInMainFile(Function->getLocation()) ||
-      !Indexer->getOtherRefs(Function).empty() || isOverrideMethod(Function)) {
+      !Entry.OtherRefs.empty() || isOverrideMethod(Function)) {
     SourceRange RemovalRange(Param->getLocation());
     // Note: We always add a space before the '/*' to not accidentally create a
     // '*/*' for pointer types, which doesn't start a comment. clang-format will
@@ -153,10 +99,39 @@ void UnusedParametersCheck::warnOnUnusedParameter(
       MyDiag << removeParameter(Result, FD, ParamIndex);
 
   // Fix all call sites.
-  for (const auto *Call : Indexer->getFnCalls(Function))
+  for (const auto *Call : Entry.Calls)
     MyDiag << removeArgument(Result, Call, ParamIndex);
 }
 
+void UnusedParametersCheck::registerSharedVisitorCallbacks(
+    ClangTidySharedVisitor &Visitor) {
+  Visitor.addStmtCallback(this, Stmt::DeclRefExprClass);
+  Visitor.addStmtCallback(this, Stmt::firstCallExprConstant,
+                          Stmt::lastCallExprConstant);
+}
+
+void UnusedParametersCheck::visitStmt(const Stmt *S,
+                                      const MatchFinder::MatchResult &Result) {
+  // Calls are visited before their callees, so references used as callees are
+  // known when they are visited.
+  if (const auto *Call = dyn_cast<CallExpr>(S)) {
+    if (const auto *Fn =
+            dyn_cast_or_null<FunctionDecl>(Call->getCalleeDecl())) {
+      if (const auto *Ref =
+              dyn_cast<DeclRefExpr>(Call->getCallee()->IgnoreImplicit()))
+        CalleeRefs.insert(Ref);
+      Index[Fn->getCanonicalDecl()].Calls.insert(Call);
+    }
+    return;
+  }
+
+  const auto *DeclRef = cast<DeclRefExpr>(S);
+  if (const auto *Fn = dyn_cast<FunctionDecl>(DeclRef->getDecl())) {
+    if (!CalleeRefs.count(DeclRef))
+      Index[Fn->getCanonicalDecl()].OtherRefs.insert(DeclRef);
+  }
+}
+
 void UnusedParametersCheck::check(const MatchFinder::MatchResult &Result) {
   const auto *Function = Result.Nodes.getNodeAs<FunctionDecl>("function");
   if (!Function->hasWrittenPrototype() || Function->isTemplateInstantiation())
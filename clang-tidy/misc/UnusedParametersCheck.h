@@ -11,6 +11,8 @@
 #define LLVM_CLANG_TOOLS_EXTRA_CLANG_TIDY_MISC_UNUSED_PARAMETERS_H
 
 #include "../ClangTidy.h"
+#include <unordered_map>
+#include <unordered_set>
 
 namespace clang {
 namespace tidy {
@@ -21,13 +23,24 @@ namespace misc {
 class UnusedParametersCheck : public ClangTidyCheck {
 public:
   UnusedParametersCheck(StringRef Name, ClangTidyContext *Context);
-  ~UnusedParametersCheck();
   void registerMatchers(ast_matchers::MatchFinder *Finder) override;
   void check(const ast_matchers::MatchFinder::MatchResult &Result) override;
+  void registerSharedVisitorCallbacks(ClangTidySharedVisitor &Visitor) override;
+  void visitStmt(const Stmt *S,
+                 const ast_matchers::MatchFinder::MatchResult &Result) override;
 
 private:
-  class IndexerVisitor;
-  std::unique_ptr<IndexerVisitor> Indexer;
+  struct IndexEntry {
+    std::unordered_set<const CallExpr *> Calls;
+    std::unordered_set<const DeclRefExpr *> OtherRefs;
+  };
+
+  /// \brief Calls and other references of each function in the translation
+  /// unit, keyed by the canonical declaration.
+  std::unordered_map<const FunctionDecl *, IndexEntry> Index;
+  /// \brief References to functions used as callees of the calls visited so
+  /// far, which are not counted as other references.
+  std::unordered_set<const DeclRefExpr *> CalleeRefs;
 
   void
   warnOnUnusedParameter(const ast_matchers::MatchFinder::MatchResult &Result,
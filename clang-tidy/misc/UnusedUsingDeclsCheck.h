@@ -29,6 +29,7 @@ public:
   void registerMatchers(ast_matchers::MatchFinder *Finder) override;
   void check(const ast_matchers::MatchFinder::MatchResult &Result) override;
   void onEndOfTranslationUnit() override;
+  bool isSerialOnly() const override { return true; }
 
 private:
   void removeFromFoundDecls(const Decl *D);
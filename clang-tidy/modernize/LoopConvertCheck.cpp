@@ -386,10 +386,10 @@ static bool isDirectMemberExpr(const Expr *E) {
 /// \brief Given an expression that represents an usage of an element from the
 /// containter that we are iterating over, returns false when it can be
 /// guaranteed this element cannot be modified as a result of this usage.
-static bool canBeModified(ASTContext *Context, const Expr *E) {
+static bool canBeModified(ClangTidyParentMap &ParentMap, const Expr *E) {
   if (E->getType().isConstQualified())
     return false;
-  auto Parents = Context->getParents(*E);
+  auto Parents = ParentMap.getParents(*E);
   if (Parents.size() != 1)
     return true;
   if (const auto *Cast = Parents[0].get<ImplicitCastExpr>()) {
@@ -405,7 +405,8 @@ static bool canBeModified(ASTContext *Context, const Expr *E) {
 
 /// \brief Returns true when it can be guaranteed that the elements of the
 /// container are not being modified.
-static bool usagesAreConst(ASTContext *Context, const UsageResult &Usages) {
+static bool usagesAreConst(ClangTidyParentMap &ParentMap,
+                           const UsageResult &Usages) {
   for (const Usage &U : Usages) {
     // Lambda captures are just redeclarations (VarDecl) of the same variable,
     // not expressions. If we want to know if a variable that is captured by
@@ -413,7 +414,7 @@ static bool usagesAreConst(ASTContext *Context, const UsageResult &Usages) {
     // to find the expression corresponding to that particular usage, later in
     // this loop.
     if (U.Kind != Usage::UK_CaptureByCopy && U.Kind != Usage::UK_CaptureByRef &&
-        canBeModified(Context, U.Expression))
+        canBeModified(ParentMap, U.Expression))
       return false;
   }
   return true;
@@ -576,7 +577,7 @@ void LoopConvertCheck::doConversion(
         // the replacement it must be accessed through the '.' operator.
         ReplaceText = Usage.Kind == Usage::UK_MemberThroughArrow ? VarName + "."
                                                                  : VarName;
-        auto Parents = Context->getParents(*Usage.Expression);
+        auto Parents = getParentMap().getParents(*Usage.Expression);
         if (Parents.size() == 1) {
           if (const auto *Paren = Parents[0].get<ParenExpr>()) {
             // Usage.Expression will be replaced with the new index variable,
@@ -672,7 +673,7 @@ void LoopConvertCheck::getArrayLoopQualifiers(ASTContext *Context,
                                               RangeDescriptor &Descriptor) {
   // On arrays and pseudoarrays, we must figure out the qualifiers from the
   // usages.
-  if (usagesAreConst(Context, Usages) ||
+  if (usagesAreConst(getParentMap(), Usages) ||
       containerIsConst(ContainerExpr, Descriptor.ContainerNeedsDereference)) {
     Descriptor.DerefByConstRef = true;
   }
@@ -64,8 +64,7 @@ void MakeSmartPtrCheck::storeOptions(ClangTidyOptions::OptionMap &Opts) {
 void MakeSmartPtrCheck::registerPPCallbacks(CompilerInstance &Compiler) {
   if (getLangOpts().CPlusPlus11) {
     Inserter.reset(new utils::IncludeInserter(
-        Compiler.getSourceManager(), Compiler.getLangOpts(), IncludeStyle));
-    Compiler.getPreprocessor().addPPCallbacks(Inserter->CreatePPCallbacks());
+        getIncludeGraph(), Compiler.getPreprocessor(), IncludeStyle));
   }
 }
 
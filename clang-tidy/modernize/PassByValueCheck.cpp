@@ -169,8 +169,7 @@ void PassByValueCheck::registerPPCallbacks(CompilerInstance &Compiler) {
   // benign.
   if (getLangOpts().CPlusPlus) {
     Inserter.reset(new utils::IncludeInserter(
-        Compiler.getSourceManager(), Compiler.getLangOpts(), IncludeStyle));
-    Compiler.getPreprocessor().addPPCallbacks(Inserter->CreatePPCallbacks());
+        getIncludeGraph(), Compiler.getPreprocessor(), IncludeStyle));
   }
 }
 
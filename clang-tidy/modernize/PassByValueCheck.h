@@ -26,6 +26,7 @@ public:
   void registerPPCallbacks(clang::CompilerInstance &Compiler) override;
   void registerMatchers(ast_matchers::MatchFinder *Finder) override;
   void check(const ast_matchers::MatchFinder::MatchResult &Result) override;
+  bool isSerialOnly() const override { return true; }
 
 private:
   std::unique_ptr<utils::IncludeInserter> Inserter;
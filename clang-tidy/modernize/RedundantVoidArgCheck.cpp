@@ -121,11 +121,6 @@ void RedundantVoidArgCheck::removeVoidArgumentTokens(
       Lexer::makeFileCharRange(CharSourceRange::getTokenRange(Range),
                                *Result.SourceManager, getLangOpts());
 
-  std::string DeclText =
-      Lexer::getSourceText(CharRange, *Result.SourceManager, getLangOpts())
-          .str();
-  Lexer PrototypeLexer(CharRange.getBegin(), getLangOpts(), DeclText.data(),
-                       DeclText.data(), DeclText.data() + DeclText.size());
   enum TokenState {
     NothingYet,
     SawLeftParen,
@@ -133,11 +128,12 @@ void RedundantVoidArgCheck::removeVoidArgumentTokens(
   };
   TokenState State = NothingYet;
   Token VoidToken;
-  Token ProtoToken;
   std::string Diagnostic =
       ("redundant void argument list in " + GrammarLocation).str();
 
-  while (!PrototypeLexer.LexFromRawLexer(ProtoToken)) {
+  for (const Token &ProtoToken : getTokenCache().getTokensInRange(CharRange)) {
+    if (ProtoToken.is(tok::TokenKind::comment))
+      continue;
     switch (State) {
     case NothingYet:
       if (ProtoToken.is(tok::TokenKind::l_paren)) {
@@ -163,10 +159,6 @@ void RedundantVoidArgCheck::removeVoidArgumentTokens(
       break;
     }
   }
-
-  if (State == SawVoid && ProtoToken.is(tok::TokenKind::r_paren)) {
-    removeVoidToken(VoidToken, Diagnostic);
-  }
 }
 
 void RedundantVoidArgCheck::removeVoidToken(Token VoidToken,
@@ -137,8 +137,7 @@ void ReplaceAutoPtrCheck::registerPPCallbacks(CompilerInstance &Compiler) {
   if (!getLangOpts().CPlusPlus)
     return;
   Inserter.reset(new utils::IncludeInserter(
-      Compiler.getSourceManager(), Compiler.getLangOpts(), IncludeStyle));
-  Compiler.getPreprocessor().addPPCallbacks(Inserter->CreatePPCallbacks());
+      getIncludeGraph(), Compiler.getPreprocessor(), IncludeStyle));
 }
 
 void ReplaceAutoPtrCheck::check(const MatchFinder::MatchResult &Result) {
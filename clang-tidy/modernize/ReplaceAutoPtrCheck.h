@@ -48,6 +48,7 @@ public:
   void registerMatchers(ast_matchers::MatchFinder *Finder) override;
   void registerPPCallbacks(CompilerInstance &Compiler) override;
   void check(const ast_matchers::MatchFinder::MatchResult &Result) override;
+  bool isSerialOnly() const override { return true; }
 
 private:
   std::unique_ptr<utils::IncludeInserter> Inserter;
@@ -46,9 +46,7 @@ void ReplaceRandomShuffleCheck::registerMatchers(MatchFinder *Finder) {
 void ReplaceRandomShuffleCheck::registerPPCallbacks(
     CompilerInstance &Compiler) {
   IncludeInserter = llvm::make_unique<utils::IncludeInserter>(
-      Compiler.getSourceManager(), Compiler.getLangOpts(), IncludeStyle);
-  Compiler.getPreprocessor().addPPCallbacks(
-      IncludeInserter->CreatePPCallbacks());
+      getIncludeGraph(), Compiler.getPreprocessor(), IncludeStyle);
 }
 
 void ReplaceRandomShuffleCheck::storeOptions(
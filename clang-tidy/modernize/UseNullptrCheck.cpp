@@ -171,9 +171,9 @@ private:
 /// ambiguities.
 class CastSequenceVisitor : public RecursiveASTVisitor<CastSequenceVisitor> {
 public:
-  CastSequenceVisitor(ASTContext &Context, ArrayRef<StringRef> NullMacros,
-                      ClangTidyCheck &check)
-      : SM(Context.getSourceManager()), Context(Context),
+  CastSequenceVisitor(ASTContext &Context, ClangTidyParentMap &ParentMap,
+                      ArrayRef<StringRef> NullMacros, ClangTidyCheck &check)
+      : SM(Context.getSourceManager()), Context(Context), ParentMap(ParentMap),
         NullMacros(NullMacros), Check(check), FirstSubExpr(nullptr),
         PruneSubtree(false) {}
 
@@ -419,7 +419,7 @@ private:
     assert(MacroLoc.isFileID());
 
     while (true) {
-      const auto &Parents = Context.getParents(Start);
+      const auto &Parents = ParentMap.getParents(Start);
       if (Parents.empty())
         return false;
       if (Parents.size() > 1) {
@@ -458,6 +458,7 @@ private:
 private:
   SourceManager &SM;
   ASTContext &Context;
+  ClangTidyParentMap &ParentMap;
   ArrayRef<StringRef> NullMacros;
   ClangTidyCheck &Check;
   Expr *FirstSubExpr;
@@ -491,7 +492,7 @@ void UseNullptrCheck::check(const MatchFinder::MatchResult &Result) {
   // Given an implicit null-ptr cast or an explicit cast with an implicit
   // null-to-pointer cast within use CastSequenceVisitor to identify sequences
   // of explicit casts that can be converted into 'nullptr'.
-  CastSequenceVisitor(*Result.Context, NullMacros, *this)
+  CastSequenceVisitor(*Result.Context, getParentMap(), NullMacros, *this)
       .TraverseStmt(const_cast<CastExpr *>(NullCast));
 }
 
@@ -24,26 +24,23 @@ void UseOverrideCheck::registerMatchers(MatchFinder *Finder) {
     Finder->addMatcher(cxxMethodDecl(isOverride()).bind("method"), this);
 }
 
-// Re-lex the tokens to get precise locations to insert 'override' and remove
-// 'virtual'.
+// Get the tokens of the declaration to get precise locations to insert
+// 'override' and remove 'virtual'.
 static SmallVector<Token, 16>
-ParseTokens(CharSourceRange Range, const MatchFinder::MatchResult &Result) {
+ParseTokens(CharSourceRange Range, const MatchFinder::MatchResult &Result,
+            ClangTidyTokenCache &TokenCache) {
   const SourceManager &Sources = *Result.SourceManager;
-  std::pair<FileID, unsigned> LocInfo =
-      Sources.getDecomposedLoc(Range.getBegin());
-  StringRef File = Sources.getBufferData(LocInfo.first);
-  const char *TokenBegin = File.data() + LocInfo.second;
-  Lexer RawLexer(Sources.getLocForStartOfFile(LocInfo.first),
-                 Result.Context->getLangOpts(), File.begin(), TokenBegin,
-                 File.end());
+  // Include the tokens beginning at the end of the range.
+  ArrayRef<Token> RangeTokens =
+      TokenCache.getTokensInRange(CharSourceRange::getCharRange(
+          Range.getBegin(), Range.getEnd().getLocWithOffset(1)));
   SmallVector<Token, 16> Tokens;
-  Token Tok;
   int NestedParens = 0;
-  while (!RawLexer.LexFromRawLexer(Tok)) {
+  for (Token Tok : RangeTokens) {
+    if (Tok.is(tok::comment))
+      continue;
     if ((Tok.is(tok::semi) || Tok.is(tok::l_brace)) && NestedParens == 0)
       break;
-    if (Sources.isBeforeInTranslationUnit(Range.getEnd(), Tok.getLocation()))
-      break;
     if (Tok.is(tok::l_paren))
       ++NestedParens;
     else if (Tok.is(tok::r_paren))
@@ -114,10 +111,11 @@ void UseOverrideCheck::check(const MatchFinder::MatchResult &Result) {
   if (!FileRange.isValid())
     return;
 
-  // FIXME: Instead of re-lexing and looking for specific macros such as
+  // FIXME: Instead of looking at the tokens for specific macros such as
   // 'ABSTRACT', properly store the location of 'virtual' and '= 0' in each
   // FunctionDecl.
-  SmallVector<Token, 16> Tokens = ParseTokens(FileRange, Result);
+  SmallVector<Token, 16> Tokens =
+      ParseTokens(FileRange, Result, getTokenCache());
 
   // Add 'override' on inline declarations that don't already have it.
   if (!HasFinal && !HasOverride) {
@@ -38,9 +38,7 @@ TypePromotionInMathFnCheck::TypePromotionInMathFnCheck(
 void TypePromotionInMathFnCheck::registerPPCallbacks(
     CompilerInstance &Compiler) {
   IncludeInserter = llvm::make_unique<utils::IncludeInserter>(
-      Compiler.getSourceManager(), Compiler.getLangOpts(), IncludeStyle);
-  Compiler.getPreprocessor().addPPCallbacks(
-      IncludeInserter->CreatePPCallbacks());
+      getIncludeGraph(), Compiler.getPreprocessor(), IncludeStyle);
 }
 
 void TypePromotionInMathFnCheck::storeOptions(
@@ -34,6 +34,7 @@ public:
   void storeOptions(ClangTidyOptions::OptionMap &Opts) override;
   void registerMatchers(ast_matchers::MatchFinder *Finder) override;
   void check(const ast_matchers::MatchFinder::MatchResult &Result) override;
+  bool isSerialOnly() const override { return true; }
 
 private:
   std::unique_ptr<utils::IncludeInserter> IncludeInserter;
@@ -167,8 +167,7 @@ void UnnecessaryValueParamCheck::check(const MatchFinder::MatchResult &Result) {
 void UnnecessaryValueParamCheck::registerPPCallbacks(
     CompilerInstance &Compiler) {
   Inserter.reset(new utils::IncludeInserter(
-      Compiler.getSourceManager(), Compiler.getLangOpts(), IncludeStyle));
-  Compiler.getPreprocessor().addPPCallbacks(Inserter->CreatePPCallbacks());
+      getIncludeGraph(), Compiler.getPreprocessor(), IncludeStyle));
 }
 
 void UnnecessaryValueParamCheck::storeOptions(
@@ -12,58 +12,134 @@
 #include "clang/Frontend/CompilerInstance.h"
 #include "clang/Frontend/FrontendPluginRegistry.h"
 #include "clang/Frontend/MultiplexConsumer.h"
+#include <map>
+#include <mutex>
 
 namespace clang {
 namespace tidy {
 
+namespace {
+/// The context and check factories of a plugin action. Building them parses
+/// the options, compiles the check filters and instantiates all modules.
+struct PluginState {
+  /// Owned by \c Context.
+  FileOptionsProvider *Options;
+  std::unique_ptr<ClangTidyContext> Context;
+  std::unique_ptr<ClangTidyASTConsumerFactory> Factory;
+};
+
+/// States of finished plugin actions, reused by later actions with the same
+/// arguments in the same process, e.g. in a build daemon compiling many files.
+/// One state is created per concurrently running action instead of one per
+/// translation unit.
+class PluginStatePool {
+public:
+  static PluginStatePool &instance() {
+    static PluginStatePool Pool;
+    return Pool;
+  }
+
+  std::unique_ptr<PluginState> acquire(const std::string &Key) {
+    std::lock_guard<std::mutex> Lock(Mutex);
+    auto I = Idle.find(Key);
+    if (I == Idle.end() || I->second.empty())
+      return nullptr;
+    std::unique_ptr<PluginState> State = std::move(I->second.back());
+    I->second.pop_back();
+    return State;
+  }
+
+  void release(const std::string &Key, std::unique_ptr<PluginState> State) {
+    std::lock_guard<std::mutex> Lock(Mutex);
+    Idle[Key].push_back(std::move(State));
+  }
+
+private:
+  std::mutex Mutex;
+  std::map<std::string, std::vector<std::unique_ptr<PluginState>>> Idle;
+};
+} // namespace
+
 /// The core clang tidy plugin action. This just provides the AST consumer and
 /// command line flag parsing for using clang-tidy as a clang plugin.
 class ClangTidyPluginAction : public PluginASTAction {
-  /// Wrapper to grant the context the same lifetime as the action. We use
+  /// Wrapper to keep the state of the action alive as long as the consumer
+  /// needs it and to return it to the pool afterwards. We use
   /// MultiplexConsumer to avoid writing out all the forwarding methods.
   class WrapConsumer : public MultiplexConsumer {
-    std::unique_ptr<ClangTidyContext> Context;
+    std::string Key;
+    std::unique_ptr<PluginState> State;
+
+    void releaseState() {
+      if (State)
+        PluginStatePool::instance().release(Key, std::move(State));
+    }
 
   public:
-    WrapConsumer(std::unique_ptr<ClangTidyContext> Context,
+    WrapConsumer(std::string Key, std::unique_ptr<PluginState> State,
                  std::vector<std::unique_ptr<ASTConsumer>> Consumer)
-        : MultiplexConsumer(std::move(Consumer)), Context(std::move(Context)) {}
+        : MultiplexConsumer(std::move(Consumer)), Key(std::move(Key)),
+          State(std::move(State)) {}
+
+    ~WrapConsumer() override { releaseState(); }
+
+    void HandleTranslationUnit(ASTContext &Ctx) override {
+      MultiplexConsumer::HandleTranslationUnit(Ctx);
+      // The checks are done with the context, let the next action reuse it
+      // even if the compiler never destroys this consumer (-disable-free).
+      releaseState();
+    }
   };
 
 public:
   std::unique_ptr<ASTConsumer> CreateASTConsumer(CompilerInstance &Compiler,
                                                  StringRef File) override {
+    std::unique_ptr<PluginState> State =
+        PluginStatePool::instance().acquire(Key);
+    if (!State) {
+      State = llvm::make_unique<PluginState>();
+      auto Options = llvm::make_unique<FileOptionsProvider>(
+          ClangTidyGlobalOptions(), ClangTidyOptions(), OverrideOptions);
+      State->Options = Options.get();
+      State->Context = llvm::make_unique<ClangTidyContext>(std::move(Options));
+      State->Factory =
+          llvm::make_unique<ClangTidyASTConsumerFactory>(*State->Context);
+    } else {
+      // .clang-tidy files may have changed since the state was last used.
+      State->Options->clearCache();
+    }
+
     // Insert the current diagnostics engine.
-    Context->setDiagnosticsEngine(&Compiler.getDiagnostics());
+    State->Context->setDiagnosticsEngine(&Compiler.getDiagnostics());
 
     // Create the AST consumer.
-    ClangTidyASTConsumerFactory Factory(*Context);
     std::vector<std::unique_ptr<ASTConsumer>> Vec;
-    Vec.push_back(Factory.CreateASTConsumer(Compiler, File));
+    Vec.push_back(State->Factory->CreateASTConsumer(Compiler, File));
 
-    return llvm::make_unique<WrapConsumer>(std::move(Context), std::move(Vec));
+    return llvm::make_unique<WrapConsumer>(Key, std::move(State),
+                                           std::move(Vec));
   }
 
   bool ParseArgs(const CompilerInstance &,
                  const std::vector<std::string> &Args) override {
-    ClangTidyGlobalOptions GlobalOptions;
-    ClangTidyOptions DefaultOptions;
-    ClangTidyOptions OverrideOptions;
-
     // Parse the extra command line args.
     // FIXME: This is very limited at the moment.
     for (StringRef Arg : Args)
       if (Arg.startswith("-checks="))
         OverrideOptions.Checks = Arg.substr(strlen("-checks="));
 
-    auto Options = llvm::make_unique<FileOptionsProvider>(
-        GlobalOptions, DefaultOptions, OverrideOptions);
-    Context = llvm::make_unique<ClangTidyContext>(std::move(Options));
+    // Actions with the same arguments can share their state.
+    Key.clear();
+    for (const std::string &Arg : Args) {
+      Key += Arg;
+      Key += '\0';
+    }
     return true;
   }
 
 private:
-  std::unique_ptr<ClangTidyContext> Context;
+  std::string Key;
+  ClangTidyOptions OverrideOptions;
 };
 } // namespace tidy
 } // namespace clang
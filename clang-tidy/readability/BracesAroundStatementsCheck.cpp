@@ -19,62 +19,28 @@ namespace tidy {
 namespace readability {
 namespace {
 
-tok::TokenKind getTokenKind(SourceLocation Loc, const SourceManager &SM,
-                            const ASTContext *Context) {
-  Token Tok;
-  SourceLocation Beginning =
-      Lexer::GetBeginningOfToken(Loc, SM, Context->getLangOpts());
-  const bool Invalid =
-      Lexer::getRawToken(Beginning, Tok, SM, Context->getLangOpts());
-  assert(!Invalid && "Expected a valid token.");
-
-  if (Invalid)
-    return tok::NUM_TOKENS;
-
-  return Tok.getKind();
-}
-
-SourceLocation forwardSkipWhitespaceAndComments(SourceLocation Loc,
-                                                const SourceManager &SM,
-                                                const ASTContext *Context) {
-  assert(Loc.isValid());
-  for (;;) {
-    while (isWhitespace(*SM.getCharacterData(Loc)))
-      Loc = Loc.getLocWithOffset(1);
-
-    tok::TokenKind TokKind = getTokenKind(Loc, SM, Context);
-    if (TokKind == tok::NUM_TOKENS || TokKind != tok::comment)
-      return Loc;
-
-    // Fast-forward current token.
-    Loc = Lexer::getLocForEndOfToken(Loc, 0, SM, Context->getLangOpts());
-  }
-}
-
 SourceLocation findEndLocation(SourceLocation LastTokenLoc,
                                const SourceManager &SM,
-                               const ASTContext *Context) {
-  SourceLocation Loc =
-      Lexer::GetBeginningOfToken(LastTokenLoc, SM, Context->getLangOpts());
-  // Loc points to the beginning of the last (non-comment non-ws) token
-  // before end or ';'.
-  assert(Loc.isValid());
+                               ClangTidyTokenCache &Tokens) {
+  const Token *LastTok = Tokens.getTokenAt(LastTokenLoc);
+  if (!LastTok)
+    return SourceLocation();
+  // LastTok is the last (non-comment non-ws) token before end or ';'.
   bool SkipEndWhitespaceAndComments = true;
-  tok::TokenKind TokKind = getTokenKind(Loc, SM, Context);
-  if (TokKind == tok::NUM_TOKENS || TokKind == tok::semi ||
-      TokKind == tok::r_brace) {
+  tok::TokenKind TokKind = LastTok->getKind();
+  if (TokKind == tok::semi || TokKind == tok::r_brace) {
     // If we are at ";" or "}", we found the last token. We could use as well
     // `if (isa<NullStmt>(S))`, but it wouldn't work for nested statements.
     SkipEndWhitespaceAndComments = false;
   }
 
-  Loc = Lexer::getLocForEndOfToken(Loc, 0, SM, Context->getLangOpts());
+  SourceLocation Loc =
+      LastTok->getLocation().getLocWithOffset(LastTok->getLength());
   // Loc points past the last token before end or after ';'.
   if (SkipEndWhitespaceAndComments) {
-    Loc = forwardSkipWhitespaceAndComments(Loc, SM, Context);
-    tok::TokenKind TokKind = getTokenKind(Loc, SM, Context);
-    if (TokKind == tok::semi)
-      Loc = Lexer::getLocForEndOfToken(Loc, 0, SM, Context->getLangOpts());
+    Token Next = Tokens.getNextToken(Loc, /*SkipComments=*/true);
+    if (Next.is(tok::semi))
+      Loc = Next.getLocation().getLocWithOffset(Next.getLength());
   }
 
   for (;;) {
@@ -87,17 +53,13 @@ SourceLocation findEndLocation(SourceLocation LastTokenLoc,
       // EOL, insert brace before.
       break;
     }
-    tok::TokenKind TokKind = getTokenKind(Loc, SM, Context);
-    if (TokKind != tok::comment) {
+    const Token *Tok = Tokens.getTokenAt(Loc);
+    if (!Tok || Tok->isNot(tok::comment)) {
       // Non-comment token, insert brace before.
       break;
     }
 
-    SourceLocation TokEndLoc =
-        Lexer::getLocForEndOfToken(Loc, 0, SM, Context->getLangOpts());
-    SourceRange TokRange(Loc, TokEndLoc);
-    StringRef Comment = Lexer::getSourceText(
-        CharSourceRange::getTokenRange(TokRange), SM, Context->getLangOpts());
+    StringRef Comment(SM.getCharacterData(Loc), Tok->getLength());
     if (Comment.startswith("/*") && Comment.find('\n') != StringRef::npos) {
       // Multi-line block comment, insert brace before.
       break;
@@ -105,7 +67,7 @@ SourceLocation findEndLocation(SourceLocation LastTokenLoc,
     // else: Trailing comment, insert brace after the newline.
 
     // Fast-forward current token.
-    Loc = TokEndLoc;
+    Loc = Loc.getLocWithOffset(Tok->getLength());
   }
   return Loc;
 }
@@ -189,14 +151,10 @@ BracesAroundStatementsCheck::findRParenLoc(const IfOrWhileStmt *S,
       Lexer::getLocForEndOfToken(CondEndLoc, 0, SM, Context->getLangOpts());
   if (PastCondEndLoc.isInvalid())
     return SourceLocation();
-  SourceLocation RParenLoc =
-      forwardSkipWhitespaceAndComments(PastCondEndLoc, SM, Context);
-  if (RParenLoc.isInvalid())
+  Token RParen = getTokenCache().getNextToken(PastCondEndLoc);
+  if (RParen.isNot(tok::r_paren))
     return SourceLocation();
-  tok::TokenKind TokKind = getTokenKind(RParenLoc, SM, Context);
-  if (TokKind != tok::r_paren)
-    return SourceLocation();
-  return RParenLoc;
+  return RParen.getLocation();
 }
 
 /// Determine if the statement needs braces around it, and add them if it does.
@@ -248,7 +206,9 @@ bool BracesAroundStatementsCheck::checkStmt(
     ClosingInsertion = "} ";
   } else {
     const auto FREnd = FileRange.getEnd().getLocWithOffset(-1);
-    EndLoc = findEndLocation(FREnd, SM, Context);
+    EndLoc = findEndLocation(FREnd, SM, getTokenCache());
+    if (EndLoc.isInvalid())
+      return false;
     ClosingInsertion = "\n}";
   }
 
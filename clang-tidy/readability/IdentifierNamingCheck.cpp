@@ -13,7 +13,6 @@
 #include "clang/Frontend/CompilerInstance.h"
 #include "clang/Lex/PPCallbacks.h"
 #include "clang/Lex/Preprocessor.h"
-#include "llvm/ADT/DenseMapInfo.h"
 #include "llvm/Support/Debug.h"
 #include "llvm/Support/Format.h"
 
@@ -21,44 +20,6 @@
 
 using namespace clang::ast_matchers;
 
-namespace llvm {
-/// Specialisation of DenseMapInfo to allow NamingCheckId objects in DenseMaps
-template <>
-struct DenseMapInfo<
-    clang::tidy::readability::IdentifierNamingCheck::NamingCheckId> {
-  using NamingCheckId =
-      clang::tidy::readability::IdentifierNamingCheck::NamingCheckId;
-
-  static inline NamingCheckId getEmptyKey() {
-    return NamingCheckId(
-        clang::SourceLocation::getFromRawEncoding(static_cast<unsigned>(-1)),
-        "EMPTY");
-  }
-
-  static inline NamingCheckId getTombstoneKey() {
-    return NamingCheckId(
-        clang::SourceLocation::getFromRawEncoding(static_cast<unsigned>(-2)),
-        "TOMBSTONE");
-  }
-
-  static unsigned getHashValue(NamingCheckId Val) {
-    assert(Val != getEmptyKey() && "Cannot hash the empty key!");
-    assert(Val != getTombstoneKey() && "Cannot hash the tombstone key!");
-
-    std::hash<NamingCheckId::second_type> SecondHash;
-    return Val.first.getRawEncoding() + SecondHash(Val.second);
-  }
-
-  static bool isEqual(const NamingCheckId &LHS, const NamingCheckId &RHS) {
-    if (RHS == getEmptyKey())
-      return LHS == getEmptyKey();
-    if (RHS == getTombstoneKey())
-      return LHS == getTombstoneKey();
-    return LHS == RHS;
-  }
-};
-} // namespace llvm
-
 namespace clang {
 namespace tidy {
 namespace readability {
@@ -127,6 +88,10 @@ static StringRef const StyleNames[] = {
 #undef NAMING_KEYS
 // clang-format on
 
+/// The index of identifiers following their naming style in
+/// IdentifierNamingCheck::FailureIndices.
+static const unsigned NoFailure = ~0u;
+
 namespace {
 /// Callback supplies macros to IdentifierNamingCheck::checkMacro
 class IdentifierNamingCheckPPCallbacks : public PPCallbacks {
@@ -145,7 +110,8 @@ public:
   void MacroExpands(const Token &MacroNameTok, const MacroDefinition &MD,
                     SourceRange /*Range*/,
                     const MacroArgs * /*Args*/) override {
-    Check->expandMacro(MacroNameTok, MD.getMacroInfo());
+    Check->expandMacro(PP->getSourceManager(), MacroNameTok,
+                       MD.getMacroInfo());
   }
 
 private:
@@ -224,6 +190,14 @@ void IdentifierNamingCheck::storeOptions(ClangTidyOptions::OptionMap &Opts) {
 }
 
 void IdentifierNamingCheck::registerMatchers(MatchFinder *Finder) {
+  // Don't collect usages if no declaration can violate a naming style.
+  if (std::none_of(NamingStyles.begin(),
+                   NamingStyles.begin() + SK_MacroDefinition,
+                   [](const llvm::Optional<NamingStyle> &Style) {
+                     return Style.hasValue();
+                   }))
+    return;
+
   Finder->addMatcher(namedDecl().bind("decl"), this);
   Finder->addMatcher(usingDecl().bind("using"), this);
   Finder->addMatcher(declRefExpr().bind("declRef"), this);
@@ -234,6 +208,8 @@ void IdentifierNamingCheck::registerMatchers(MatchFinder *Finder) {
 }
 
 void IdentifierNamingCheck::registerPPCallbacks(CompilerInstance &Compiler) {
+  if (!NamingStyles[SK_MacroDefinition])
+    return;
   Compiler.getPreprocessor().addPPCallbacks(
       llvm::make_unique<IdentifierNamingCheckPPCallbacks>(
           &Compiler.getPreprocessor(), this));
@@ -630,41 +606,107 @@ static StyleKind findStyleKind(
   return SK_Invalid;
 }
 
-static void addUsage(IdentifierNamingCheck::NamingCheckFailureMap &Failures,
-                     const IdentifierNamingCheck::NamingCheckId &Decl,
-                     SourceRange Range, SourceManager *SourceMgr = nullptr) {
+/// Returns the name of \p SK used in diagnostics.
+static std::string getKindName(StyleKind SK) {
+  std::string KindName =
+      fixupWithCase(StyleNames[SK], IdentifierNamingCheck::CT_LowerCase);
+  std::replace(KindName.begin(), KindName.end(), '_', ' ');
+  return KindName;
+}
+
+/// Returns the fixup of \p Name in \p Style, or an empty string if \p Name
+/// follows \p Style or can't be split into words.
+static std::string getFixup(StringRef Name, SourceLocation Location,
+                            StyleKind SK,
+                            const IdentifierNamingCheck::NamingStyle &Style,
+                            bool IgnoreFailedSplit,
+                            const SourceManager &SourceMgr) {
+  if (matchesStyle(Name, Style))
+    return std::string();
+
+  std::string Fixup = fixupWithStyle(Name, Style);
+  if (StringRef(Fixup).equals(Name)) {
+    if (!IgnoreFailedSplit) {
+      DEBUG(llvm::dbgs() << Location.printToString(SourceMgr)
+                         << llvm::format(": unable to split words for %s '%s'\n",
+                                         getKindName(SK).c_str(),
+                                         Name.str().c_str()));
+    }
+    return std::string();
+  }
+  return Fixup;
+}
+
+IdentifierNamingCheck::NamingCheckFailure *
+IdentifierNamingCheck::getFailure(const NamingCheckId &ID,
+                                  const NamedDecl *Decl,
+                                  const SourceManager &SourceMgr) {
+  // Implicit declarations and ClassTemplateSpecializationDecls, which would
+  // create duplicate replacements with their CXXRecordDecl, aren't checked
+  // themselves, but share the failure of a checked declaration with the same
+  // location and name.
+  if (Decl->getName().empty() || Decl->isImplicit() ||
+      isa<ClassTemplateSpecializationDecl>(Decl)) {
+    auto Index = FailureIndices.find(ID);
+    if (Index == FailureIndices.end() || Index->second == NoFailure)
+      return nullptr;
+    return &NamingCheckFailures[Index->second];
+  }
+
+  // The style of each identifier is evaluated once, when its declaration or
+  // first usage is seen.
+  auto Inserted = FailureIndices.insert(std::make_pair(ID, NoFailure));
+  if (!Inserted.second) {
+    unsigned Index = Inserted.first->second;
+    return Index == NoFailure ? nullptr : &NamingCheckFailures[Index];
+  }
+
+  StyleKind SK = findStyleKind(Decl, NamingStyles);
+  if (SK == SK_Invalid || !NamingStyles[SK])
+    return nullptr;
+
+  std::string Fixup =
+      getFixup(Decl->getName(), Decl->getLocation(), SK, *NamingStyles[SK],
+               IgnoreFailedSplit, SourceMgr);
+  if (Fixup.empty())
+    return nullptr;
+
+  Inserted.first->second = NamingCheckFailures.size();
+  NamingCheckFailures.emplace_back(ID, SK, std::move(Fixup));
+  return &NamingCheckFailures.back();
+}
+
+void IdentifierNamingCheck::addUsage(NamingCheckFailure &Failure,
+                                     SourceRange Range,
+                                     const SourceManager &SourceMgr,
+                                     bool UseSpellingLoc) {
+  // A failure with usages that can't be fixed isn't reported.
+  if (!Failure.ShouldFix)
+    return;
+
   // Do nothing if the provided range is invalid.
   if (Range.getBegin().isInvalid() || Range.getEnd().isInvalid())
     return;
 
-  // If we have a source manager, use it to convert to the spelling location for
-  // performing the fix. This is necessary because macros can map the same
-  // spelling location to different source locations, and we only want to fix
-  // the token once, before it is expanded by the macro.
+  // Use the spelling location for performing the fix if requested. This is
+  // necessary because macros can map the same spelling location to different
+  // source locations, and we only want to fix the token once, before it is
+  // expanded by the macro.
   SourceLocation FixLocation = Range.getBegin();
-  if (SourceMgr)
-    FixLocation = SourceMgr->getSpellingLoc(FixLocation);
+  if (UseSpellingLoc)
+    FixLocation = SourceMgr.getSpellingLoc(FixLocation);
   if (FixLocation.isInvalid())
     return;
 
-  // Try to insert the identifier location in the Usages map, and bail out if it
-  // is already in there
-  auto &Failure = Failures[Decl];
-  if (!Failure.RawUsageLocs.insert(FixLocation.getRawEncoding()).second)
-    return;
-
-  if (!Failure.ShouldFix)
-    return;
-
   // Check if the range is entirely contained within a macro argument.
   SourceLocation MacroArgExpansionStartForRangeBegin;
   SourceLocation MacroArgExpansionStartForRangeEnd;
   bool RangeIsEntirelyWithinMacroArgument =
-      SourceMgr &&
-      SourceMgr->isMacroArgExpansion(Range.getBegin(),
-                                     &MacroArgExpansionStartForRangeBegin) &&
-      SourceMgr->isMacroArgExpansion(Range.getEnd(),
-                                     &MacroArgExpansionStartForRangeEnd) &&
+      UseSpellingLoc &&
+      SourceMgr.isMacroArgExpansion(Range.getBegin(),
+                                    &MacroArgExpansionStartForRangeBegin) &&
+      SourceMgr.isMacroArgExpansion(Range.getEnd(),
+                                    &MacroArgExpansionStartForRangeEnd) &&
       MacroArgExpansionStartForRangeBegin == MacroArgExpansionStartForRangeEnd;
 
   // Check if the range contains any locations from a macro expansion.
@@ -674,32 +716,48 @@ static void addUsage(IdentifierNamingCheck::NamingCheckFailureMap &Failures,
 
   bool RangeCanBeFixed =
       RangeIsEntirelyWithinMacroArgument || !RangeContainsMacroExpansion;
-  Failure.ShouldFix = RangeCanBeFixed;
+  if (!RangeCanBeFixed) {
+    Failure.ShouldFix = false;
+    std::vector<unsigned>().swap(Failure.RawUsageLocs);
+    return;
+  }
+
+  // Matches of the same usage are usually visited one after another, drop
+  // them early. Remaining duplicates are removed at the end of the
+  // translation unit.
+  unsigned RawLoc = FixLocation.getRawEncoding();
+  if (Failure.RawUsageLocs.empty() || Failure.RawUsageLocs.back() != RawLoc)
+    Failure.RawUsageLocs.push_back(RawLoc);
 }
 
-/// Convenience method when the usage to be added is a NamedDecl
-static void addUsage(IdentifierNamingCheck::NamingCheckFailureMap &Failures,
-                     const NamedDecl *Decl, SourceRange Range,
-                     SourceManager *SourceMgr = nullptr) {
-  return addUsage(Failures, IdentifierNamingCheck::NamingCheckId(
-                                Decl->getLocation(), Decl->getNameAsString()),
-                  Range, SourceMgr);
+void IdentifierNamingCheck::addUsage(const NamedDecl *Decl, SourceRange Range,
+                                     const SourceManager &SourceMgr,
+                                     bool UseSpellingLoc) {
+  // Only declarations named by an identifier are checked.
+  const IdentifierInfo *II = Decl->getIdentifier();
+  if (!II)
+    return;
+  if (NamingCheckFailure *Failure = getFailure(
+          NamingCheckId(Decl->getLocation().getRawEncoding(), II), Decl,
+          SourceMgr))
+    addUsage(*Failure, Range, SourceMgr, UseSpellingLoc);
 }
 
 void IdentifierNamingCheck::check(const MatchFinder::MatchResult &Result) {
+  const SourceManager &SourceMgr = *Result.SourceManager;
   if (const auto *Decl =
           Result.Nodes.getNodeAs<CXXConstructorDecl>("classRef")) {
     if (Decl->isImplicit())
       return;
 
-    addUsage(NamingCheckFailures, Decl->getParent(),
-             Decl->getNameInfo().getSourceRange());
+    addUsage(Decl->getParent(),
+             Decl->getNameInfo().getSourceRange(), SourceMgr);
 
     for (const auto *Init : Decl->inits()) {
       if (!Init->isWritten() || Init->isInClassMemberInitializer())
         continue;
       if (const auto *FD = Init->getAnyMember())
-        addUsage(NamingCheckFailures, FD, SourceRange(Init->getMemberLocation()));
+        addUsage(FD, SourceRange(Init->getMemberLocation()), SourceMgr);
       // Note: delegating constructors and base class initializers are handled
       // via the "typeLoc" matcher.
     }
@@ -718,7 +776,7 @@ void IdentifierNamingCheck::check(const MatchFinder::MatchResult &Result) {
     // we want instead to replace the next token, that will be the identifier.
     Range.setBegin(CharSourceRange::getTokenRange(Range).getEnd());
 
-    addUsage(NamingCheckFailures, Decl->getParent(), Range);
+    addUsage(Decl->getParent(), Range, SourceMgr);
     return;
   }
 
@@ -735,7 +793,7 @@ void IdentifierNamingCheck::check(const MatchFinder::MatchResult &Result) {
     }
 
     if (Decl) {
-      addUsage(NamingCheckFailures, Decl, Loc->getSourceRange());
+      addUsage(Decl, Loc->getSourceRange(), SourceMgr);
       return;
     }
 
@@ -746,7 +804,7 @@ void IdentifierNamingCheck::check(const MatchFinder::MatchResult &Result) {
       SourceRange Range(Ref.getTemplateNameLoc(), Ref.getTemplateNameLoc());
       if (const auto *ClassDecl = dyn_cast<TemplateDecl>(Decl)) {
         if (const auto *TemplDecl = ClassDecl->getTemplatedDecl())
-          addUsage(NamingCheckFailures, TemplDecl, Range);
+          addUsage(TemplDecl, Range, SourceMgr);
         return;
       }
     }
@@ -754,7 +812,7 @@ void IdentifierNamingCheck::check(const MatchFinder::MatchResult &Result) {
     if (const auto &Ref =
             Loc->getAs<DependentTemplateSpecializationTypeLoc>()) {
       if (const auto *Decl = Ref.getTypePtr()->getAsTagDecl())
-        addUsage(NamingCheckFailures, Decl, Loc->getSourceRange());
+        addUsage(Decl, Loc->getSourceRange(), SourceMgr);
       return;
     }
   }
@@ -763,7 +821,7 @@ void IdentifierNamingCheck::check(const MatchFinder::MatchResult &Result) {
           Result.Nodes.getNodeAs<NestedNameSpecifierLoc>("nestedNameLoc")) {
     if (NestedNameSpecifier *Spec = Loc->getNestedNameSpecifier()) {
       if (NamespaceDecl *Decl = Spec->getAsNamespace()) {
-        addUsage(NamingCheckFailures, Decl, Loc->getLocalSourceRange());
+        addUsage(Decl, Loc->getLocalSourceRange(), SourceMgr);
         return;
       }
     }
@@ -771,16 +829,15 @@ void IdentifierNamingCheck::check(const MatchFinder::MatchResult &Result) {
 
   if (const auto *Decl = Result.Nodes.getNodeAs<UsingDecl>("using")) {
     for (const auto &Shadow : Decl->shadows()) {
-      addUsage(NamingCheckFailures, Shadow->getTargetDecl(),
-               Decl->getNameInfo().getSourceRange());
+      addUsage(Shadow->getTargetDecl(),
+               Decl->getNameInfo().getSourceRange(), SourceMgr);
     }
     return;
   }
 
   if (const auto *DeclRef = Result.Nodes.getNodeAs<DeclRefExpr>("declRef")) {
     SourceRange Range = DeclRef->getNameInfo().getSourceRange();
-    addUsage(NamingCheckFailures, DeclRef->getDecl(), Range,
-             Result.SourceManager);
+    addUsage(DeclRef->getDecl(), Range, SourceMgr, /*UseSpellingLoc=*/true);
     return;
   }
 
@@ -792,8 +849,7 @@ void IdentifierNamingCheck::check(const MatchFinder::MatchResult &Result) {
     if (const auto *Value = Result.Nodes.getNodeAs<ValueDecl>("decl")) {
       if (const auto *Typedef =
               Value->getType().getTypePtr()->getAs<TypedefType>()) {
-        addUsage(NamingCheckFailures, Typedef->getDecl(),
-                 Value->getSourceRange());
+        addUsage(Typedef->getDecl(), Value->getSourceRange(), SourceMgr);
       }
     }
 
@@ -801,138 +857,104 @@ void IdentifierNamingCheck::check(const MatchFinder::MatchResult &Result) {
     if (const auto *Value = Result.Nodes.getNodeAs<FunctionDecl>("decl")) {
       if (const auto *Typedef =
               Value->getReturnType().getTypePtr()->getAs<TypedefType>()) {
-        addUsage(NamingCheckFailures, Typedef->getDecl(),
-                 Value->getSourceRange());
+        addUsage(Typedef->getDecl(), Value->getSourceRange(), SourceMgr);
       }
       for (unsigned i = 0; i < Value->getNumParams(); ++i) {
         if (const auto *Typedef = Value->parameters()[i]
                                       ->getType()
                                       .getTypePtr()
                                       ->getAs<TypedefType>()) {
-          addUsage(NamingCheckFailures, Typedef->getDecl(),
-                   Value->getSourceRange());
+          addUsage(Typedef->getDecl(), Value->getSourceRange(), SourceMgr);
         }
       }
     }
 
-    // Ignore ClassTemplateSpecializationDecl which are creating duplicate
-    // replacements with CXXRecordDecl
-    if (isa<ClassTemplateSpecializationDecl>(Decl))
-      return;
-
-    StyleKind SK = findStyleKind(Decl, NamingStyles);
-    if (SK == SK_Invalid)
-      return;
-
-    if (!NamingStyles[SK])
-      return;
-
-    const NamingStyle &Style = *NamingStyles[SK];
-    StringRef Name = Decl->getName();
-    if (matchesStyle(Name, Style))
+    NamingCheckFailure *Failure =
+        getFailure(NamingCheckId(Decl->getLocation().getRawEncoding(),
+                                 Decl->getIdentifier()),
+                   Decl, SourceMgr);
+    if (!Failure)
       return;
 
-    std::string KindName = fixupWithCase(StyleNames[SK], CT_LowerCase);
-    std::replace(KindName.begin(), KindName.end(), '_', ' ');
-
-    std::string Fixup = fixupWithStyle(Name, Style);
-    if (StringRef(Fixup).equals(Name)) {
-      if (!IgnoreFailedSplit) {
-        DEBUG(llvm::dbgs()
-              << Decl->getLocStart().printToString(*Result.SourceManager)
-              << llvm::format(": unable to split words for %s '%s'\n",
-                              KindName.c_str(), Name.str().c_str()));
-      }
-    } else {
-      NamingCheckFailure &Failure = NamingCheckFailures[NamingCheckId(
-          Decl->getLocation(), Decl->getNameAsString())];
-      SourceRange Range =
-          DeclarationNameInfo(Decl->getDeclName(), Decl->getLocation())
-              .getSourceRange();
-
-      Failure.Fixup = std::move(Fixup);
-      Failure.KindName = std::move(KindName);
-      addUsage(NamingCheckFailures, Decl, Range);
-    }
+    Failure->Declared = true;
+    SourceRange Range =
+        DeclarationNameInfo(Decl->getDeclName(), Decl->getLocation())
+            .getSourceRange();
+    addUsage(*Failure, Range, SourceMgr, /*UseSpellingLoc=*/false);
   }
 }
 
 void IdentifierNamingCheck::checkMacro(SourceManager &SourceMgr,
                                        const Token &MacroNameTok,
                                        const MacroInfo *MI) {
-  if (!NamingStyles[SK_MacroDefinition])
+  const IdentifierInfo *II = MacroNameTok.getIdentifierInfo();
+  std::string Fixup = getFixup(II->getName(), MacroNameTok.getLocation(),
+                               SK_MacroDefinition,
+                               *NamingStyles[SK_MacroDefinition],
+                               IgnoreFailedSplit, SourceMgr);
+  if (Fixup.empty())
     return;
 
-  StringRef Name = MacroNameTok.getIdentifierInfo()->getName();
-  const NamingStyle &Style = *NamingStyles[SK_MacroDefinition];
-  if (matchesStyle(Name, Style))
+  NamingCheckId ID(MI->getDefinitionLoc().getRawEncoding(), II);
+  auto Inserted = FailureIndices.insert(
+      std::make_pair(ID, static_cast<unsigned>(NamingCheckFailures.size())));
+  if (Inserted.second)
+    NamingCheckFailures.emplace_back(ID, SK_MacroDefinition, std::move(Fixup));
+  else if (Inserted.first->second == NoFailure)
     return;
 
-  std::string KindName =
-      fixupWithCase(StyleNames[SK_MacroDefinition], CT_LowerCase);
-  std::replace(KindName.begin(), KindName.end(), '_', ' ');
-
-  std::string Fixup = fixupWithStyle(Name, Style);
-  if (StringRef(Fixup).equals(Name)) {
-    if (!IgnoreFailedSplit) {
-      DEBUG(
-          llvm::dbgs() << MacroNameTok.getLocation().printToString(SourceMgr)
-                       << llvm::format(": unable to split words for %s '%s'\n",
-                                       KindName.c_str(), Name.str().c_str()));
-    }
-  } else {
-    NamingCheckId ID(MI->getDefinitionLoc(), Name);
-    NamingCheckFailure &Failure = NamingCheckFailures[ID];
-    SourceRange Range(MacroNameTok.getLocation(), MacroNameTok.getEndLoc());
-
-    Failure.Fixup = std::move(Fixup);
-    Failure.KindName = std::move(KindName);
-    addUsage(NamingCheckFailures, ID, Range);
-  }
+  NamingCheckFailure &Failure = NamingCheckFailures[Inserted.first->second];
+  Failure.Declared = true;
+  SourceRange Range(MacroNameTok.getLocation(), MacroNameTok.getEndLoc());
+  addUsage(Failure, Range, SourceMgr, /*UseSpellingLoc=*/false);
 }
 
-void IdentifierNamingCheck::expandMacro(const Token &MacroNameTok,
+void IdentifierNamingCheck::expandMacro(SourceManager &SourceMgr,
+                                        const Token &MacroNameTok,
                                         const MacroInfo *MI) {
-  StringRef Name = MacroNameTok.getIdentifierInfo()->getName();
-  NamingCheckId ID(MI->getDefinitionLoc(), Name);
-
-  auto Failure = NamingCheckFailures.find(ID);
-  if (Failure == NamingCheckFailures.end())
+  NamingCheckId ID(MI->getDefinitionLoc().getRawEncoding(),
+                   MacroNameTok.getIdentifierInfo());
+  auto Index = FailureIndices.find(ID);
+  if (Index == FailureIndices.end() || Index->second == NoFailure)
     return;
 
   SourceRange Range(MacroNameTok.getLocation(), MacroNameTok.getEndLoc());
-  addUsage(NamingCheckFailures, ID, Range);
+  addUsage(NamingCheckFailures[Index->second], Range, SourceMgr,
+           /*UseSpellingLoc=*/false);
 }
 
 void IdentifierNamingCheck::onEndOfTranslationUnit() {
-  for (const auto &Pair : NamingCheckFailures) {
-    const NamingCheckId &Decl = Pair.first;
-    const NamingCheckFailure &Failure = Pair.second;
-
-    if (Failure.KindName.empty())
+  for (NamingCheckFailure &Failure : NamingCheckFailures) {
+    if (!Failure.Declared || !Failure.ShouldFix)
       continue;
 
-    if (Failure.ShouldFix) {
-      auto Diag = diag(Decl.first, "invalid case style for %0 '%1'")
-                  << Failure.KindName << Decl.second;
-
-      for (const auto &Loc : Failure.RawUsageLocs) {
-        // We assume that the identifier name is made of one token only. This is
-        // always the case as we ignore usages in macros that could build
-        // identifier names by combining multiple tokens.
-        //
-        // For destructors, we alread take care of it by remembering the
-        // location of the start of the identifier and not the start of the
-        // tilde.
-        //
-        // Other multi-token identifiers, such as operators are not checked at
-        // all.
-        Diag << FixItHint::CreateReplacement(
-            SourceRange(SourceLocation::getFromRawEncoding(Loc)),
-            Failure.Fixup);
-      }
+    auto Diag =
+        diag(SourceLocation::getFromRawEncoding(Failure.ID.first),
+             "invalid case style for %0 '%1'")
+        << getKindName(static_cast<StyleKind>(Failure.Kind))
+        << Failure.ID.second->getName();
+
+    std::sort(Failure.RawUsageLocs.begin(), Failure.RawUsageLocs.end());
+    Failure.RawUsageLocs.erase(std::unique(Failure.RawUsageLocs.begin(),
+                                           Failure.RawUsageLocs.end()),
+                               Failure.RawUsageLocs.end());
+    for (unsigned Loc : Failure.RawUsageLocs) {
+      // We assume that the identifier name is made of one token only. This is
+      // always the case as we ignore usages in macros that could build
+      // identifier names by combining multiple tokens.
+      //
+      // For destructors, we alread take care of it by remembering the
+      // location of the start of the identifier and not the start of the
+      // tilde.
+      //
+      // Other multi-token identifiers, such as operators are not checked at
+      // all.
+      Diag << FixItHint::CreateReplacement(
+          SourceRange(SourceLocation::getFromRawEncoding(Loc)), Failure.Fixup);
     }
   }
+  NamingCheckFailures.clear();
+  FailureIndices.clear();
 }
 
 } // namespace readability
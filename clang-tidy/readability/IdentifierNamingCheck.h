@@ -11,6 +11,10 @@
 #define LLVM_CLANG_TOOLS_EXTRA_CLANG_TIDY_READABILITY_IDENTIFIERNAMINGCHECK_H
 
 #include "../ClangTidy.h"
+#include "llvm/ADT/DenseMap.h"
+#include <string>
+#include <utility>
+#include <vector>
 
 namespace clang {
 
@@ -41,6 +45,7 @@ public:
   void check(const ast_matchers::MatchFinder::MatchResult &Result) override;
   void registerPPCallbacks(CompilerInstance &Compiler) override;
   void onEndOfTranslationUnit() override;
+  bool isSerialOnly() const override { return true; }
 
   enum CaseType {
     CT_AnyCase = 0,
@@ -64,42 +69,71 @@ public:
     std::string Suffix;
   };
 
+  /// \brief Identifies a declaration by the encoded location and the
+  /// identifier of its name.
+  typedef std::pair<unsigned, const IdentifierInfo *> NamingCheckId;
+
   /// \brief Holds an identifier name check failure, tracking the kind of the
   /// identifer, its possible fixup and the starting locations of all the
   /// identifier usages.
   struct NamingCheckFailure {
-    std::string KindName;
+    NamingCheckId ID;
+
+    /// \brief The index of the naming style the identifier violates.
+    unsigned Kind;
     std::string Fixup;
 
     /// \brief Whether the failure should be fixed or not.
     ///
     /// ie: if the identifier was used or declared within a macro we won't offer
-    /// a fixup for safety reasons.
+    /// a fixup for safety reasons. The failure isn't reported in this case, so
+    /// its usages aren't recorded anymore.
     bool ShouldFix;
 
-    /// \brief A set of all the identifier usages starting SourceLocation, in
-    /// their encoded form.
-    llvm::DenseSet<unsigned> RawUsageLocs;
-
-    NamingCheckFailure() : ShouldFix(true) {}
-  };
+    /// \brief Whether the declaration of the identifier was seen. Usages of
+    /// declarations that aren't matched themselves are not reported.
+    bool Declared;
 
-  typedef std::pair<SourceLocation, std::string> NamingCheckId;
+    /// \brief The starting SourceLocations of the identifier usages, in their
+    /// encoded form. May contain duplicates until the end of the translation
+    /// unit.
+    std::vector<unsigned> RawUsageLocs;
 
-  typedef llvm::DenseMap<NamingCheckId, NamingCheckFailure>
-      NamingCheckFailureMap;
+    NamingCheckFailure(const NamingCheckId &ID, unsigned Kind,
+                       std::string Fixup)
+        : ID(ID), Kind(Kind), Fixup(std::move(Fixup)), ShouldFix(true),
+          Declared(false) {}
+  };
 
   /// Check Macros for style violations.
   void checkMacro(SourceManager &sourceMgr, const Token &MacroNameTok,
                   const MacroInfo *MI);
 
   /// Add a usage of a macro if it already has a violation.
-  void expandMacro(const Token &MacroNameTok, const MacroInfo *MI);
+  void expandMacro(SourceManager &SourceMgr, const Token &MacroNameTok,
+                   const MacroInfo *MI);
 
 private:
+  /// \brief Returns the failure of the identifier \p ID, evaluating the style
+  /// of \p Decl the first time \p ID is seen, or null if the identifier
+  /// follows its naming style.
+  NamingCheckFailure *getFailure(const NamingCheckId &ID, const NamedDecl *Decl,
+                                 const SourceManager &SourceMgr);
+
+  /// \brief Adds the usage \p Range of \p Decl if it violates its naming
+  /// style. \p UseSpellingLoc fixes the spelling location of \p Range.
+  void addUsage(const NamedDecl *Decl, SourceRange Range,
+                const SourceManager &SourceMgr, bool UseSpellingLoc = false);
+  void addUsage(NamingCheckFailure &Failure, SourceRange Range,
+                const SourceManager &SourceMgr, bool UseSpellingLoc);
+
   std::vector<llvm::Optional<NamingStyle>> NamingStyles;
   bool IgnoreFailedSplit;
-  NamingCheckFailureMap NamingCheckFailures;
+
+  /// \brief Maps each identifier seen in the translation unit to its index
+  /// in \c NamingCheckFailures, or to ~0u if it follows its naming style.
+  llvm::DenseMap<NamingCheckId, unsigned> FailureIndices;
+  std::vector<NamingCheckFailure> NamingCheckFailures;
 };
 
 } // namespace readability
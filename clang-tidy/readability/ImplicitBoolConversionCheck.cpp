@@ -91,7 +91,8 @@ bool areParensNeededForStatement(const Stmt *Statement) {
 
 void fixGenericExprCastToBool(DiagnosticBuilder &Diag,
                               const ImplicitCastExpr *Cast, const Stmt *Parent,
-                              ASTContext &Context) {
+                              ASTContext &Context,
+                              ClangTidyParentMap &ParentMap) {
   // In case of expressions like (! integer), we should remove the redundant not
   // operator and use inverted comparison (integer == 0).
   bool InvertComparison =
@@ -103,7 +104,7 @@ void fixGenericExprCastToBool(DiagnosticBuilder &Diag,
     Diag << FixItHint::CreateRemoval(
         CharSourceRange::getCharRange(ParentStartLoc, ParentEndLoc));
 
-    Parent = Context.getParents(*Parent)[0].get<Stmt>();
+    Parent = ParentMap.getParents(*Parent)[0].get<Stmt>();
   }
 
   const Expr *SubExpr = Cast->getSubExpr();
@@ -219,11 +220,11 @@ StringRef getEquivalentForBoolLiteral(const CXXBoolLiteralExpr *BoolLiteral,
 }
 
 bool isCastAllowedInCondition(const ImplicitCastExpr *Cast,
-                              ASTContext &Context) {
+                              ClangTidyParentMap &ParentMap) {
   std::queue<const Stmt *> Q;
   Q.push(Cast);
   while (!Q.empty()) {
-    for (const auto &N : Context.getParents(*Q.front())) {
+    for (const auto &N : ParentMap.getParents(*Q.front())) {
       const Stmt *S = N.get<Stmt>();
       if (!S)
         return false;
@@ -345,12 +346,12 @@ void ImplicitBoolConversionCheck::handleCastToBool(const ImplicitCastExpr *Cast,
   if (AllowPointerConditions &&
       (Cast->getCastKind() == CK_PointerToBoolean ||
        Cast->getCastKind() == CK_MemberPointerToBoolean) &&
-      isCastAllowedInCondition(Cast, Context)) {
+      isCastAllowedInCondition(Cast, getParentMap())) {
     return;
   }
 
   if (AllowIntegerConditions && Cast->getCastKind() == CK_IntegralToBoolean &&
-      isCastAllowedInCondition(Cast, Context)) {
+      isCastAllowedInCondition(Cast, getParentMap())) {
     return;
   }
 
@@ -362,7 +363,7 @@ void ImplicitBoolConversionCheck::handleCastToBool(const ImplicitCastExpr *Cast,
   if (!EquivalentLiteral.empty()) {
     Diag << tooling::fixit::createReplacement(*Cast, EquivalentLiteral);
   } else {
-    fixGenericExprCastToBool(Diag, Cast, Parent, Context);
+    fixGenericExprCastToBool(Diag, Cast, Parent, Context, getParentMap());
   }
 }
 
@@ -31,6 +31,7 @@ public:
 
   void registerMatchers(ast_matchers::MatchFinder *Finder) override;
   void check(const ast_matchers::MatchFinder::MatchResult &Result) override;
+  bool isSerialOnly() const override { return true; }
 
 private:
   void markRedeclarationsAsVisited(const FunctionDecl *FunctionDeclaration);
@@ -18,8 +18,9 @@ namespace tidy {
 namespace readability {
 
 static const IfStmt *getPrecedingIf(const SourceManager &SM,
-                                    ASTContext *Context, const IfStmt *If) {
-  auto parents = Context->getParents(*If);
+                                    ClangTidyParentMap &ParentMap,
+                                    const IfStmt *If) {
+  auto parents = ParentMap.getParents(*If);
   if (parents.size() != 1)
     return nullptr;
   if (const auto *PrecedingIf = parents[0].get<IfStmt>()) {
@@ -32,7 +33,6 @@ static const IfStmt *getPrecedingIf(const SourceManager &SM,
 }
 
 void MisleadingIndentationCheck::danglingElseCheck(const SourceManager &SM,
-                                                   ASTContext *Context,
                                                    const IfStmt *If) {
   SourceLocation IfLoc = If->getIfLoc();
   SourceLocation ElseLoc = If->getElseLoc();
@@ -45,8 +45,8 @@ void MisleadingIndentationCheck::danglingElseCheck(const SourceManager &SM,
     return;
 
   // Find location of first 'if' in a 'if else if' chain.
-  for (auto PrecedingIf = getPrecedingIf(SM, Context, If); PrecedingIf;
-       PrecedingIf = getPrecedingIf(SM, Context, PrecedingIf))
+  for (auto PrecedingIf = getPrecedingIf(SM, getParentMap(), If); PrecedingIf;
+       PrecedingIf = getPrecedingIf(SM, getParentMap(), PrecedingIf))
     IfLoc = PrecedingIf->getIfLoc();
 
   if (SM.getExpansionColumnNumber(IfLoc) !=
@@ -112,7 +112,7 @@ void MisleadingIndentationCheck::registerMatchers(MatchFinder *Finder) {
 
 void MisleadingIndentationCheck::check(const MatchFinder::MatchResult &Result) {
   if (const auto *If = Result.Nodes.getNodeAs<IfStmt>("if"))
-    danglingElseCheck(*Result.SourceManager, Result.Context, If);
+    danglingElseCheck(*Result.SourceManager, If);
 
   if (const auto *CStmt = Result.Nodes.getNodeAs<CompoundStmt>("compound"))
     missingBracesCheck(*Result.SourceManager, CStmt);
@@ -10,7 +10,6 @@
 #include "NamespaceCommentCheck.h"
 #include "clang/AST/ASTContext.h"
 #include "clang/ASTMatchers/ASTMatchers.h"
-#include "clang/Lex/Lexer.h"
 #include "llvm/ADT/StringExtras.h"
 
 using namespace clang::ast_matchers;
@@ -73,12 +72,12 @@ void NamespaceCommentCheck::check(const MatchFinder::MatchResult &Result) {
   // Find next token after the namespace closing brace.
   SourceLocation AfterRBrace = ND->getRBraceLoc().getLocWithOffset(1);
   SourceLocation Loc = AfterRBrace;
-  Token Tok;
-  // Skip whitespace until we find the next token.
-  while (Lexer::getRawToken(Loc, Tok, Sources, getLangOpts()) ||
-         Tok.is(tok::semi)) {
-    Loc = Loc.getLocWithOffset(1);
-  }
+  // Skip whitespace and semicolons until we find the next token.
+  Token Tok = getTokenCache().getNextToken(Loc, /*SkipComments=*/false);
+  while (Tok.is(tok::semi))
+    Tok = getTokenCache().getNextToken(Tok.getLocation().getLocWithOffset(1),
+                                       /*SkipComments=*/false);
+  Loc = Tok.getLocation();
   if (!locationsInSameFile(Sources, ND->getRBraceLoc(), Loc))
     return;
 
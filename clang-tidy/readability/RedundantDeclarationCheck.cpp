@@ -45,7 +45,7 @@ void RedundantDeclarationCheck::check(const MatchFinder::MatchResult &Result) {
       (D->getLocation().isMacroID() || Prev->getLocation().isMacroID()))
     return;
   // Don't complain when the previous declaration is a friend declaration.
-  for (const auto &Parent : Result.Context->getParents(*Prev))
+  for (const auto &Parent : getParentMap().getParents(*Prev))
     if (Parent.get<FriendDecl>())
       return;
 
@@ -8,7 +8,6 @@
 //===----------------------------------------------------------------------===//
 
 #include "SimplifyBooleanExprCheck.h"
-#include "clang/AST/RecursiveASTVisitor.h"
 #include "clang/Lex/Lexer.h"
 
 #include <cassert>
@@ -318,25 +317,6 @@ bool containsDiscardedTokens(const MatchFinder::MatchResult &Result,
 
 } // namespace
 
-class SimplifyBooleanExprCheck::Visitor : public RecursiveASTVisitor<Visitor> {
-  using Base = RecursiveASTVisitor<Visitor>;
-
- public:
-  Visitor(SimplifyBooleanExprCheck *Check,
-          const MatchFinder::MatchResult &Result)
-      : Check(Check), Result(Result) {}
-
-  bool VisitBinaryOperator(BinaryOperator *Op) {
-    Check->reportBinOp(Result, Op);
-    return true;
-  }
-
- private:
-  SimplifyBooleanExprCheck *Check;
-  const MatchFinder::MatchResult &Result;
-};
-
-
 SimplifyBooleanExprCheck::SimplifyBooleanExprCheck(StringRef Name,
                                                    ClangTidyContext *Context)
     : ClangTidyCheck(Name, Context),
@@ -508,8 +488,6 @@ void SimplifyBooleanExprCheck::storeOptions(ClangTidyOptions::OptionMap &Opts) {
 }
 
 void SimplifyBooleanExprCheck::registerMatchers(MatchFinder *Finder) {
-  Finder->addMatcher(translationUnitDecl().bind("top"), this);
-
   matchBoolCondition(Finder, true, ConditionThenStmtId);
   matchBoolCondition(Finder, false, ConditionElseStmtId);
 
@@ -556,8 +534,16 @@ void SimplifyBooleanExprCheck::check(const MatchFinder::MatchResult &Result) {
   else if (const auto *Compound =
                Result.Nodes.getNodeAs<CompoundStmt>(CompoundNotBoolId))
     replaceCompoundReturnWithCondition(Result, Compound, true);
-  else if (const auto TU = Result.Nodes.getNodeAs<Decl>("top"))
-    Visitor(this, Result).TraverseDecl(const_cast<Decl*>(TU));
+}
+
+void SimplifyBooleanExprCheck::registerSharedVisitorCallbacks(
+    ClangTidySharedVisitor &Visitor) {
+  Visitor.addStmtCallback(this, Stmt::BinaryOperatorClass);
+}
+
+void SimplifyBooleanExprCheck::visitStmt(
+    const Stmt *S, const MatchFinder::MatchResult &Result) {
+  reportBinOp(Result, cast<BinaryOperator>(S));
 }
 
 void SimplifyBooleanExprCheck::issueDiag(
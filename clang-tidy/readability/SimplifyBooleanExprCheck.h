@@ -28,10 +28,11 @@ public:
   void storeOptions(ClangTidyOptions::OptionMap &Options) override;
   void registerMatchers(ast_matchers::MatchFinder *Finder) override;
   void check(const ast_matchers::MatchFinder::MatchResult &Result) override;
+  void registerSharedVisitorCallbacks(ClangTidySharedVisitor &Visitor) override;
+  void visitStmt(const Stmt *S,
+                 const ast_matchers::MatchFinder::MatchResult &Result) override;
 
 private:
-  class Visitor;
-
   void reportBinOp(const ast_matchers::MatchFinder::MatchResult &Result,
                    const BinaryOperator *Op);
 
@@ -16,6 +16,7 @@
 //===----------------------------------------------------------------------===//
 
 #include "../ClangTidy.h"
+#include "../ClangTidyResultCache.h"
 #include "clang/Tooling/CommonOptionsParser.h"
 #include "llvm/Support/Process.h"
 
@@ -106,10 +107,22 @@ JSON array of objects:
                                        cl::init(""),
                                        cl::cat(ClangTidyCategory));
 
+static cl::opt<bool> RestrictToLineFilter("restrict-to-line-filter",
+                                          cl::desc(R"(
+Only run checks on top-level declarations that
+intersect the line ranges specified with
+-line-filter. This makes the analysis time depend
+on the size of the filtered ranges rather than on
+the size of the translation unit, but checks will
+not see code outside of these declarations.
+)"),
+                                          cl::init(false),
+                                          cl::cat(ClangTidyCategory));
+
 static cl::opt<bool> Fix("fix", cl::desc(R"(
 Apply suggested fixes. Without -fix-errors
-clang-tidy will bail out if any compilation
-errors were found.
+clang-tidy doesn't apply the fixes of
+translation units with compilation errors.
 )"),
                          cl::init(false), cl::cat(ClangTidyCategory));
 
@@ -199,6 +212,34 @@ code with clang-apply-replacements.
                                         cl::value_desc("filename"),
                                         cl::cat(ClangTidyCategory));
 
+static cl::opt<std::string> ResultCacheDir("result-cache-dir", cl::desc(R"(
+Directory to store the results of analyzing each
+translation unit in. The stored results are
+reused instead of analyzing a translation unit
+again as long as its compile command, its
+configuration and all files it includes are
+unchanged.
+)"),
+                                           cl::value_desc("directory"),
+                                           cl::cat(ClangTidyCategory));
+
+static cl::opt<unsigned> Jobs("j", cl::desc(R"(
+Number of threads analyzing translation units
+concurrently. Fixes of all translation units
+are collected in memory, deduplicated and
+applied (or exported) at once.
+)"),
+                             cl::init(1), cl::cat(ClangTidyCategory));
+
+static cl::opt<unsigned> MatchingJobs("matching-jobs", cl::desc(R"(
+Number of worker processes matching chunks of
+the top-level declarations of each translation
+unit. Checks that need the whole translation
+unit still run in the main process. Can't be
+combined with -j.
+)"),
+                                      cl::init(1), cl::cat(ClangTidyCategory));
+
 static cl::opt<bool> Quiet("quiet", cl::desc(R"(
 Run clang-tidy in quiet mode. This suppresses
 printing statistics about ignored warnings and
@@ -285,6 +326,8 @@ static std::unique_ptr<ClangTidyOptionsProvider> createOptionsProvider() {
     llvm::cl::PrintHelpMessage(/*Hidden=*/false, /*Categorized=*/true);
     return nullptr;
   }
+  GlobalOptions.RestrictToLineFilter = RestrictToLineFilter;
+  GlobalOptions.MatchingJobs = MatchingJobs;
 
   ClangTidyOptions DefaultOptions;
   DefaultOptions.Checks = DefaultChecks;
@@ -401,40 +444,42 @@ static int clangTidyMain(int argc, const char **argv) {
     return 0;
   }
 
+  if (Jobs > 1 && MatchingJobs > 1) {
+    llvm::errs() << "Error: -matching-jobs can't be combined with -j.\n";
+    return 1;
+  }
+
   ProfileData Profile;
 
+  std::unique_ptr<ClangTidyResultCache> ResultCache;
+  if (!ResultCacheDir.empty())
+    ResultCache = llvm::make_unique<ClangTidyResultCache>(ResultCacheDir);
+
   ClangTidyContext Context(std::move(OwningOptionsProvider));
+  // Errors are displayed as soon as each translation unit is analyzed, only
+  // their fixes and the errors to export are kept until all files are done.
+  // -fix-errors implies -fix.
+  StreamingErrorHandler ErrorHandler(Context, FixErrors || Fix, FixErrors,
+                                     FilePath.str(), ExportFixes);
   runClangTidy(Context, OptionsParser.getCompilations(), PathList,
-               EnableCheckProfile ? &Profile : nullptr);
-  ArrayRef<ClangTidyError> Errors = Context.getErrors();
-  bool FoundErrors =
-      std::find_if(Errors.begin(), Errors.end(), [](const ClangTidyError &E) {
-        return E.DiagLevel == ClangTidyError::Error;
-      }) != Errors.end();
+               EnableCheckProfile ? &Profile : nullptr, ResultCache.get(),
+               Jobs, &ErrorHandler);
 
-  const bool DisableFixes = Fix && FoundErrors && !FixErrors;
+  const bool DroppedFixes =
+      Fix && ErrorHandler.foundCompilerErrors() && !FixErrors;
 
   unsigned WErrorCount = 0;
 
-  // -fix-errors implies -fix.
-  handleErrors(Context, (FixErrors || Fix) && !DisableFixes, WErrorCount);
-
-  if (!ExportFixes.empty() && !Errors.empty()) {
-    std::error_code EC;
-    llvm::raw_fd_ostream OS(ExportFixes, EC, llvm::sys::fs::F_None);
-    if (EC) {
-      llvm::errs() << "Error opening output file: " << EC.message() << '\n';
-      return 1;
-    }
-    exportReplacements(FilePath.str(), Errors, OS);
-  }
+  if (!ErrorHandler.finish(WErrorCount))
+    return 1;
 
   if (!Quiet) {
     printStats(Context.getStats());
-    if (DisableFixes)
+    if (DroppedFixes)
       llvm::errs()
           << "Found compiler errors, but -fix-errors was not specified.\n"
-             "Fixes have NOT been applied.\n\n";
+             "Fixes of translation units with compiler errors have NOT been "
+             "applied.\n\n";
   }
 
   if (EnableCheckProfile)
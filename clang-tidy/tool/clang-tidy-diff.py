@@ -67,6 +67,12 @@ def main():
                       'command line.')
   parser.add_argument('-quiet', action='store_true', default=False,
                       help='Run clang-tidy in quiet mode')
+  parser.add_argument('-restrict-to-line-filter', action='store_true',
+                      default=False,
+                      help='Only run checks on the declarations containing '
+                      'changed lines. Faster, but checks that need to see '
+                      'the whole translation unit (e.g. '
+                      'misc-unused-using-decls) may report false positives')
   clang_tidy_args = []
   argv = sys.argv[1:]
   if '--' in argv:
@@ -126,6 +132,8 @@ def main():
     command.append('-checks=' + quote + args.checks + quote)
   if args.quiet:
     command.append('-quiet')
+  if args.restrict_to_line_filter:
+    command.append('-restrict-to-line-filter')
   if args.build_path is not None:
     command.append('-p=%s' % args.build_path)
   command.extend(lines_by_file.keys())
@@ -15,7 +15,7 @@ Parallel clang-tidy runner
 ==========================
 
 Runs clang-tidy over all files in a compilation database. Requires clang-tidy
-and clang-apply-replacements in $PATH.
+in $PATH.
 
 Example invocations.
 - Run clang-tidy on all files in the current working directory with a default
@@ -37,18 +37,14 @@ http://clang.llvm.org/docs/HowToSetupToolingForLLVM.html
 from __future__ import print_function
 
 import argparse
-import glob
 import json
 import multiprocessing
 import os
 import re
-import shutil
 import subprocess
 import sys
 import tempfile
 import threading
-import traceback
-import yaml
 
 is_py2 = sys.version[0] == '2'
 
@@ -68,8 +64,10 @@ def find_compilation_database(path):
   return os.path.realpath(result)
 
 
-def get_tidy_invocation(f, clang_tidy_binary, checks, tmpdir, build_path,
-                        header_filter, extra_arg, extra_arg_before, quiet):
+def get_tidy_invocation(files, clang_tidy_binary, checks, build_path,
+                        header_filter, extra_arg, extra_arg_before, quiet,
+                        jobs=None, fix=False, format_style=None,
+                        export_fixes=None):
   """Gets a command line for clang-tidy."""
   start = [clang_tidy_binary]
   if header_filter is not None:
@@ -79,13 +77,14 @@ def get_tidy_invocation(f, clang_tidy_binary, checks, tmpdir, build_path,
     start.append('-header-filter=^' + build_path + '/.*')
   if checks:
     start.append('-checks=' + checks)
-  if tmpdir is not None:
-    start.append('-export-fixes')
-    # Get a temporary file. We immediately close the handle so clang-tidy can
-    # overwrite it.
-    (handle, name) = tempfile.mkstemp(suffix='.yaml', dir=tmpdir)
-    os.close(handle)
-    start.append(name)
+  if jobs is not None:
+    start.append('-j=%d' % jobs)
+  if fix:
+    start.append('-fix')
+  if format_style is not None:
+    start.append('-format-style=' + format_style)
+  if export_fixes is not None:
+    start.append('-export-fixes=' + export_fixes)
   for arg in extra_arg:
       start.append('-extra-arg=%s' % arg)
   for arg in extra_arg_before:
@@ -93,65 +92,40 @@ def get_tidy_invocation(f, clang_tidy_binary, checks, tmpdir, build_path,
   start.append('-p=' + build_path)
   if quiet:
       start.append('-quiet')
-  start.append(f)
+  start.extend(files)
   return start
 
 
-def merge_replacement_files(tmpdir, mergefile):
-  """Merge all replacement files in a directory into a single file"""
-  # The fixes suggested by clang-tidy >= 4.0.0 are given under
-  # the top level key 'Diagnostics' in the output yaml files
-  mergekey="Diagnostics"
-  merged=[]
-  for replacefile in glob.iglob(os.path.join(tmpdir, '*.yaml')):
-    content = yaml.safe_load(open(replacefile, 'r'))
-    if not content:
-      continue # Skip empty files.
-    merged.extend(content.get(mergekey, []))
-
-  if merged:
-    # MainSourceFile: The key is required by the definition inside
-    # include/clang/Tooling/ReplacementsYaml.h, but the value
-    # is actually never used inside clang-apply-replacements,
-    # so we set it to '' here.
-    output = { 'MainSourceFile': '', mergekey: merged }
-    with open(mergefile, 'w') as out:
-      yaml.safe_dump(output, out)
-  else:
-    # Empty the file:
-    open(mergefile, 'w').close()
-
-
-def check_clang_apply_replacements_binary(args):
-  """Checks if invoking supplied clang-apply-replacements binary works."""
+def run_tidy_with_fixes(args, build_path, files, jobs):
+  """Runs a single clang-tidy process on all files, which analyzes them on
+  multiple threads and applies or exports the fixes of all files at once."""
+  # Pass the file names in a response file, the command line could get too long
+  # for large projects.
+  (handle, response_file) = tempfile.mkstemp(suffix='.rsp')
   try:
-    subprocess.check_call([args.clang_apply_replacements_binary, '--version'])
-  except:
-    print('Unable to run clang-apply-replacements. Is clang-apply-replacements '
-          'binary correctly specified?', file=sys.stderr)
-    traceback.print_exc()
-    sys.exit(1)
-
-
-def apply_fixes(args, tmpdir):
-  """Calls clang-apply-fixes on a given directory."""
-  invocation = [args.clang_apply_replacements_binary]
-  if args.format:
-    invocation.append('-format')
-  if args.style:
-    invocation.append('-style=' + args.style)
-  invocation.append(tmpdir)
-  subprocess.call(invocation)
+    with os.fdopen(handle, 'w') as out:
+      for name in files:
+        out.write('"%s"\n' % name.replace('\\', '\\\\').replace('"', '\\"'))
+    invocation = get_tidy_invocation(
+        ['@' + response_file], args.clang_tidy_binary, args.checks, build_path,
+        args.header_filter, args.extra_arg, args.extra_arg_before, args.quiet,
+        jobs=jobs, fix=args.fix,
+        format_style=args.style if args.fix and args.format else None,
+        export_fixes=args.export_fixes)
+    sys.stdout.write(' '.join(invocation) + '\n')
+    subprocess.call(invocation)
+  finally:
+    os.remove(response_file)
 
 
-def run_tidy(args, tmpdir, build_path, queue):
+def run_tidy(args, build_path, queue):
   """Takes filenames out of queue and runs clang-tidy on them."""
   while True:
     name = queue.get()
-    invocation = get_tidy_invocation(name, args.clang_tidy_binary, args.checks,
-                                     tmpdir, build_path, args.header_filter,
-                                     args.extra_arg, args.extra_arg_before,
-                                     args.quiet)
+    invocation = get_tidy_invocation([name], args.clang_tidy_binary,
+                                     args.checks, build_path,
+                                     args.header_filter, args.extra_arg,
+                                     args.extra_arg_before, args.quiet)
     sys.stdout.write(' '.join(invocation) + '\n')
     subprocess.call(invocation)
     queue.task_done()
@@ -160,14 +134,10 @@ def run_tidy(args, tmpdir, build_path, queue):
 def main():
   parser = argparse.ArgumentParser(description='Runs clang-tidy over all files '
                                    'in a compilation database. Requires '
-                                   'clang-tidy and clang-apply-replacements in '
-                                   '$PATH.')
+                                   'clang-tidy in $PATH.')
   parser.add_argument('-clang-tidy-binary', metavar='PATH',
                       default='clang-tidy',
                       help='path to clang-tidy binary')
-  parser.add_argument('-clang-apply-replacements-binary', metavar='PATH',
-                      default='clang-apply-replacements',
-                      help='path to clang-apply-replacements binary')
   parser.add_argument('-checks', default=None,
                       help='checks filter, when not specified, use clang-tidy '
                       'default')
@@ -229,27 +199,32 @@ def main():
   if max_task == 0:
     max_task = multiprocessing.cpu_count()
 
-  tmpdir = None
-  if args.fix or args.export_fixes:
-    check_clang_apply_replacements_binary(args)
-    tmpdir = tempfile.mkdtemp()
-
   # Build up a big regexy filter from all command line arguments.
   file_name_re = re.compile('|'.join(args.files))
+  files = [name for name in files if file_name_re.search(name)]
+
+  if args.fix or args.export_fixes:
+    # A single clang-tidy process collects the fixes of all files in memory,
+    # so that they don't need to be merged and applied separately.
+    try:
+      run_tidy_with_fixes(args, build_path, files, max_task)
+    except KeyboardInterrupt:
+      print('\nCtrl-C detected, goodbye.')
+      sys.exit(1)
+    sys.exit(0)
 
   try:
     # Spin up a bunch of tidy-launching threads.
     task_queue = queue.Queue(max_task)
     for _ in range(max_task):
       t = threading.Thread(target=run_tidy,
-                           args=(args, tmpdir, build_path, task_queue))
+                           args=(args, build_path, task_queue))
       t.daemon = True
       t.start()
 
     # Fill the queue with files.
     for name in files:
-      if file_name_re.search(name):
-        task_queue.put(name)
+      task_queue.put(name)
 
     # Wait for all threads to be done.
     task_queue.join()
@@ -258,32 +233,7 @@ def main():
     # This is a sad hack. Unfortunately subprocess goes
     # bonkers with ctrl-c and we start forking merrily.
     print('\nCtrl-C detected, goodbye.')
-    if tmpdir:
-      shutil.rmtree(tmpdir)
     os.kill(0, 9)
 
-  return_code = 0
-  if args.export_fixes:
-    print('Writing fixes to ' + args.export_fixes + ' ...')
-    try:
-      merge_replacement_files(tmpdir, args.export_fixes)
-    except:
-      print('Error exporting fixes.\n', file=sys.stderr)
-      traceback.print_exc()
-      return_code=1
-
-  if args.fix:
-    print('Applying fixes ...')
-    try:
-      apply_fixes(args, tmpdir)
-    except:
-      print('Error applying fixes.\n', file=sys.stderr)
-      traceback.print_exc()
-      return_code=1
-
-  if tmpdir:
-    shutil.rmtree(tmpdir)
-  sys.exit(return_code)
-
 if __name__ == '__main__':
   main()
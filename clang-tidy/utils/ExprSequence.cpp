@@ -21,15 +21,15 @@ namespace utils {
 //
 // The case that a Stmt has multiple parents is rare but does actually occur in
 // the parts of the AST that we're interested in. Specifically, InitListExpr
-// nodes cause ASTContext::getParent() to return multiple parents for certain
-// nodes in their subtree because RecursiveASTVisitor visits both the syntactic
-// and semantic forms of InitListExpr, and the parent-child relationships are
-// different between the two forms.
-static SmallVector<const Stmt *, 1> getParentStmts(const Stmt *S,
-                                                   ASTContext *Context) {
+// nodes cause ClangTidyParentMap::getParents() to return multiple parents for
+// certain nodes in their subtree because RecursiveASTVisitor visits both the
+// syntactic and semantic forms of InitListExpr, and the parent-child
+// relationships are different between the two forms.
+static SmallVector<const Stmt *, 1>
+getParentStmts(const Stmt *S, ClangTidyParentMap &ParentMap) {
   SmallVector<const Stmt *, 1> Result;
 
-  ASTContext::DynTypedNodeList Parents = Context->getParents(*S);
+  ASTContext::DynTypedNodeList Parents = ParentMap.getParents(*S);
 
   SmallVector<ast_type_traits::DynTypedNode, 1> NodesToProcess(Parents.begin(),
                                                                Parents.end());
@@ -41,7 +41,7 @@ static SmallVector<const Stmt *, 1> getParentStmts(const Stmt *S,
     if (const auto *S = Node.get<Stmt>()) {
       Result.push_back(S);
     } else {
-      Parents = Context->getParents(Node);
+      Parents = ParentMap.getParents(Node);
       NodesToProcess.append(Parents.begin(), Parents.end());
     }
   }
@@ -51,11 +51,11 @@ static SmallVector<const Stmt *, 1> getParentStmts(const Stmt *S,
 
 namespace {
 bool isDescendantOrEqual(const Stmt *Descendant, const Stmt *Ancestor,
-                         ASTContext *Context) {
+                         ClangTidyParentMap &ParentMap) {
   if (Descendant == Ancestor)
     return true;
-  for (const Stmt *Parent : getParentStmts(Descendant, Context)) {
-    if (isDescendantOrEqual(Parent, Ancestor, Context))
+  for (const Stmt *Parent : getParentStmts(Descendant, ParentMap)) {
+    if (isDescendantOrEqual(Parent, Ancestor, ParentMap))
       return true;
   }
 
@@ -63,8 +63,8 @@ bool isDescendantOrEqual(const Stmt *Descendant, const Stmt *Ancestor,
 }
 }
 
-ExprSequence::ExprSequence(const CFG *TheCFG, ASTContext *TheContext)
-    : Context(TheContext) {
+ExprSequence::ExprSequence(const CFG *TheCFG, ClangTidyParentMap &ParentMap)
+    : ParentMap(ParentMap) {
   for (const auto &SyntheticStmt : TheCFG->synthetic_stmts()) {
     SyntheticStmtSourceMap[SyntheticStmt.first] = SyntheticStmt.second;
   }
@@ -78,13 +78,13 @@ bool ExprSequence::inSequence(const Stmt *Before, const Stmt *After) const {
   // chain of successors, we know that 'After' is sequenced after 'Before'.
   for (const Stmt *Successor = getSequenceSuccessor(Before); Successor;
        Successor = getSequenceSuccessor(Successor)) {
-    if (isDescendantOrEqual(After, Successor, Context))
+    if (isDescendantOrEqual(After, Successor, ParentMap))
       return true;
   }
 
   // If 'After' is a parent of 'Before' or is sequenced after one of these
   // parents, we know that it is sequenced after 'Before'.
-  for (const Stmt *Parent : getParentStmts(Before, Context)) {
+  for (const Stmt *Parent : getParentStmts(Before, ParentMap)) {
     if (Parent == After || inSequence(Parent, After))
       return true;
   }
@@ -98,7 +98,7 @@ bool ExprSequence::potentiallyAfter(const Stmt *After,
 }
 
 const Stmt *ExprSequence::getSequenceSuccessor(const Stmt *S) const {
-  for (const Stmt *Parent : getParentStmts(S, Context)) {
+  for (const Stmt *Parent : getParentStmts(S, ParentMap)) {
     if (const auto *BO = dyn_cast<BinaryOperator>(Parent)) {
       // Comma operator: Right-hand side is sequenced after the left-hand side.
       if (BO->getLHS() == S && BO->getOpcode() == BO_Comma)
@@ -156,8 +156,9 @@ const Stmt *ExprSequence::resolveSyntheticStmt(const Stmt *S) const {
   return S;
 }
 
-StmtToBlockMap::StmtToBlockMap(const CFG *TheCFG, ASTContext *TheContext)
-    : Context(TheContext) {
+StmtToBlockMap::StmtToBlockMap(const CFG *TheCFG,
+                               ClangTidyParentMap &ParentMap)
+    : ParentMap(ParentMap) {
   for (const auto *B : *TheCFG) {
     for (const auto &Elem : *B) {
       if (Optional<CFGStmt> S = Elem.getAs<CFGStmt>())
@@ -168,7 +169,7 @@ StmtToBlockMap::StmtToBlockMap(const CFG *TheCFG, ASTContext *TheContext)
 
 const CFGBlock *StmtToBlockMap::blockContainingStmt(const Stmt *S) const {
   while (!Map.count(S)) {
-    SmallVector<const Stmt *, 1> Parents = getParentStmts(S, Context);
+    SmallVector<const Stmt *, 1> Parents = getParentStmts(S, ParentMap);
     if (Parents.empty())
       return nullptr;
     S = Parents[0];
@@ -69,8 +69,8 @@ namespace utils {
 class ExprSequence {
 public:
   /// Initializes this `ExprSequence` with sequence information for the given
-  /// `CFG`.
-  ExprSequence(const CFG *TheCFG, ASTContext *TheContext);
+  /// `CFG`. The parents of statements are looked up in \p ParentMap.
+  ExprSequence(const CFG *TheCFG, ClangTidyParentMap &ParentMap);
 
   /// Returns whether \p Before is sequenced before \p After.
   bool inSequence(const Stmt *Before, const Stmt *After) const;
@@ -93,7 +93,7 @@ private:
 
   const Stmt *resolveSyntheticStmt(const Stmt *S) const;
 
-  ASTContext *Context;
+  ClangTidyParentMap &ParentMap;
 
   llvm::DenseMap<const Stmt *, const Stmt *> SyntheticStmtSourceMap;
 };
@@ -103,8 +103,9 @@ private:
 /// innermost block (i.e. the one that is furthest from the root of the tree).
 class StmtToBlockMap {
 public:
-  /// Initializes the map for the given `CFG`.
-  StmtToBlockMap(const CFG *TheCFG, ASTContext *TheContext);
+  /// Initializes the map for the given `CFG`. The parents of statements are
+  /// looked up in \p ParentMap.
+  StmtToBlockMap(const CFG *TheCFG, ClangTidyParentMap &ParentMap);
 
   /// Returns the block that \p S is contained in. Some `Stmt`s may be contained
   /// in more than one `CFGBlock`; in this case, this function returns the
@@ -112,7 +113,7 @@ public:
   const CFGBlock *blockContainingStmt(const Stmt *S) const;
 
 private:
-  ASTContext *Context;
+  ClangTidyParentMap &ParentMap;
 
   llvm::DenseMap<const Stmt *, const CFGBlock *> Map;
 };
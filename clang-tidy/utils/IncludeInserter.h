@@ -14,7 +14,7 @@
 #include "clang/Basic/Diagnostic.h"
 #include "clang/Basic/LangOptions.h"
 #include "clang/Basic/SourceManager.h"
-#include "clang/Lex/PPCallbacks.h"
+#include "clang/Lex/Preprocessor.h"
 #include <memory>
 #include <string>
 
@@ -25,16 +25,17 @@ namespace utils {
 /// \brief Produces fixes to insert specified includes to source files, if not
 /// yet present.
 ///
-/// ``IncludeInserter`` can be used by ``ClangTidyCheck`` in the following
-/// fashion:
+/// The existing inclusion directives are taken from the
+/// \c ClangTidyIncludeGraph of the check, which records them once for all
+/// checks of the translation unit. ``IncludeInserter`` can be used by
+/// ``ClangTidyCheck`` in the following fashion:
 /// \code
 /// class MyCheck : public ClangTidyCheck {
 ///  public:
 ///   void registerPPCallbacks(CompilerInstance& Compiler) override {
-///     Inserter.reset(new IncludeInserter(&Compiler.getSourceManager(),
-///                                        &Compiler.getLangOpts()));
-///     Compiler.getPreprocessor().addPPCallbacks(
-///         Inserter->CreatePPCallback());
+///     Inserter.reset(new IncludeInserter(getIncludeGraph(),
+///                                        Compiler.getPreprocessor(),
+///                                        IncludeSorter::IS_LLVM));
 ///   }
 ///
 ///   void registerMatchers(ast_matchers::MatchFinder* Finder) override { ... }
@@ -54,28 +55,27 @@ namespace utils {
 /// \endcode
 class IncludeInserter {
 public:
-  IncludeInserter(const SourceManager &SourceMgr, const LangOptions &LangOpts,
+  /// Attaches \p Includes to \p PP to record the existing inclusions.
+  IncludeInserter(ClangTidyIncludeGraph &Includes, Preprocessor &PP,
                   IncludeSorter::IncludeStyle Style);
   ~IncludeInserter();
 
-  /// Create ``PPCallbacks`` for registration with the compiler's preprocessor.
-  std::unique_ptr<PPCallbacks> CreatePPCallbacks();
-
   /// Creates a \p Header inclusion directive fixit. Returns ``llvm::None`` on
   /// error or if inclusion directive already exists.
   llvm::Optional<FixItHint>
   CreateIncludeInsertion(FileID FileID, llvm::StringRef Header, bool IsAngled);
 
 private:
-  void AddInclude(StringRef FileName, bool IsAngled,
-                  SourceLocation HashLocation, SourceLocation EndLocation);
+  /// Returns the sorter of \p FileID, which is created from the recorded
+  /// inclusions of the file on the first insertion into it.
+  IncludeSorter &getSorter(FileID FileID);
 
   llvm::DenseMap<FileID, std::unique_ptr<IncludeSorter>> IncludeSorterByFile;
   llvm::DenseMap<FileID, std::set<std::string>> InsertedHeaders;
+  const ClangTidyIncludeGraph &Includes;
   const SourceManager &SourceMgr;
   const LangOptions &LangOpts;
   const IncludeSorter::IncludeStyle Style;
-  friend class IncludeInserterCallback;
 };
 
 } // namespace utils
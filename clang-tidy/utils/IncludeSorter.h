@@ -17,7 +17,7 @@ namespace clang {
 namespace tidy {
 namespace utils {
 
-/// Class used by ``IncludeInserterCallback`` to record the names of the
+/// Class used by ``IncludeInserter`` to record the names of the
 /// inclusions in a given source file being processed and generate the necessary
 /// commands to sort the inclusions according to the precedence encoded in
 /// ``IncludeKinds``.
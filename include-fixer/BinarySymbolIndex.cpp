@@ -0,0 +1,52 @@
+//===-- BinarySymbolIndex.cpp ---------------------------------------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#include "BinarySymbolIndex.h"
+#include "llvm/ADT/SmallString.h"
+#include "llvm/Support/Errc.h"
+#include "llvm/Support/Path.h"
+
+using clang::find_all_symbols::BinarySymbolDatabase;
+using clang::find_all_symbols::SymbolAndSignals;
+
+namespace clang {
+namespace include_fixer {
+
+llvm::ErrorOr<std::unique_ptr<BinarySymbolIndex>>
+BinarySymbolIndex::createFromFile(llvm::StringRef FilePath) {
+  auto Database = BinarySymbolDatabase::createFromFile(FilePath);
+  if (!Database)
+    return Database.getError();
+
+  return std::unique_ptr<BinarySymbolIndex>(
+      new BinarySymbolIndex(std::move(*Database)));
+}
+
+llvm::ErrorOr<std::unique_ptr<BinarySymbolIndex>>
+BinarySymbolIndex::createFromDirectory(llvm::StringRef Directory,
+                                       llvm::StringRef Name) {
+  // Walk upwards from Directory, looking for files.
+  for (llvm::SmallString<128> PathStorage = Directory; !Directory.empty();
+       Directory = llvm::sys::path::parent_path(Directory)) {
+    assert(Directory.size() <= PathStorage.size());
+    PathStorage.resize(Directory.size()); // Shrink to parent.
+    llvm::sys::path::append(PathStorage, Name);
+    if (auto DB = createFromFile(PathStorage))
+      return DB;
+  }
+  return llvm::make_error_code(llvm::errc::no_such_file_or_directory);
+}
+
+std::vector<SymbolAndSignals>
+BinarySymbolIndex::search(llvm::StringRef Identifier) {
+  return Database->lookup(Identifier);
+}
+
+} // namespace include_fixer
+} // namespace clang
@@ -0,0 +1,47 @@
+//===-- BinarySymbolIndex.h -------------------------------------*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_CLANG_TOOLS_EXTRA_INCLUDE_FIXER_BINARYSYMBOLINDEX_H
+#define LLVM_CLANG_TOOLS_EXTRA_INCLUDE_FIXER_BINARYSYMBOLINDEX_H
+
+#include "SymbolIndex.h"
+#include "find-all-symbols/BinarySymbolDatabase.h"
+#include "llvm/Support/ErrorOr.h"
+#include <memory>
+#include <vector>
+
+namespace clang {
+namespace include_fixer {
+
+/// Binary format database, which is mapped into memory and queried in place
+/// instead of being parsed when it is loaded.
+class BinarySymbolIndex : public SymbolIndex {
+public:
+  /// Open a binary db from a file.
+  static llvm::ErrorOr<std::unique_ptr<BinarySymbolIndex>>
+  createFromFile(llvm::StringRef FilePath);
+  /// Look for a file called \c Name in \c Directory and all parent directories.
+  static llvm::ErrorOr<std::unique_ptr<BinarySymbolIndex>>
+  createFromDirectory(llvm::StringRef Directory, llvm::StringRef Name);
+
+  std::vector<find_all_symbols::SymbolAndSignals>
+  search(llvm::StringRef Identifier) override;
+
+private:
+  explicit BinarySymbolIndex(
+      std::unique_ptr<find_all_symbols::BinarySymbolDatabase> Database)
+      : Database(std::move(Database)) {}
+
+  std::unique_ptr<find_all_symbols::BinarySymbolDatabase> Database;
+};
+
+} // namespace include_fixer
+} // namespace clang
+
+#endif // LLVM_CLANG_TOOLS_EXTRA_INCLUDE_FIXER_BINARYSYMBOLINDEX_H
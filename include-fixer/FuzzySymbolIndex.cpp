@@ -7,7 +7,10 @@
 //
 //===----------------------------------------------------------------------===//
 #include "FuzzySymbolIndex.h"
-#include "llvm/Support/Regex.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/StringExtras.h"
+#include "llvm/ADT/StringMap.h"
+#include <algorithm>
 
 using clang::find_all_symbols::SymbolAndSignals;
 using llvm::StringRef;
@@ -16,11 +19,44 @@ namespace clang {
 namespace include_fixer {
 namespace {
 
+// The longest prefix of a query looked up in the index of MemSymbolIndex.
+const size_t MaxKeyLength = 3;
+
+// Collects the strings the first MaxKeyLength characters of a query matching
+// a symbol with the tokens \p Tokens can start with. A query matches the
+// prefixes of consecutive tokens starting at the first one, so these are the
+// concatenations of such prefixes: [url handler] --> u, ur, url, uh, urh, uha.
+void collectKeys(llvm::ArrayRef<StringRef> Tokens, std::string &Prefix,
+                 std::vector<std::string> &Keys) {
+  if (Tokens.empty())
+    return;
+  StringRef Token = Tokens.front();
+  size_t Size = Prefix.size();
+  for (size_t Len = 1; Len <= Token.size() && Size + Len <= MaxKeyLength;
+       ++Len) {
+    Prefix.resize(Size);
+    Prefix.append(Token.begin(), Token.begin() + Len);
+    Keys.push_back(Prefix);
+    collectKeys(Tokens.drop_front(), Prefix, Keys);
+  }
+  Prefix.resize(Size);
+}
+
 class MemSymbolIndex : public FuzzySymbolIndex {
 public:
   MemSymbolIndex(std::vector<SymbolAndSignals> Symbols) {
+    std::vector<std::string> Keys;
+    std::string Prefix;
     for (auto &Symbol : Symbols) {
       auto Tokens = tokenize(Symbol.Symbol.getName());
+      Keys.clear();
+      std::vector<StringRef> TokenRefs(Tokens.begin(), Tokens.end());
+      collectKeys(TokenRefs, Prefix, Keys);
+      std::sort(Keys.begin(), Keys.end());
+      Keys.erase(std::unique(Keys.begin(), Keys.end()), Keys.end());
+      for (const auto &Key : Keys)
+        Index[Key].push_back(this->Symbols.size());
+
       this->Symbols.emplace_back(
           StringRef(llvm::join(Tokens.begin(), Tokens.end(), " ")),
           std::move(Symbol));
@@ -29,17 +65,43 @@ public:
 
   std::vector<SymbolAndSignals> search(StringRef Query) override {
     auto Tokens = tokenize(Query);
-    llvm::Regex Pattern("^" + queryRegexp(Tokens));
+    std::string Key;
+    for (const auto &Token : Tokens) {
+      if (Key.size() >= MaxKeyLength)
+        break;
+      Key += Token;
+    }
+    Key.resize(std::min(Key.size(), MaxKeyLength));
+
     std::vector<SymbolAndSignals> Results;
-    for (const Entry &E : Symbols)
-      if (Pattern.match(E.first))
+    if (Key.empty()) {
+      for (const Entry &E : Symbols)
+        Results.push_back(E.second);
+      return Results;
+    }
+    // Only the symbols whose names can start with the first characters of the
+    // query are candidates.
+    auto Candidates = Index.find(Key);
+    if (Candidates == Index.end())
+      return Results;
+    llvm::SmallVector<StringRef, 8> SymbolTokens;
+    for (unsigned I : Candidates->second) {
+      const Entry &E = Symbols[I];
+      SymbolTokens.clear();
+      StringRef(E.first).split(SymbolTokens, ' ', /*MaxSplit=*/-1,
+                               /*KeepEmpty=*/false);
+      if (matchTokens(Tokens, SymbolTokens))
         Results.push_back(E.second);
+    }
     return Results;
   }
 
 private:
   using Entry = std::pair<llvm::SmallString<32>, SymbolAndSignals>;
   std::vector<Entry> Symbols;
+  // Indices into Symbols of the symbols whose names can start with each key,
+  // see collectKeys.
+  llvm::StringMap<std::vector<unsigned>> Index;
 };
 
 // Helpers for tokenize state machine.
@@ -130,6 +192,43 @@ FuzzySymbolIndex::queryRegexp(const std::vector<std::string> &Tokens) {
   return Result;
 }
 
+bool FuzzySymbolIndex::matchTokens(const std::vector<std::string> &Query,
+                                   llvm::ArrayRef<StringRef> Symbol) {
+  // Reachable[J * (Symbol.size() + 1) + T] is true if the first J characters
+  // of the query match prefixes of the first T symbol tokens.
+  std::string Chars;
+  std::vector<bool> QueryTokenStart;
+  for (const auto &Token : Query) {
+    for (size_t I = 0; I < Token.size(); ++I)
+      QueryTokenStart.push_back(I == 0);
+    Chars += Token;
+  }
+  QueryTokenStart.push_back(true);
+
+  size_t Width = Symbol.size() + 1;
+  std::vector<bool> Reachable((Chars.size() + 1) * Width);
+  Reachable[0] = true;
+  for (size_t J = 0; J < Chars.size(); ++J) {
+    for (size_t T = 0; T < Symbol.size(); ++T) {
+      if (!Reachable[J * Width + T])
+        continue;
+      // Match a prefix of symbol token T, which must not extend into the
+      // next query token.
+      for (size_t K = 0; K < Symbol[T].size() && J + K < Chars.size() &&
+                         Chars[J + K] == Symbol[T][K];
+           ++K) {
+        Reachable[(J + K + 1) * Width + T + 1] = true;
+        if (QueryTokenStart[J + K + 1])
+          break;
+      }
+    }
+  }
+  for (size_t T = 0; T < Width; ++T)
+    if (Reachable[Chars.size() * Width + T])
+      return true;
+  return false;
+}
+
 llvm::Expected<std::unique_ptr<FuzzySymbolIndex>>
 FuzzySymbolIndex::createFromYAML(StringRef FilePath) {
   auto Buffer = llvm::MemoryBuffer::getFile(FilePath);
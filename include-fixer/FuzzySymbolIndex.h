@@ -12,6 +12,7 @@
 
 #include "SymbolIndex.h"
 #include "find-all-symbols/SymbolInfo.h"
+#include "llvm/ADT/ArrayRef.h"
 #include "llvm/ADT/SmallString.h"
 #include "llvm/ADT/StringRef.h"
 #include "llvm/Support/Error.h"
@@ -47,6 +48,12 @@ public:
   // Transforms query tokens into an unanchored regexp to match symbol tokens.
   // - [fe f] --> /f(\w* )?e\w* f/, matches [fee fie foe].
   static std::string queryRegexp(const std::vector<std::string> &Tokens);
+
+  // Returns whether query tokens match symbol tokens, like the regexp
+  // returned by queryRegexp() anchored at the start of the symbol tokens.
+  // - [fe f], [fee fie foe] --> true.
+  static bool matchTokens(const std::vector<std::string> &Query,
+                          llvm::ArrayRef<llvm::StringRef> Symbol);
 };
 
 } // namespace include_fixer
@@ -10,12 +10,14 @@
 #include "IncludeFixer.h"
 #include "clang/Format/Format.h"
 #include "clang/Frontend/CompilerInstance.h"
+#include "clang/Frontend/PrecompiledPreamble.h"
 #include "clang/Lex/HeaderSearch.h"
 #include "clang/Lex/Preprocessor.h"
 #include "clang/Parse/ParseAST.h"
 #include "clang/Sema/Sema.h"
 #include "llvm/Support/Debug.h"
 #include "llvm/Support/raw_ostream.h"
+#include <algorithm>
 
 #define DEBUG_TYPE "include-fixer"
 
@@ -72,12 +74,64 @@ private:
 
 } // namespace
 
+IncludeFixerPreambleCache::IncludeFixerPreambleCache(unsigned Capacity)
+    : Capacity(Capacity) {}
+
+IncludeFixerPreambleCache::~IncludeFixerPreambleCache() = default;
+
+std::shared_ptr<PrecompiledPreamble> IncludeFixerPreambleCache::getPreamble(
+    const CompilerInvocation &Invocation, const llvm::MemoryBuffer &MainFile,
+    IntrusiveRefCntPtr<vfs::FileSystem> VFS,
+    std::shared_ptr<PCHContainerOperations> PCHContainerOps) {
+  StringRef FileName = Invocation.getFrontendOpts().Inputs[0].getFile();
+  auto Cached = std::find_if(
+      Preambles.begin(), Preambles.end(),
+      [&](const std::pair<std::string, std::shared_ptr<PrecompiledPreamble>>
+              &Entry) { return Entry.first == FileName; });
+
+  PreambleBounds Bounds =
+      ComputePreambleBounds(*Invocation.getLangOpts(), &MainFile, 0);
+  if (Cached != Preambles.end()) {
+    if (Cached->second->CanReuse(Invocation, &MainFile, Bounds, VFS.get())) {
+      DEBUG(llvm::dbgs() << "Reusing the preamble of " << FileName << "\n");
+      Preambles.splice(Preambles.begin(), Preambles, Cached);
+      return Preambles.front().second;
+    }
+    Preambles.erase(Cached);
+  }
+  // There is nothing to save if the file doesn't start with any directives.
+  if (Bounds.Size == 0)
+    return nullptr;
+
+  // Like the diagnostics of the main file, the diagnostics of the preamble
+  // would be wrong because of the missing includes.
+  IntrusiveRefCntPtr<DiagnosticsEngine> Diagnostics =
+      CompilerInstance::createDiagnostics(
+          &Invocation.getDiagnosticOpts(), new clang::IgnoringDiagConsumer,
+          /*ShouldOwnClient=*/true);
+  DEBUG(llvm::dbgs() << "Building the preamble of " << FileName << "\n");
+  PreambleCallbacks Callbacks;
+  auto Preamble =
+      PrecompiledPreamble::Build(Invocation, &MainFile, Bounds, *Diagnostics,
+                                 std::move(VFS), PCHContainerOps, Callbacks);
+  if (!Preamble) {
+    DEBUG(llvm::dbgs() << "Couldn't build the preamble of " << FileName << ": "
+                       << Preamble.getError().message() << "\n");
+    return nullptr;
+  }
+  Preambles.emplace_front(
+      FileName, std::make_shared<PrecompiledPreamble>(std::move(*Preamble)));
+  if (Preambles.size() > Capacity)
+    Preambles.pop_back();
+  return Preambles.front().second;
+}
+
 IncludeFixerActionFactory::IncludeFixerActionFactory(
     SymbolIndexManager &SymbolIndexMgr,
     std::vector<IncludeFixerContext> &Contexts, StringRef StyleName,
-    bool MinimizeIncludePaths)
+    bool MinimizeIncludePaths, IncludeFixerPreambleCache *Preambles)
     : SymbolIndexMgr(SymbolIndexMgr), Contexts(Contexts),
-      MinimizeIncludePaths(MinimizeIncludePaths) {}
+      MinimizeIncludePaths(MinimizeIncludePaths), Preambles(Preambles) {}
 
 IncludeFixerActionFactory::~IncludeFixerActionFactory() = default;
 
@@ -88,6 +142,23 @@ bool IncludeFixerActionFactory::runInvocation(
     clang::DiagnosticConsumer *Diagnostics) {
   assert(Invocation->getFrontendOpts().Inputs.size() == 1);
 
+  // Parse the main file on top of its cached preamble. The preamble must stay
+  // alive while the main file is parsed.
+  std::shared_ptr<PrecompiledPreamble> Preamble;
+  if (Preambles) {
+    StringRef FileName = Invocation->getFrontendOpts().Inputs[0].getFile();
+    auto Buffer = Files->getBufferForFile(FileName);
+    if (Buffer) {
+      Preamble = Preambles->getPreamble(*Invocation, **Buffer,
+                                        Files->getVirtualFileSystem(),
+                                        PCHContainerOps);
+      if (Preamble) {
+        // The preprocessor takes the ownership of the remapped buffer.
+        Preamble->AddImplicitPreamble(*Invocation, Buffer->release());
+      }
+    }
+  }
+
   // Set up Clang.
   clang::CompilerInstance Compiler(PCHContainerOps);
   Compiler.setInvocation(std::move(Invocation));
@@ -303,6 +374,11 @@ std::string IncludeFixerSemaSource::minimizeInclude(
   if (!MinimizeIncludePaths)
     return Include;
 
+  auto Cached = MinimizedIncludes.find(Include);
+  if (Cached != MinimizedIncludes.end())
+    return Cached->second;
+  std::string &Minimized = MinimizedIncludes[Include];
+
   // Get the FileEntry for the include.
   StringRef StrippedInclude = Include.trim("\"<>");
   const FileEntry *Entry =
@@ -310,14 +386,17 @@ std::string IncludeFixerSemaSource::minimizeInclude(
 
   // If the file doesn't exist return the path from the database.
   // FIXME: This should never happen.
-  if (!Entry)
-    return Include;
+  if (!Entry) {
+    Minimized = Include;
+    return Minimized;
+  }
 
   bool IsSystem;
   std::string Suggestion =
       HeaderSearch.suggestPathToFileForDiagnostics(Entry, &IsSystem);
 
-  return IsSystem ? '<' + Suggestion + '>' : '"' + Suggestion + '"';
+  Minimized = IsSystem ? '<' + Suggestion + '>' : '"' + Suggestion + '"';
+  return Minimized;
 }
 
 /// Get the include fixer context for the queried symbol.
@@ -369,6 +448,17 @@ IncludeFixerSemaSource::query(StringRef Query, StringRef ScopedQualifiers,
 
   QuerySymbolInfos.push_back({Query.str(), ScopedQualifiers, Range});
 
+  // Sema reports the same unknown symbol once for each use, and often more
+  // than once for one use while recovering from errors. Only search for it
+  // once.
+  auto Cached = QueryResults.find({ScopedQualifiers.str(), Query.str()});
+  if (Cached != QueryResults.end()) {
+    DEBUG(llvm::dbgs() << "Reusing " << Cached->second.size()
+                       << " symbols\n");
+    this->MatchedSymbols = Cached->second;
+    return Cached->second;
+  }
+
   // Query the symbol based on C++ name Lookup rules.
   // Firstly, lookup the identifier with scoped namespace contexts;
   // If that fails, falls back to look up the identifier directly.
@@ -385,13 +475,20 @@ IncludeFixerSemaSource::query(StringRef Query, StringRef ScopedQualifiers,
   // It's unsafe to do nested search for the identifier with scoped namespace
   // context, it might treat the identifier as a nested class of the scoped
   // namespace.
+  // Both searches look up the same unqualified name in the indices, which
+  // SearchCache only does once.
+  //
+  // The diagnostics only suggest the best header, so don't rank the others.
+  size_t MaxResults = GenerateDiagnostics ? 1 : 0;
   std::vector<find_all_symbols::SymbolInfo> MatchedSymbols =
-      SymbolIndexMgr.search(QueryString, /*IsNestedSearch=*/false, FileName);
+      SymbolIndexMgr.search(QueryString, /*IsNestedSearch=*/false, FileName,
+                            &SearchCache, MaxResults);
   if (MatchedSymbols.empty())
-    MatchedSymbols =
-        SymbolIndexMgr.search(Query, /*IsNestedSearch=*/true, FileName);
+    MatchedSymbols = SymbolIndexMgr.search(Query, /*IsNestedSearch=*/true,
+                                           FileName, &SearchCache, MaxResults);
   DEBUG(llvm::dbgs() << "Having found " << MatchedSymbols.size()
                      << " symbols\n");
+  QueryResults[{ScopedQualifiers.str(), Query.str()}] = MatchedSymbols;
   // We store a copy of MatchedSymbols in a place where it's globally reachable.
   // This is used by the standalone version of the tool.
   this->MatchedSymbols = MatchedSymbols;
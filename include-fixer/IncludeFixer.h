@@ -12,11 +12,17 @@
 
 #include "IncludeFixerContext.h"
 #include "SymbolIndexManager.h"
+#include "clang/Basic/VirtualFileSystem.h"
 #include "clang/Format/Format.h"
 #include "clang/Sema/ExternalSemaSource.h"
 #include "clang/Tooling/Core/Replacement.h"
 #include "clang/Tooling/Tooling.h"
+#include "llvm/ADT/StringMap.h"
+#include <list>
+#include <map>
 #include <memory>
+#include <string>
+#include <utility>
 #include <vector>
 
 namespace clang {
@@ -25,19 +31,51 @@ class CompilerInvocation;
 class DiagnosticConsumer;
 class FileManager;
 class PCHContainerOperations;
+class PrecompiledPreamble;
 
 namespace include_fixer {
 
+/// Keeps the preambles of the most recently processed files, so that the
+/// headers included at the top of a file are only parsed again when they or
+/// the preamble of the file change.
+class IncludeFixerPreambleCache {
+public:
+  /// \param Capacity The number of files whose preambles are kept.
+  explicit IncludeFixerPreambleCache(unsigned Capacity = 8);
+
+  ~IncludeFixerPreambleCache();
+
+  /// Returns the preamble of \p MainFile, the main file of \p Invocation.
+  /// The cached preamble of the file is reused if it is still valid, otherwise
+  /// a new one is built. Returns null if the file has no preamble or it can't
+  /// be built.
+  std::shared_ptr<PrecompiledPreamble>
+  getPreamble(const CompilerInvocation &Invocation,
+              const llvm::MemoryBuffer &MainFile,
+              IntrusiveRefCntPtr<vfs::FileSystem> VFS,
+              std::shared_ptr<PCHContainerOperations> PCHContainerOps);
+
+private:
+  unsigned Capacity;
+
+  /// The cached preambles by file name, the most recently used first.
+  std::list<std::pair<std::string, std::shared_ptr<PrecompiledPreamble>>>
+      Preambles;
+};
+
 class IncludeFixerActionFactory : public clang::tooling::ToolAction {
 public:
   /// \param SymbolIndexMgr A source for matching symbols to header files.
   /// \param Contexts The contexts for the symbols being queried.
   /// \param StyleName Fallback style for reformatting.
   /// \param MinimizeIncludePaths whether inserted include paths are optimized.
+  /// \param Preambles If given, the preambles of the files are taken from and
+  /// stored in this cache.
   IncludeFixerActionFactory(SymbolIndexManager &SymbolIndexMgr,
                             std::vector<IncludeFixerContext> &Contexts,
                             StringRef StyleName,
-                            bool MinimizeIncludePaths = true);
+                            bool MinimizeIncludePaths = true,
+                            IncludeFixerPreambleCache *Preambles = nullptr);
 
   ~IncludeFixerActionFactory() override;
 
@@ -57,6 +95,9 @@ private:
   /// Whether inserted include paths should be optimized.
   bool MinimizeIncludePaths;
 
+  /// The cache of preambles to use, if any.
+  IncludeFixerPreambleCache *Preambles;
+
   /// The fallback format style for formatting after insertion if no
   /// clang-format config file was found.
   std::string FallbackStyle;
@@ -143,6 +184,18 @@ private:
   /// recovery.
   std::vector<find_all_symbols::SymbolInfo> MatchedSymbols;
 
+  /// The symbols found for earlier queries, by scoped qualifiers and
+  /// identifier. The same symbol is often reported many times.
+  std::map<std::pair<std::string, std::string>,
+           std::vector<find_all_symbols::SymbolInfo>>
+      QueryResults;
+
+  /// The results of the index searches for this file, shared by all queries.
+  SymbolIndexManager::SearchCache SearchCache;
+
+  /// The minimized include of each header seen so far.
+  mutable llvm::StringMap<std::string> MinimizedIncludes;
+
   /// The file path to the file being processed.
   std::string FilePath;
 
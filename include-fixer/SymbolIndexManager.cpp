@@ -13,6 +13,7 @@
 #include "llvm/ADT/SmallVector.h"
 #include "llvm/Support/Debug.h"
 #include "llvm/Support/Path.h"
+#include <algorithm>
 
 #define DEBUG_TYPE "include-fixer"
 
@@ -23,56 +24,144 @@ using find_all_symbols::SymbolInfo;
 using find_all_symbols::SymbolAndSignals;
 
 // Calculate a score based on whether we think the given header is closely
-// related to the given source file.
-static double similarityScore(llvm::StringRef FileName,
-                              llvm::StringRef Header) {
+// related to the given source file, from the IDs of their path components.
+static double similarityScore(llvm::ArrayRef<unsigned> FileName,
+                              llvm::ArrayRef<unsigned> Header) {
   // Compute the maximum number of common path segements between Header and
   // a suffix of FileName.
   // We do not do a full longest common substring computation, as Header
   // specifies the path we would directly #include, so we assume it is rooted
   // relatively to a subproject of the repository.
-  int MaxSegments = 1;
-  for (auto FileI = llvm::sys::path::begin(FileName),
-            FileE = llvm::sys::path::end(FileName);
-       FileI != FileE; ++FileI) {
-    int Segments = 0;
-    for (auto HeaderI = llvm::sys::path::begin(Header),
-              HeaderE = llvm::sys::path::end(Header), I = FileI;
-         HeaderI != HeaderE && *I == *HeaderI && I != FileE; ++I, ++HeaderI) {
-      ++Segments;
-    }
-    MaxSegments = std::max(Segments, MaxSegments);
+  size_t MaxSegments = 1;
+  for (size_t I = 0, E = FileName.size(); I != E; ++I) {
+    size_t Length = std::min(E - I, Header.size());
+    // Later suffixes are shorter, so they can't have more segments in common.
+    if (Length <= MaxSegments)
+      break;
+    auto Mismatch = std::mismatch(Header.begin(), Header.begin() + Length,
+                                  FileName.begin() + I);
+    MaxSegments =
+        std::max<size_t>(MaxSegments, Mismatch.first - Header.begin());
   }
   return MaxSegments;
 }
 
-static void rank(std::vector<SymbolAndSignals> &Symbols,
-                 llvm::StringRef FileName) {
+llvm::ArrayRef<unsigned>
+SymbolIndexManager::getHeaderComponents(llvm::StringRef Header) const {
+  std::lock_guard<std::mutex> Lock(ComponentsMutex);
+  auto Inserted = HeaderComponents.insert(
+      std::make_pair(Header, std::vector<unsigned>()));
+  if (Inserted.second) {
+    for (auto I = llvm::sys::path::begin(Header),
+              E = llvm::sys::path::end(Header);
+         I != E; ++I)
+      Inserted.first->second.push_back(
+          ComponentIDs.insert(std::make_pair(*I, ComponentIDs.size()))
+              .first->second);
+  }
+  return Inserted.first->second;
+}
+
+std::vector<unsigned>
+SymbolIndexManager::getFileComponents(llvm::StringRef FileName) const {
+  std::lock_guard<std::mutex> Lock(ComponentsMutex);
+  std::vector<unsigned> Components;
+  for (auto I = llvm::sys::path::begin(FileName),
+            E = llvm::sys::path::end(FileName);
+       I != E; ++I) {
+    auto ID = ComponentIDs.find(*I);
+    Components.push_back(ID == ComponentIDs.end() ? ~0u : ID->second);
+  }
+  return Components;
+}
+
+void SymbolIndexManager::rank(std::vector<SymbolAndSignals> &Symbols,
+                              llvm::StringRef FileName,
+                              llvm::StringMap<double> &HeaderScores,
+                              size_t MaxResults) const {
+  // The components of the headers must be interned before looking up the
+  // components of the file.
+  for (const auto &Symbol : Symbols)
+    if (!HeaderScores.count(Symbol.Symbol.getFilePath()))
+      getHeaderComponents(Symbol.Symbol.getFilePath());
+  std::vector<unsigned> FileComponents = getFileComponents(FileName);
+
+  // The score of a header is the best score of its symbols.
   llvm::DenseMap<llvm::StringRef, double> Score;
   for (const auto &Symbol : Symbols) {
     // Calculate a score from the similarity of the header the symbol is in
     // with the current file and the popularity of the symbol.
-    double NewScore = similarityScore(FileName, Symbol.Symbol.getFilePath()) *
-                      (1.0 + std::log2(1 + Symbol.Signals.Seen));
-    double &S = Score[Symbol.Symbol.getFilePath()];
+    llvm::StringRef Header = Symbol.Symbol.getFilePath();
+    auto Similarity = HeaderScores.insert(std::make_pair(Header, 0.0));
+    if (Similarity.second)
+      Similarity.first->second =
+          similarityScore(FileComponents, getHeaderComponents(Header));
+    double NewScore =
+        Similarity.first->second * (1.0 + std::log2(1 + Symbol.Signals.Seen));
+    double &S = Score[Header];
     S = std::max(S, NewScore);
   }
-  // Sort by the gathered scores. Use file name as a tie breaker so we can
-  // deduplicate.
-  std::sort(Symbols.begin(), Symbols.end(),
-            [&](const SymbolAndSignals &A, const SymbolAndSignals &B) {
-              auto AS = Score[A.Symbol.getFilePath()];
-              auto BS = Score[B.Symbol.getFilePath()];
-              if (AS != BS)
-                return AS > BS;
-              return A.Symbol.getFilePath() < B.Symbol.getFilePath();
-            });
+
+  // Sort by the gathered scores, looked up once per symbol. Use file name as a
+  // tie breaker so we can deduplicate.
+  struct RankedSymbol {
+    double Score;
+    llvm::StringRef Header;
+    unsigned Index;
+  };
+  std::vector<RankedSymbol> Ranked;
+  Ranked.reserve(Symbols.size());
+  for (unsigned I = 0, E = Symbols.size(); I != E; ++I) {
+    llvm::StringRef Header = Symbols[I].Symbol.getFilePath();
+    Ranked.push_back({Score[Header], Header, I});
+  }
+  auto Better = [](const RankedSymbol &A, const RankedSymbol &B) {
+    if (A.Score != B.Score)
+      return A.Score > B.Score;
+    if (A.Header != B.Header)
+      return A.Header < B.Header;
+    return A.Index < B.Index;
+  };
+  if (MaxResults != 0 && MaxResults < Ranked.size()) {
+    std::partial_sort(Ranked.begin(), Ranked.begin() + MaxResults,
+                      Ranked.end(), Better);
+    Ranked.resize(MaxResults);
+  } else {
+    std::sort(Ranked.begin(), Ranked.end(), Better);
+  }
+
+  std::vector<SymbolAndSignals> Sorted;
+  Sorted.reserve(Ranked.size());
+  for (const RankedSymbol &Symbol : Ranked)
+    Sorted.push_back(std::move(Symbols[Symbol.Index]));
+  Symbols = std::move(Sorted);
+}
+
+std::vector<SymbolAndSignals>
+SymbolIndexManager::searchIndices(llvm::StringRef Name,
+                                  SearchCache *Cache) const {
+  if (Cache) {
+    auto I = Cache->Symbols.find(Name);
+    if (I != Cache->Symbols.end()) {
+      DEBUG(llvm::dbgs() << "Reusing the results for " << Name << "...\n");
+      return I->second;
+    }
+  }
+  std::vector<SymbolAndSignals> Symbols;
+  for (const auto &DB : SymbolIndices) {
+    auto Res = DB.get()->search(Name);
+    Symbols.insert(Symbols.end(), Res.begin(), Res.end());
+  }
+  if (Cache)
+    Cache->Symbols[Name] = Symbols;
+  return Symbols;
 }
 
 std::vector<find_all_symbols::SymbolInfo>
 SymbolIndexManager::search(llvm::StringRef Identifier,
                            bool IsNestedSearch,
-                           llvm::StringRef FileName) const {
+                           llvm::StringRef FileName, SearchCache *Cache,
+                           size_t MaxResults) const {
   // The identifier may be fully qualified, so split it and get all the context
   // names.
   llvm::SmallVector<llvm::StringRef, 8> Names;
@@ -91,11 +180,7 @@ SymbolIndexManager::search(llvm::StringRef Identifier,
   bool TookPrefix = false;
   std::vector<SymbolAndSignals> MatchedSymbols;
   do {
-    std::vector<SymbolAndSignals> Symbols;
-    for (const auto &DB : SymbolIndices) {
-      auto Res = DB.get()->search(Names.back());
-      Symbols.insert(Symbols.end(), Res.begin(), Res.end());
-    }
+    std::vector<SymbolAndSignals> Symbols = searchIndices(Names.back(), Cache);
 
     DEBUG(llvm::dbgs() << "Searching " << Names.back() << "... got "
                        << Symbols.size() << " results...\n");
@@ -147,7 +232,9 @@ SymbolIndexManager::search(llvm::StringRef Identifier,
     TookPrefix = true;
   } while (MatchedSymbols.empty() && !Names.empty() && IsNestedSearch);
 
-  rank(MatchedSymbols, FileName);
+  llvm::StringMap<double> HeaderScores;
+  rank(MatchedSymbols, FileName, Cache ? Cache->HeaderScores : HeaderScores,
+       MaxResults);
   // Strip signals, they are no longer needed.
   std::vector<SymbolInfo> Res;
   for (auto &SymAndSig : MatchedSymbols)
@@ -12,7 +12,10 @@
 
 #include "SymbolIndex.h"
 #include "find-all-symbols/SymbolInfo.h"
+#include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/StringMap.h"
 #include "llvm/ADT/StringRef.h"
+#include <mutex>
 
 #ifdef _MSC_VER
 // Disable warnings from ppltasks.h transitively included by <future>.
@@ -33,6 +36,20 @@ namespace include_fixer {
 /// to an identifier in the source code from multiple symbol databases.
 class SymbolIndexManager {
 public:
+  /// Remembers the results of the searches for one file. Names which were
+  /// searched before aren't searched in the indices again, and the similarity
+  /// of each header to the file is only computed once.
+  class SearchCache {
+  private:
+    friend class SymbolIndexManager;
+
+    /// The symbols found in all indices by unqualified name.
+    llvm::StringMap<std::vector<find_all_symbols::SymbolAndSignals>> Symbols;
+
+    /// The similarity of each header to the file.
+    llvm::StringMap<double> HeaderScores;
+  };
+
   void addSymbolIndex(std::function<std::unique_ptr<SymbolIndex>()> F) {
 #if LLVM_ENABLE_THREADS
     auto Strategy = std::launch::async;
@@ -50,14 +67,47 @@ public:
   ///        finds the corresponding candidates in database (e.g for identifier
   ///        "b::foo", the method will try to find "b" if it fails to find
   ///        "b::foo").
+  /// \param FileName The file the identifier is used in.
+  /// \param Cache If given, the results of earlier searches for \p FileName
+  ///        are taken from and stored in this cache.
+  /// \param MaxResults If not 0, only this many of the best candidates are
+  ///        returned.
   ///
-  /// \returns A list of symbol candidates.
+  /// \returns A list of symbol candidates, the best one first.
   std::vector<find_all_symbols::SymbolInfo>
   search(llvm::StringRef Identifier, bool IsNestedSearch = true,
-         llvm::StringRef FileName = "") const;
+         llvm::StringRef FileName = "", SearchCache *Cache = nullptr,
+         size_t MaxResults = 0) const;
 
 private:
+  /// Searches all indices for the unqualified name \p Name.
+  std::vector<find_all_symbols::SymbolAndSignals>
+  searchIndices(llvm::StringRef Name, SearchCache *Cache) const;
+
+  /// Sorts \p Symbols by the similarity of their headers to \p FileName and
+  /// their popularity, and drops all but the best \p MaxResults if it isn't 0.
+  void rank(std::vector<find_all_symbols::SymbolAndSignals> &Symbols,
+            llvm::StringRef FileName, llvm::StringMap<double> &HeaderScores,
+            size_t MaxResults) const;
+
+  /// Returns the IDs of the path components of \p Header. The components of
+  /// each header are only split and interned the first time it is found.
+  llvm::ArrayRef<unsigned> getHeaderComponents(llvm::StringRef Header) const;
+
+  /// Returns the IDs of the path components of \p FileName. Components no
+  /// header has get an ID which matches nothing.
+  std::vector<unsigned> getFileComponents(llvm::StringRef FileName) const;
+
   std::vector<std::shared_future<std::unique_ptr<SymbolIndex>>> SymbolIndices;
+
+  /// Guards ComponentIDs and HeaderComponents.
+  mutable std::mutex ComponentsMutex;
+
+  /// The interned path components of all headers found so far.
+  mutable llvm::StringMap<unsigned> ComponentIDs;
+
+  /// The IDs of the path components of all headers found so far.
+  mutable llvm::StringMap<std::vector<unsigned>> HeaderComponents;
 };
 
 } // namespace include_fixer
@@ -22,6 +22,12 @@ using clang::find_all_symbols::SymbolAndSignals;
 namespace clang {
 namespace include_fixer {
 
+YamlSymbolIndex::YamlSymbolIndex(std::vector<SymbolAndSignals> Symbols)
+    : Symbols(std::move(Symbols)) {
+  for (unsigned I = 0, E = this->Symbols.size(); I != E; ++I)
+    SymbolsByName[this->Symbols[I].Symbol.getName()].push_back(I);
+}
+
 llvm::ErrorOr<std::unique_ptr<YamlSymbolIndex>>
 YamlSymbolIndex::createFromFile(llvm::StringRef FilePath) {
   auto Buffer = llvm::MemoryBuffer::getFile(FilePath);
@@ -50,10 +56,12 @@ YamlSymbolIndex::createFromDirectory(llvm::StringRef Directory,
 std::vector<SymbolAndSignals>
 YamlSymbolIndex::search(llvm::StringRef Identifier) {
   std::vector<SymbolAndSignals> Results;
-  for (const auto &Symbol : Symbols) {
-    if (Symbol.Symbol.getName() == Identifier)
-      Results.push_back(Symbol);
-  }
+  auto I = SymbolsByName.find(Identifier);
+  if (I == SymbolsByName.end())
+    return Results;
+  Results.reserve(I->second.size());
+  for (unsigned Index : I->second)
+    Results.push_back(Symbols[Index]);
   return Results;
 }
 
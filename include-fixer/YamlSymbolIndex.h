@@ -12,6 +12,7 @@
 
 #include "SymbolIndex.h"
 #include "find-all-symbols/SymbolInfo.h"
+#include "llvm/ADT/StringMap.h"
 #include "llvm/Support/ErrorOr.h"
 #include <map>
 #include <vector>
@@ -34,10 +35,12 @@ public:
 
 private:
   explicit YamlSymbolIndex(
-      std::vector<find_all_symbols::SymbolAndSignals> Symbols)
-      : Symbols(std::move(Symbols)) {}
+      std::vector<find_all_symbols::SymbolAndSignals> Symbols);
 
   std::vector<find_all_symbols::SymbolAndSignals> Symbols;
+  /// Indices into \c Symbols of the symbols with each name, in the order of
+  /// the database. Built once when the database is loaded.
+  llvm::StringMap<std::vector<unsigned>> SymbolsByName;
 };
 
 } // namespace include_fixer
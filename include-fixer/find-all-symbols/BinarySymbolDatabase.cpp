@@ -0,0 +1,337 @@
+//===-- BinarySymbolDatabase.cpp - binary symbol database -------*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#include "BinarySymbolDatabase.h"
+#include "llvm/ADT/StringMap.h"
+#include "llvm/Support/Endian.h"
+#include "llvm/Support/MathExtras.h"
+#include <cstring>
+#include <system_error>
+
+namespace clang {
+namespace find_all_symbols {
+
+namespace binary {
+
+using llvm::support::ulittle32_t;
+
+// All records consist of little-endian 32 bit integers only, so that they
+// have no padding and can be read from any offset of the mapped file.
+
+static const char Magic[8] = {'F', 'A', 'S', 'Y', 'M', 'D', 'B', '\0'};
+static const unsigned Version = 1;
+
+struct FileHeader {
+  char Magic[8];
+  ulittle32_t Version;
+  ulittle32_t NumSymbols;
+  ulittle32_t SymbolsOffset;
+  ulittle32_t NumContexts;
+  ulittle32_t ContextsOffset;
+  ulittle32_t NumBuckets;
+  ulittle32_t BucketsOffset;
+  ulittle32_t StringsSize;
+  ulittle32_t StringsOffset;
+};
+
+/// \brief A string in the string table.
+struct StringRecord {
+  ulittle32_t Offset;
+  ulittle32_t Size;
+};
+
+/// \brief A symbol. Its contexts are the range [FirstContext, FirstContext +
+/// NumContexts) of the context records.
+struct SymbolRecord {
+  StringRecord Name;
+  StringRecord FilePath;
+  ulittle32_t Kind;
+  ulittle32_t FirstContext;
+  ulittle32_t NumContexts;
+  ulittle32_t Seen;
+  ulittle32_t Used;
+};
+
+struct ContextRecord {
+  ulittle32_t Type;
+  StringRecord Name;
+};
+
+/// \brief A bucket of the name hash table. The symbols with the name are the
+/// range [FirstSymbol, FirstSymbol + NumSymbols) of the symbol records, which
+/// are sorted by name. Empty buckets have no symbols.
+struct BucketRecord {
+  StringRecord Name;
+  ulittle32_t FirstSymbol;
+  ulittle32_t NumSymbols;
+};
+
+} // namespace binary
+
+using namespace binary;
+
+/// \brief The hash of symbol names in the hash table. It is part of the file
+/// format and must not depend on the host or the version of LLVM.
+static uint32_t hashName(llvm::StringRef Name) {
+  uint32_t Hash = 5381;
+  for (unsigned char C : Name)
+    Hash = Hash * 33 + C;
+  return Hash;
+}
+
+namespace {
+
+class BinaryWriter {
+public:
+  StringRecord addString(llvm::StringRef S) {
+    auto Inserted =
+        Offsets.insert({S, static_cast<uint32_t>(Strings.size())});
+    if (Inserted.second)
+      Strings.append(S.begin(), S.end());
+    StringRecord Record;
+    Record.Offset = Inserted.first->second;
+    Record.Size = S.size();
+    return Record;
+  }
+
+  bool write(llvm::raw_ostream &OS, const SymbolInfo::SignalMap &Symbols);
+
+private:
+  llvm::StringMap<uint32_t> Offsets;
+  std::string Strings;
+};
+
+} // namespace
+
+template <typename T>
+static void writeRecords(llvm::raw_ostream &OS, const std::vector<T> &Records) {
+  OS.write(reinterpret_cast<const char *>(Records.data()),
+           Records.size() * sizeof(T));
+}
+
+bool BinaryWriter::write(llvm::raw_ostream &OS,
+                         const SymbolInfo::SignalMap &Symbols) {
+  // The signal map is ordered by name first, so the symbols with the same
+  // name are adjacent.
+  std::vector<SymbolRecord> SymbolRecords;
+  std::vector<ContextRecord> ContextRecords;
+  std::vector<BucketRecord> Names;
+  SymbolRecords.reserve(Symbols.size());
+  for (const auto &Entry : Symbols) {
+    const SymbolInfo &Symbol = Entry.first;
+    SymbolRecord Record;
+    Record.Name = addString(Symbol.getName());
+    Record.FilePath = addString(Symbol.getFilePath());
+    Record.Kind = static_cast<uint32_t>(Symbol.getSymbolKind());
+    Record.FirstContext = ContextRecords.size();
+    Record.NumContexts = Symbol.getContexts().size();
+    Record.Seen = Entry.second.Seen;
+    Record.Used = Entry.second.Used;
+    for (const auto &Context : Symbol.getContexts()) {
+      ContextRecord CR;
+      CR.Type = static_cast<uint32_t>(Context.first);
+      CR.Name = addString(Context.second);
+      ContextRecords.push_back(CR);
+    }
+
+    if (Names.empty() || SymbolRecords[Names.back().FirstSymbol].Name.Offset !=
+                             Record.Name.Offset) {
+      BucketRecord Name;
+      Name.Name = Record.Name;
+      Name.FirstSymbol = SymbolRecords.size();
+      Name.NumSymbols = 0;
+      Names.push_back(Name);
+    }
+    Names.back().NumSymbols = Names.back().NumSymbols + 1;
+    SymbolRecords.push_back(Record);
+  }
+
+  // Keep the load factor of the hash table at most 1/2 to keep probe
+  // sequences short.
+  std::vector<BucketRecord> Buckets(llvm::NextPowerOf2(Names.size() * 2),
+                                    BucketRecord());
+  for (const BucketRecord &Name : Names) {
+    llvm::StringRef NameString(Strings.data() + Name.Name.Offset,
+                               Name.Name.Size);
+    size_t Index = hashName(NameString) & (Buckets.size() - 1);
+    while (Buckets[Index].NumSymbols != 0)
+      Index = (Index + 1) & (Buckets.size() - 1);
+    Buckets[Index] = Name;
+  }
+
+  uint64_t SymbolsOffset = sizeof(FileHeader);
+  uint64_t ContextsOffset =
+      SymbolsOffset + SymbolRecords.size() * sizeof(SymbolRecord);
+  uint64_t BucketsOffset =
+      ContextsOffset + ContextRecords.size() * sizeof(ContextRecord);
+  uint64_t StringsOffset = BucketsOffset + Buckets.size() * sizeof(BucketRecord);
+  if (StringsOffset + Strings.size() > UINT32_MAX)
+    return false;
+
+  FileHeader Header;
+  std::memcpy(Header.Magic, Magic, sizeof(Magic));
+  Header.Version = Version;
+  Header.NumSymbols = SymbolRecords.size();
+  Header.SymbolsOffset = SymbolsOffset;
+  Header.NumContexts = ContextRecords.size();
+  Header.ContextsOffset = ContextsOffset;
+  Header.NumBuckets = Buckets.size();
+  Header.BucketsOffset = BucketsOffset;
+  Header.StringsSize = Strings.size();
+  Header.StringsOffset = StringsOffset;
+
+  OS.write(reinterpret_cast<const char *>(&Header), sizeof(Header));
+  writeRecords(OS, SymbolRecords);
+  writeRecords(OS, ContextRecords);
+  writeRecords(OS, Buckets);
+  OS << Strings;
+  return true;
+}
+
+bool WriteSymbolInfosToBinary(llvm::raw_ostream &OS,
+                              const SymbolInfo::SignalMap &Symbols) {
+  return BinaryWriter().write(OS, Symbols);
+}
+
+BinarySymbolDatabase::BinarySymbolDatabase(
+    std::unique_ptr<llvm::MemoryBuffer> Buffer)
+    : Buffer(std::move(Buffer)) {}
+
+BinarySymbolDatabase::~BinarySymbolDatabase() = default;
+
+llvm::ErrorOr<std::unique_ptr<BinarySymbolDatabase>>
+BinarySymbolDatabase::createFromFile(llvm::StringRef FilePath) {
+  // Large files are mapped into memory instead of being read.
+  auto Buffer = llvm::MemoryBuffer::getFile(FilePath, /*FileSize=*/-1,
+                                            /*RequiresNullTerminator=*/false);
+  if (!Buffer)
+    return Buffer.getError();
+  return createFromBuffer(std::move(*Buffer));
+}
+
+/// \brief Returns the \p Count records of type \p T at \p Offset of \p Data
+/// in \p Result, or false if they are out of \p Data.
+template <typename T>
+static bool getRecords(llvm::StringRef Data, uint64_t Offset, uint64_t Count,
+                       llvm::ArrayRef<T> &Result) {
+  if (Offset > Data.size() || Count > (Data.size() - Offset) / sizeof(T))
+    return false;
+  Result = llvm::makeArrayRef(
+      reinterpret_cast<const T *>(Data.data() + Offset), Count);
+  return true;
+}
+
+llvm::ErrorOr<std::unique_ptr<BinarySymbolDatabase>>
+BinarySymbolDatabase::createFromBuffer(
+    std::unique_ptr<llvm::MemoryBuffer> Buffer) {
+  llvm::StringRef Data = Buffer->getBuffer();
+  auto Invalid = std::make_error_code(std::errc::invalid_argument);
+  if (Data.size() < sizeof(FileHeader))
+    return Invalid;
+  const auto *Header = reinterpret_cast<const FileHeader *>(Data.data());
+  if (std::memcmp(Header->Magic, Magic, sizeof(Magic)) != 0 ||
+      Header->Version != Version)
+    return Invalid;
+
+  std::unique_ptr<BinarySymbolDatabase> Database(
+      new BinarySymbolDatabase(std::move(Buffer)));
+  if (!getRecords(Data, Header->SymbolsOffset, Header->NumSymbols,
+                  Database->Symbols) ||
+      !getRecords(Data, Header->ContextsOffset, Header->NumContexts,
+                  Database->Contexts) ||
+      !getRecords(Data, Header->BucketsOffset, Header->NumBuckets,
+                  Database->Buckets) ||
+      !llvm::isPowerOf2_32(Header->NumBuckets) ||
+      Header->StringsOffset > Data.size() ||
+      Header->StringsSize > Data.size() - Header->StringsOffset)
+    return Invalid;
+  Database->Strings = Data.substr(Header->StringsOffset, Header->StringsSize);
+  return std::move(Database);
+}
+
+bool BinarySymbolDatabase::getString(const StringRecord &Record,
+                                     llvm::StringRef &Result) const {
+  if (Record.Offset > Strings.size() ||
+      Record.Size > Strings.size() - Record.Offset)
+    return false;
+  Result = Strings.substr(Record.Offset, Record.Size);
+  return true;
+}
+
+bool BinarySymbolDatabase::getSymbol(const SymbolRecord &Record,
+                                     SymbolAndSignals &Result) const {
+  llvm::StringRef Name, FilePath;
+  if (!getString(Record.Name, Name) || !getString(Record.FilePath, FilePath) ||
+      Record.Kind > static_cast<uint32_t>(SymbolInfo::SymbolKind::Unknown) ||
+      Record.FirstContext > Contexts.size() ||
+      Record.NumContexts > Contexts.size() - Record.FirstContext)
+    return false;
+
+  std::vector<SymbolInfo::Context> SymbolContexts;
+  SymbolContexts.reserve(Record.NumContexts);
+  for (const ContextRecord &Context :
+       Contexts.slice(Record.FirstContext, Record.NumContexts)) {
+    llvm::StringRef ContextName;
+    if (!getString(Context.Name, ContextName) ||
+        Context.Type > static_cast<uint32_t>(SymbolInfo::ContextType::EnumDecl))
+      return false;
+    SymbolContexts.emplace_back(
+        static_cast<SymbolInfo::ContextType>(uint32_t(Context.Type)),
+        ContextName.str());
+  }
+  Result.Symbol = SymbolInfo(
+      Name, static_cast<SymbolInfo::SymbolKind>(uint32_t(Record.Kind)),
+      FilePath, SymbolContexts);
+  Result.Signals = SymbolInfo::Signals(Record.Seen, Record.Used);
+  return true;
+}
+
+std::vector<SymbolAndSignals>
+BinarySymbolDatabase::lookup(llvm::StringRef Name) const {
+  std::vector<SymbolAndSignals> Results;
+  if (Buckets.empty())
+    return Results;
+  size_t Mask = Buckets.size() - 1;
+  size_t Index = hashName(Name) & Mask;
+  // Every bucket is probed at most once even if the table is corrupt.
+  for (size_t Probes = 0; Probes < Buckets.size();
+       ++Probes, Index = (Index + 1) & Mask) {
+    const BucketRecord &Bucket = Buckets[Index];
+    if (Bucket.NumSymbols == 0)
+      break;
+    llvm::StringRef BucketName;
+    if (!getString(Bucket.Name, BucketName) || BucketName != Name)
+      continue;
+    if (Bucket.FirstSymbol > Symbols.size() ||
+        Bucket.NumSymbols > Symbols.size() - Bucket.FirstSymbol)
+      break;
+    for (const SymbolRecord &Record :
+         Symbols.slice(Bucket.FirstSymbol, Bucket.NumSymbols)) {
+      SymbolAndSignals Symbol;
+      if (getSymbol(Record, Symbol))
+        Results.push_back(std::move(Symbol));
+    }
+    break;
+  }
+  return Results;
+}
+
+std::vector<SymbolAndSignals> BinarySymbolDatabase::getAllSymbols() const {
+  std::vector<SymbolAndSignals> Results;
+  Results.reserve(Symbols.size());
+  for (const SymbolRecord &Record : Symbols) {
+    SymbolAndSignals Symbol;
+    if (getSymbol(Record, Symbol))
+      Results.push_back(std::move(Symbol));
+  }
+  return Results;
+}
+
+} // namespace find_all_symbols
+} // namespace clang
@@ -0,0 +1,91 @@
+//===-- BinarySymbolDatabase.h - binary symbol database ---------*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_CLANG_TOOLS_EXTRA_INCLUDE_FIXER_FIND_ALL_SYMBOLS_BINARYSYMBOLDATABASE_H
+#define LLVM_CLANG_TOOLS_EXTRA_INCLUDE_FIXER_FIND_ALL_SYMBOLS_BINARYSYMBOLDATABASE_H
+
+#include "SymbolInfo.h"
+#include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/StringRef.h"
+#include "llvm/Support/ErrorOr.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/raw_ostream.h"
+#include <memory>
+#include <vector>
+
+namespace clang {
+namespace find_all_symbols {
+
+namespace binary {
+struct FileHeader;
+struct SymbolRecord;
+struct ContextRecord;
+struct BucketRecord;
+struct StringRecord;
+} // namespace binary
+
+/// \brief A symbol database in a binary format which is queried in place.
+///
+/// The file consists of a header, fixed size symbol and context records, an
+/// open addressing hash table from each symbol name to the range of records
+/// of the symbols with this name, and a table of the strings referenced by the
+/// records. Opening a database maps the file into memory and only checks the
+/// header, queries hash the name and materialize the matching records.
+class BinarySymbolDatabase {
+public:
+  ~BinarySymbolDatabase();
+
+  /// \brief Opens the database written to \p FilePath by
+  /// \c WriteSymbolInfosToBinary.
+  static llvm::ErrorOr<std::unique_ptr<BinarySymbolDatabase>>
+  createFromFile(llvm::StringRef FilePath);
+
+  /// \brief Opens the database in \p Buffer.
+  static llvm::ErrorOr<std::unique_ptr<BinarySymbolDatabase>>
+  createFromBuffer(std::unique_ptr<llvm::MemoryBuffer> Buffer);
+
+  /// \brief Returns the symbols named \p Name.
+  std::vector<SymbolAndSignals> lookup(llvm::StringRef Name) const;
+
+  /// \brief Returns all symbols of the database.
+  std::vector<SymbolAndSignals> getAllSymbols() const;
+
+  /// \brief Returns the number of symbols in the database.
+  size_t size() const { return Symbols.size(); }
+
+private:
+  explicit BinarySymbolDatabase(std::unique_ptr<llvm::MemoryBuffer> Buffer);
+
+  /// \brief Returns the string \p Record refers to, or false if it is out of
+  /// the string table.
+  bool getString(const binary::StringRecord &Record,
+                 llvm::StringRef &Result) const;
+
+  /// \brief Materializes the symbol record \p Record into \p Result. Returns
+  /// false if the record is corrupt.
+  bool getSymbol(const binary::SymbolRecord &Record,
+                 SymbolAndSignals &Result) const;
+
+  std::unique_ptr<llvm::MemoryBuffer> Buffer;
+  llvm::ArrayRef<binary::SymbolRecord> Symbols;
+  llvm::ArrayRef<binary::ContextRecord> Contexts;
+  llvm::ArrayRef<binary::BucketRecord> Buckets;
+  llvm::StringRef Strings;
+};
+
+/// \brief Write SymbolInfos to a stream in the format read by
+/// \c BinarySymbolDatabase. Returns false if the database is too large for
+/// the format.
+bool WriteSymbolInfosToBinary(llvm::raw_ostream &OS,
+                              const SymbolInfo::SignalMap &Symbols);
+
+} // namespace find_all_symbols
+} // namespace clang
+
+#endif // LLVM_CLANG_TOOLS_EXTRA_INCLUDE_FIXER_FIND_ALL_SYMBOLS_BINARYSYMBOLDATABASE_H
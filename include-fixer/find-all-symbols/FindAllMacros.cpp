@@ -33,8 +33,17 @@ FindAllMacros::CreateMacroSymbol(const Token &MacroNameTok,
 
 void FindAllMacros::MacroDefined(const Token &MacroNameTok,
                                  const MacroDirective *MD) {
-  if (auto Symbol = CreateMacroSymbol(MacroNameTok, MD->getMacroInfo()))
+  SymbolInfo::SignalMap *Recorded;
+  // Macros don't depend on the scope their header is included in.
+  if (!Headers.shouldIndex(*SM, MD->getMacroInfo()->getDefinitionLoc(),
+                           /*IncludedAtFileScope=*/true, FileSymbols,
+                           Recorded))
+    return;
+  if (auto Symbol = CreateMacroSymbol(MacroNameTok, MD->getMacroInfo())) {
     ++FileSymbols[*Symbol].Seen;
+    if (Recorded)
+      ++(*Recorded)[*Symbol].Seen;
+  }
 }
 
 void FindAllMacros::MacroUsed(const Token &Name, const MacroDefinition &MD) {
@@ -61,6 +70,7 @@ void FindAllMacros::Ifndef(SourceLocation Loc, const Token &MacroNameTok,
 }
 
 void FindAllMacros::EndOfMainFile() {
+  Headers.finish(/*Store=*/true);
   Reporter->reportSymbols(SM->getFileEntryForID(SM->getMainFileID())->getName(),
                           FileSymbols);
   FileSymbols.clear();
@@ -11,6 +11,7 @@
 #ifndef LLVM_CLANG_TOOLS_EXTRA_FIND_ALL_SYMBOLS_FIND_ALL_MACROS_H
 #define LLVM_CLANG_TOOLS_EXTRA_FIND_ALL_SYMBOLS_FIND_ALL_MACROS_H
 
+#include "HeaderSymbolCache.h"
 #include "SymbolInfo.h"
 #include "SymbolReporter.h"
 #include "clang/Lex/PPCallbacks.h"
@@ -26,9 +27,16 @@ class HeaderMapCollector;
 /// preprocessing period.
 class FindAllMacros : public clang::PPCallbacks {
 public:
+  /// \param PP the preprocessor of the translation unit, which is needed to
+  /// cache the macros of its headers in \p Cache.
   explicit FindAllMacros(SymbolReporter *Reporter, SourceManager *SM,
-                         HeaderMapCollector *Collector = nullptr)
-      : Reporter(Reporter), SM(SM), Collector(Collector) {}
+                         HeaderMapCollector *Collector = nullptr,
+                         HeaderSymbolCache *Cache = nullptr,
+                         const Preprocessor *PP = nullptr)
+      : Reporter(Reporter), SM(SM), Collector(Collector),
+        Headers(Cache, HeaderSymbolCache::Macros) {
+    Headers.setPreprocessor(PP);
+  }
 
   void MacroDefined(const Token &MacroNameTok,
                     const MacroDirective *MD) override;
@@ -57,6 +65,9 @@ private:
   // A remapping header file collector allowing clients to include a different
   // header.
   HeaderMapCollector *const Collector;
+  // The headers of the main file whose macros are cached or recorded for
+  // later main files.
+  HeaderSymbolRecorder Headers;
 };
 
 } // namespace find_all_symbols
@@ -112,6 +112,25 @@ CreateSymbolInfo(const NamedDecl *ND, const SourceManager &SM,
   return SymbolInfo(ND->getNameAsString(), Type, FilePath, GetContexts(ND));
 }
 
+// Returns true if the header \p File declaring \p ND was included outside of
+// any namespace or class, i.e. the first declaration enclosing \p ND which
+// isn't in \p File is the translation unit. extern "C" blocks don't change
+// the symbols and are ignored.
+bool IsIncludedAtFileScope(const NamedDecl *ND, const SourceManager &SM,
+                           FileID File) {
+  for (const DeclContext *Context = ND->getLexicalDeclContext();
+       !llvm::isa<TranslationUnitDecl>(Context);
+       Context = Context->getLexicalParent()) {
+    if (llvm::isa<LinkageSpecDecl>(Context))
+      continue;
+    SourceLocation Loc =
+        SM.getExpansionLoc(llvm::cast<Decl>(Context)->getLocation());
+    if (SM.getFileID(Loc) != File)
+      return false;
+  }
+  return true;
+}
+
 } // namespace
 
 void FindAllSymbols::registerMatchers(MatchFinder *MatchFinder) {
@@ -238,6 +257,7 @@ void FindAllSymbols::registerMatchers(MatchFinder *MatchFinder) {
 void FindAllSymbols::run(const MatchFinder::MatchResult &Result) {
   // Ignore Results in failing TUs.
   if (Result.Context->getDiagnostics().hasErrorOccurred()) {
+    HasErrors = true;
     return;
   }
 
@@ -251,13 +271,31 @@ void FindAllSymbols::run(const MatchFinder::MatchResult &Result) {
     assert(false && "Must match a NamedDecl!");
 
   const SourceManager *SM = Result.SourceManager;
+  // Declarations are only matched in headers, uses only in the main file.
+  SymbolInfo::SignalMap *Recorded = nullptr;
+  if (Signals.Seen) {
+    SourceLocation Loc = SM->getExpansionLoc(ND->getLocation());
+    size_t NumSymbols = FileSymbols.size();
+    bool Index = Headers.shouldIndex(
+        *SM, Loc, IsIncludedAtFileScope(ND, *SM, SM->getFileID(Loc)),
+        FileSymbols, Recorded);
+    // The cached symbols of the header may have been added.
+    if (FileSymbols.size() != NumSymbols)
+      Filename = SM->getFileEntryForID(SM->getMainFileID())->getName();
+    if (!Index)
+      return;
+  }
   if (auto Symbol = CreateSymbolInfo(ND, *SM, Collector)) {
     Filename = SM->getFileEntryForID(SM->getMainFileID())->getName();
     FileSymbols[*Symbol] += Signals;
+    if (Recorded)
+      (*Recorded)[*Symbol] += Signals;
   }
 }
 
 void FindAllSymbols::onEndOfTranslationUnit() {
+  Headers.finish(/*Store=*/!HasErrors);
+  HasErrors = false;
   if (Filename != "") {
     Reporter->reportSymbols(Filename, FileSymbols);
     FileSymbols.clear();
@@ -10,6 +10,7 @@
 #ifndef LLVM_CLANG_TOOLS_EXTRA_FIND_ALL_SYMBOLS_SYMBOL_MATCHER_H
 #define LLVM_CLANG_TOOLS_EXTRA_FIND_ALL_SYMBOLS_SYMBOL_MATCHER_H
 
+#include "HeaderSymbolCache.h"
 #include "SymbolInfo.h"
 #include "SymbolReporter.h"
 #include "clang/ASTMatchers/ASTMatchFinder.h"
@@ -35,11 +36,17 @@ class HeaderMapCollector;
 class FindAllSymbols : public ast_matchers::MatchFinder::MatchCallback {
 public:
   explicit FindAllSymbols(SymbolReporter *Reporter,
-                          HeaderMapCollector *Collector = nullptr)
-      : Reporter(Reporter), Collector(Collector) {}
+                          HeaderMapCollector *Collector = nullptr,
+                          HeaderSymbolCache *Cache = nullptr)
+      : Reporter(Reporter), Collector(Collector),
+        Headers(Cache, HeaderSymbolCache::Declarations) {}
 
   void registerMatchers(ast_matchers::MatchFinder *MatchFinder);
 
+  /// \brief Sets the preprocessor of the translation unit analyzed next, which
+  /// is needed to cache the symbols of its headers.
+  void setPreprocessor(const Preprocessor *PP) { Headers.setPreprocessor(PP); }
+
   void run(const ast_matchers::MatchFinder::MatchResult &result) override;
 
 protected:
@@ -55,6 +62,12 @@ private:
   // A remapping header file collector allowing clients include a different
   // header.
   HeaderMapCollector *const Collector;
+  // The headers of the current source file whose symbols are cached or
+  // recorded for later source files.
+  HeaderSymbolRecorder Headers;
+  // Whether the current source file has errors, so that its headers aren't
+  // cached.
+  bool HasErrors = false;
 };
 
 } // namespace find_all_symbols
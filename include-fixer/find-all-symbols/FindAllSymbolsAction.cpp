@@ -18,9 +18,10 @@ namespace find_all_symbols {
 
 FindAllSymbolsAction::FindAllSymbolsAction(
     SymbolReporter *Reporter,
-    const HeaderMapCollector::RegexHeaderMap *RegexHeaderMap)
-    : Reporter(Reporter), Collector(RegexHeaderMap), Handler(&Collector),
-      Matcher(Reporter, &Collector) {
+    const HeaderMapCollector::RegexHeaderMap *RegexHeaderMap,
+    HeaderSymbolCache *Cache)
+    : Reporter(Reporter), Cache(Cache), Collector(RegexHeaderMap),
+      Handler(&Collector), Matcher(Reporter, &Collector, Cache) {
   Matcher.registerMatchers(&MatchFinder);
 }
 
@@ -29,7 +30,9 @@ FindAllSymbolsAction::CreateASTConsumer(CompilerInstance &Compiler,
                                         StringRef InFile) {
   Compiler.getPreprocessor().addCommentHandler(&Handler);
   Compiler.getPreprocessor().addPPCallbacks(llvm::make_unique<FindAllMacros>(
-      Reporter, &Compiler.getSourceManager(), &Collector));
+      Reporter, &Compiler.getSourceManager(), &Collector, Cache,
+      &Compiler.getPreprocessor()));
+  Matcher.setPreprocessor(&Compiler.getPreprocessor());
   return MatchFinder.newASTConsumer();
 }
 
@@ -12,6 +12,7 @@
 
 #include "FindAllSymbols.h"
 #include "HeaderMapCollector.h"
+#include "HeaderSymbolCache.h"
 #include "PragmaCommentHandler.h"
 #include "clang/ASTMatchers/ASTMatchFinder.h"
 #include "clang/Frontend/CompilerInstance.h"
@@ -27,7 +28,8 @@ class FindAllSymbolsAction : public clang::ASTFrontendAction {
 public:
   explicit FindAllSymbolsAction(
       SymbolReporter *Reporter,
-      const HeaderMapCollector::RegexHeaderMap *RegexHeaderMap = nullptr);
+      const HeaderMapCollector::RegexHeaderMap *RegexHeaderMap = nullptr,
+      HeaderSymbolCache *Cache = nullptr);
 
   std::unique_ptr<clang::ASTConsumer>
   CreateASTConsumer(clang::CompilerInstance &Compiler,
@@ -35,6 +37,7 @@ public:
 
 private:
   SymbolReporter *const Reporter;
+  HeaderSymbolCache *const Cache;
   clang::ast_matchers::MatchFinder MatchFinder;
   HeaderMapCollector Collector;
   PragmaCommentHandler Handler;
@@ -43,18 +46,22 @@ private:
 
 class FindAllSymbolsActionFactory : public tooling::FrontendActionFactory {
 public:
+  /// \brief If \p Cache is given, the symbols of each header are only
+  /// collected for the first file including it and reused for later files.
   FindAllSymbolsActionFactory(
       SymbolReporter *Reporter,
-      const HeaderMapCollector::RegexHeaderMap *RegexHeaderMap = nullptr)
-      : Reporter(Reporter), RegexHeaderMap(RegexHeaderMap) {}
+      const HeaderMapCollector::RegexHeaderMap *RegexHeaderMap = nullptr,
+      HeaderSymbolCache *Cache = nullptr)
+      : Reporter(Reporter), RegexHeaderMap(RegexHeaderMap), Cache(Cache) {}
 
   clang::FrontendAction *create() override {
-    return new FindAllSymbolsAction(Reporter, RegexHeaderMap);
+    return new FindAllSymbolsAction(Reporter, RegexHeaderMap, Cache);
   }
 
 private:
   SymbolReporter *const Reporter;
   const HeaderMapCollector::RegexHeaderMap *const RegexHeaderMap;
+  HeaderSymbolCache *const Cache;
 };
 
 } // namespace find_all_symbols
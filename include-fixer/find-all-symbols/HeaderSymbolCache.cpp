@@ -0,0 +1,117 @@
+//===-- HeaderSymbolCache.cpp - find all symbols ----------------*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#include "HeaderSymbolCache.h"
+#include "clang/Lex/HeaderSearch.h"
+#include "clang/Lex/Preprocessor.h"
+#include "llvm/ADT/Hashing.h"
+#include "llvm/ADT/StringExtras.h"
+#include "llvm/ADT/Twine.h"
+
+namespace clang {
+namespace find_all_symbols {
+
+std::string HeaderSymbolCache::getKey(SymbolSource Source,
+                                      llvm::StringRef FileName, size_t Hash,
+                                      llvm::StringRef Predefines) {
+  unsigned Context =
+      Contexts.insert(std::make_pair(Predefines, Contexts.size()))
+          .first->second;
+  return (llvm::Twine(Source == Macros ? "macros:" : "decls:") +
+          llvm::Twine(Context) + ":" + FileName + ":" + llvm::utohexstr(Hash))
+      .str();
+}
+
+HeaderSymbolCache::SymbolsPtr
+HeaderSymbolCache::lookup(SymbolSource Source, llvm::StringRef FileName,
+                          size_t Hash, llvm::StringRef Predefines) {
+  std::lock_guard<std::mutex> Lock(Mutex);
+  auto I = Headers.find(getKey(Source, FileName, Hash, Predefines));
+  if (I == Headers.end())
+    return nullptr;
+  return I->second;
+}
+
+void HeaderSymbolCache::insert(SymbolSource Source, llvm::StringRef FileName,
+                               size_t Hash, llvm::StringRef Predefines,
+                               SymbolInfo::SignalMap Symbols) {
+  auto Ptr = std::make_shared<const SymbolInfo::SignalMap>(std::move(Symbols));
+  std::lock_guard<std::mutex> Lock(Mutex);
+  // Another thread may have indexed the header at the same time, keep the
+  // symbols stored first.
+  Headers.insert(std::make_pair(getKey(Source, FileName, Hash, Predefines),
+                                std::move(Ptr)));
+}
+
+size_t HeaderSymbolCache::size() {
+  std::lock_guard<std::mutex> Lock(Mutex);
+  return Headers.size();
+}
+
+bool HeaderSymbolRecorder::shouldIndex(const SourceManager &SM,
+                                       SourceLocation Loc,
+                                       bool IncludedAtFileScope,
+                                       SymbolInfo::SignalMap &FileSymbols,
+                                       SymbolInfo::SignalMap *&Recorded) {
+  Recorded = nullptr;
+  if (!Cache || !PP || !Loc.isValid())
+    return true;
+  FileID FID = SM.getFileID(Loc);
+  auto Inserted = Headers.insert(std::make_pair(FID, HeaderState()));
+  HeaderState &State = Inserted.first->second;
+  if (Inserted.second) {
+    const FileEntry *Entry = SM.getFileEntryForID(FID);
+    // The symbols of .inc files are reported for the header including them,
+    // see getIncludePath.
+    if (Entry && FID != SM.getMainFileID() && IncludedAtFileScope &&
+        !llvm::StringRef(Entry->getName()).endswith(".inc")) {
+      bool Invalid = false;
+      llvm::StringRef Content = SM.getBufferData(FID, &Invalid);
+      if (!Invalid) {
+        State.Entry = Entry;
+        State.Hash = llvm::hash_value(Content);
+        State.Cacheable = true;
+        // Whether the header has an include guard is only known once it has
+        // been preprocessed, which is checked before storing its symbols.
+        // Cached symbols were stored for the same content, so the header is
+        // guarded.
+        State.Cached = Cache->lookup(Source, Entry->getName(), State.Hash,
+                                     PP->getPredefines());
+        if (State.Cached)
+          for (const auto &Symbol : *State.Cached)
+            FileSymbols[Symbol.first] += Symbol.second;
+      }
+    }
+  }
+  if (State.Cached)
+    return false;
+  if (State.Cacheable)
+    Recorded = &State.Recorded;
+  return true;
+}
+
+void HeaderSymbolRecorder::finish(bool Store) {
+  if (Store && PP) {
+    HeaderSearch &HS = PP->getHeaderSearchInfo();
+    for (auto &Header : Headers) {
+      HeaderState &State = Header.second;
+      // Headers without include guard, like X-macro .def files, may declare
+      // other symbols each time they are included.
+      if (State.Cacheable && !State.Cached &&
+          HS.isFileMultipleIncludeGuarded(State.Entry))
+        Cache->insert(Source, State.Entry->getName(), State.Hash,
+                      PP->getPredefines(), std::move(State.Recorded));
+    }
+  }
+  Headers.clear();
+  PP = nullptr;
+}
+
+} // namespace find_all_symbols
+} // namespace clang
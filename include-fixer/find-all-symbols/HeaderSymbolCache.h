@@ -0,0 +1,120 @@
+//===-- HeaderSymbolCache.h - find all symbols ------------------*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_CLANG_TOOLS_EXTRA_FIND_ALL_SYMBOLS_HEADER_SYMBOL_CACHE_H
+#define LLVM_CLANG_TOOLS_EXTRA_FIND_ALL_SYMBOLS_HEADER_SYMBOL_CACHE_H
+
+#include "SymbolInfo.h"
+#include "clang/Basic/SourceManager.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/StringMap.h"
+#include "llvm/ADT/StringRef.h"
+#include <memory>
+#include <mutex>
+
+namespace clang {
+
+class Preprocessor;
+
+namespace find_all_symbols {
+
+/// \brief HeaderSymbolCache remembers the symbols declared in each header file
+/// across translation units, so that the symbols of a header which was
+/// already indexed aren't created again for every translation unit including
+/// it. Headers are identified by their file name, a hash of their content and
+/// the predefined macros of the translation unit, which include the macros
+/// defined on the command line.
+///
+/// Only headers with an include guard which are included at file scope are
+/// cached. The symbols of such a header are still assumed not to depend on
+/// macros defined by the includer before including it.
+///
+/// HeaderSymbolCache is thread-safe.
+class HeaderSymbolCache {
+public:
+  typedef std::shared_ptr<const SymbolInfo::SignalMap> SymbolsPtr;
+
+  /// \brief The kinds of symbols, which are collected separately.
+  enum SymbolSource { Declarations, Macros };
+
+  /// \brief Returns the symbols of kind \p Source declared in the header
+  /// \p FileName with the content hash \p Hash in translation units with the
+  /// predefined macros \p Predefines, or null if it wasn't indexed yet.
+  SymbolsPtr lookup(SymbolSource Source, llvm::StringRef FileName,
+                    size_t Hash, llvm::StringRef Predefines);
+
+  /// \brief Stores the symbols of kind \p Source declared in the header
+  /// \p FileName with the content hash \p Hash in translation units with the
+  /// predefined macros \p Predefines.
+  void insert(SymbolSource Source, llvm::StringRef FileName, size_t Hash,
+              llvm::StringRef Predefines, SymbolInfo::SignalMap Symbols);
+
+  /// \brief Returns the number of cached headers.
+  size_t size();
+
+private:
+  std::string getKey(SymbolSource Source, llvm::StringRef FileName,
+                     size_t Hash, llvm::StringRef Predefines);
+
+  std::mutex Mutex;
+  llvm::StringMap<SymbolsPtr> Headers;
+  /// \brief A number for each distinct set of predefined macros, which is used
+  /// in the keys instead of the whole set.
+  llvm::StringMap<unsigned> Contexts;
+};
+
+/// \brief Tracks the headers of one translation unit for a HeaderSymbolCache.
+class HeaderSymbolRecorder {
+public:
+  HeaderSymbolRecorder(HeaderSymbolCache *Cache,
+                       HeaderSymbolCache::SymbolSource Source)
+      : Cache(Cache), Source(Source), PP(nullptr) {}
+
+  /// \brief Sets the preprocessor of the current translation unit. Headers are
+  /// only cached while it is set.
+  void setPreprocessor(const Preprocessor *PP) { this->PP = PP; }
+
+  /// \brief Decides whether the symbol declared at \p Loc has to be indexed.
+  ///
+  /// Returns false if the symbols of the header containing \p Loc are cached.
+  /// They are added to \p FileSymbols the first time this header is seen.
+  /// Otherwise, sets \p Recorded to the map of the header the symbol has to be
+  /// added to in addition to \p FileSymbols, or to null if the header can't
+  /// be cached. \p IncludedAtFileScope tells whether the header was included
+  /// outside of any declaration, as the symbols of headers included in a
+  /// namespace or class depend on it.
+  bool shouldIndex(const SourceManager &SM, SourceLocation Loc,
+                   bool IncludedAtFileScope,
+                   SymbolInfo::SignalMap &FileSymbols,
+                   SymbolInfo::SignalMap *&Recorded);
+
+  /// \brief Stores the symbols recorded for the include-guarded headers of
+  /// the translation unit in the cache if \p Store is true, and resets the
+  /// recorder for the next translation unit.
+  void finish(bool Store);
+
+private:
+  struct HeaderState {
+    const FileEntry *Entry = nullptr;
+    size_t Hash = 0;
+    bool Cacheable = false;
+    HeaderSymbolCache::SymbolsPtr Cached;
+    SymbolInfo::SignalMap Recorded;
+  };
+
+  HeaderSymbolCache *const Cache;
+  const HeaderSymbolCache::SymbolSource Source;
+  const Preprocessor *PP;
+  llvm::DenseMap<FileID, HeaderState> Headers;
+};
+
+} // namespace find_all_symbols
+} // namespace clang
+
+#endif // LLVM_CLANG_TOOLS_EXTRA_FIND_ALL_SYMBOLS_HEADER_SYMBOL_CACHE_H
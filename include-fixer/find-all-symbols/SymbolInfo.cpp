@@ -118,14 +118,23 @@ bool SymbolAndSignals::operator==(const SymbolAndSignals& RHS) const {
 
 bool WriteSymbolInfosToStream(llvm::raw_ostream &OS,
                               const SymbolInfo::SignalMap &Symbols) {
-  llvm::yaml::Output yout(OS);
-  for (const auto &Symbol : Symbols) {
-    SymbolAndSignals S{Symbol.first, Symbol.second};
-    yout << S;
-  }
+  SymbolInfoYAMLWriter Writer(OS);
+  for (const auto &Symbol : Symbols)
+    Writer.write(Symbol.first, Symbol.second);
   return true;
 }
 
+SymbolInfoYAMLWriter::SymbolInfoYAMLWriter(llvm::raw_ostream &OS)
+    : Output(new llvm::yaml::Output(OS)) {}
+
+SymbolInfoYAMLWriter::~SymbolInfoYAMLWriter() = default;
+
+void SymbolInfoYAMLWriter::write(const SymbolInfo &Symbol,
+                                 const SymbolInfo::Signals &Signals) {
+  SymbolAndSignals S{Symbol, Signals};
+  *Output << S;
+}
+
 std::vector<SymbolAndSignals> ReadSymbolInfosFromYAML(llvm::StringRef Yaml) {
   std::vector<SymbolAndSignals> Symbols;
   llvm::yaml::Input yin(Yaml);
@@ -14,6 +14,7 @@
 #include "llvm/ADT/StringRef.h"
 #include "llvm/Support/YAMLTraits.h"
 #include "llvm/Support/raw_ostream.h"
+#include <memory>
 #include <set>
 #include <string>
 #include <vector>
@@ -134,6 +135,19 @@ struct SymbolAndSignals {
 bool WriteSymbolInfosToStream(llvm::raw_ostream &OS,
                               const SymbolInfo::SignalMap &Symbols);
 
+/// \brief Writes SymbolInfos to a stream (YAML format) one at a time, so that
+/// they don't have to be collected into a \c SignalMap first.
+class SymbolInfoYAMLWriter {
+public:
+  explicit SymbolInfoYAMLWriter(llvm::raw_ostream &OS);
+  ~SymbolInfoYAMLWriter();
+
+  void write(const SymbolInfo &Symbol, const SymbolInfo::Signals &Signals);
+
+private:
+  std::unique_ptr<llvm::yaml::Output> Output;
+};
+
 /// \brief Read SymbolInfos from a YAML document.
 std::vector<SymbolAndSignals> ReadSymbolInfosFromYAML(llvm::StringRef Yaml);
 
@@ -7,6 +7,7 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include "BinarySymbolDatabase.h"
 #include "FindAllSymbolsAction.h"
 #include "STLPostfixHeaderMap.h"
 #include "SymbolInfo.h"
@@ -19,16 +20,24 @@
 #include "clang/Tooling/CommonOptionsParser.h"
 #include "clang/Tooling/Tooling.h"
 #include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/STLExtras.h"
 #include "llvm/ADT/SmallString.h"
 #include "llvm/ADT/StringRef.h"
 #include "llvm/Support/CommandLine.h"
+#include "llvm/Support/ErrorHandling.h"
 #include "llvm/Support/FileSystem.h"
+#include "llvm/Support/MD5.h"
 #include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/Path.h"
 #include "llvm/Support/ThreadPool.h"
+#include "llvm/Support/Threading.h"
+#include "llvm/Support/YAMLTraits.h"
 #include "llvm/Support/raw_ostream.h"
+#include <algorithm>
+#include <atomic>
 #include <map>
 #include <mutex>
+#include <queue>
 #include <set>
 #include <string>
 #include <system_error>
@@ -59,6 +68,88 @@ static cl::opt<std::string> MergeDir("merge-dir", cl::desc(R"(
 The directory for merging symbols.)"),
                                      cl::init(""),
                                      cl::cat(FindAllSymbolsCategory));
+
+static cl::opt<std::string> Convert("convert", cl::desc(R"(
+Convert the given YAML symbol database to the output format.)"),
+                                    cl::init(""),
+                                    cl::cat(FindAllSymbolsCategory));
+
+enum OutputFormatTy {
+  yaml,   ///< YAML database.
+  binary, ///< Binary database which include-fixer maps into memory.
+};
+
+static cl::opt<OutputFormatTy> OutputFormat(
+    "output-format",
+    cl::desc("Format of the database written by -merge-dir and -convert"),
+    cl::values(clEnumVal(yaml, "YAML database"),
+               clEnumVal(binary, "Binary database, queried in place")),
+    cl::init(yaml), cl::cat(FindAllSymbolsCategory));
+
+static cl::opt<std::string> IncrementalDir("incremental-dir", cl::desc(R"(
+Update the database in -output-dir instead of rebuilding it. Only the files
+which are new or include a changed file are indexed again. The files each
+source file was built from and the symbols it contributed are stored in this
+directory.)"),
+                                           cl::init(""),
+                                           cl::cat(FindAllSymbolsCategory));
+
+static cl::opt<unsigned> Jobs("j", cl::desc(R"(
+Index the source files on this many threads (0 for one per core) and write
+the merged database to find_all_symbols_db.yaml (or .bin with
+-output-format=binary) in -output-dir, instead of one file per translation
+unit. Indexes all files of the compilation database if no source file is
+given.)"),
+                              cl::init(0), cl::cat(FindAllSymbolsCategory));
+
+static cl::opt<bool> CacheHeaderSymbols("cache-header-symbols", cl::desc(R"(
+Index the symbols of each header with an include guard only once for all
+source files with the same predefined macros, instead of once per source file
+including it. Assumes that the symbols of these headers don't depend on macros
+defined in the source files before including them.)"),
+                                        cl::init(false),
+                                        cl::cat(FindAllSymbolsCategory));
+
+namespace clang {
+namespace find_all_symbols {
+
+/// \brief A file and a digest of its content.
+struct FileDigest {
+  std::string Path;
+  std::string Hash;
+};
+
+/// \brief A file indexed for an incrementally updated database and the files
+/// it was built from.
+struct SourceFileState {
+  std::string File;
+  std::vector<FileDigest> Dependencies;
+};
+
+} // namespace find_all_symbols
+} // namespace clang
+
+LLVM_YAML_IS_SEQUENCE_VECTOR(clang::find_all_symbols::FileDigest)
+LLVM_YAML_IS_DOCUMENT_LIST_VECTOR(clang::find_all_symbols::SourceFileState)
+
+namespace llvm {
+namespace yaml {
+template <> struct MappingTraits<clang::find_all_symbols::FileDigest> {
+  static void mapping(IO &io, clang::find_all_symbols::FileDigest &Digest) {
+    io.mapRequired("Path", Digest.Path);
+    io.mapRequired("Hash", Digest.Hash);
+  }
+};
+
+template <> struct MappingTraits<clang::find_all_symbols::SourceFileState> {
+  static void mapping(IO &io, clang::find_all_symbols::SourceFileState &State) {
+    io.mapRequired("File", State.File);
+    io.mapRequired("Dependencies", State.Dependencies);
+  }
+};
+} // namespace yaml
+} // namespace llvm
+
 namespace clang {
 namespace find_all_symbols {
 
@@ -76,64 +167,546 @@ public:
   }
 };
 
+/// \brief Calls \p Callback for the symbols of all \p Shards in order, with
+/// the sum of the signals of equal symbols of different shards. Each symbol
+/// is removed from its shard when it is passed to \p Callback, so that the
+/// shards don't have to be kept in memory next to the result.
+void MergeShards(std::vector<SymbolInfo::SignalMap> &Shards,
+                 llvm::function_ref<void(const SymbolInfo &,
+                                         const SymbolInfo::Signals &)>
+                     Callback) {
+  typedef std::pair<SymbolInfo::SignalMap::iterator, unsigned> Cursor;
+  auto Greater = [](const Cursor &LHS, const Cursor &RHS) {
+    return RHS.first->first < LHS.first->first;
+  };
+  std::priority_queue<Cursor, std::vector<Cursor>, decltype(Greater)> Heap(
+      Greater);
+  for (unsigned I = 0, E = Shards.size(); I != E; ++I)
+    if (!Shards[I].empty())
+      Heap.push(Cursor(Shards[I].begin(), I));
+
+  auto Advance = [&](Cursor C) {
+    auto Next = std::next(C.first);
+    Shards[C.second].erase(C.first);
+    if (Next != Shards[C.second].end())
+      Heap.push(Cursor(Next, C.second));
+  };
+  while (!Heap.empty()) {
+    Cursor Top = Heap.top();
+    Heap.pop();
+    SymbolInfo Symbol = Top.first->first;
+    SymbolInfo::Signals Signals = Top.first->second;
+    Advance(Top);
+    while (!Heap.empty() && Heap.top().first->first == Symbol) {
+      Top = Heap.top();
+      Heap.pop();
+      Signals += Top.first->second;
+      Advance(Top);
+    }
+    Callback(Symbol, Signals);
+  }
+}
+
+bool WriteDatabase(llvm::StringRef OutputFile,
+                   std::vector<SymbolInfo::SignalMap> &Shards) {
+  std::error_code EC;
+  llvm::raw_fd_ostream OS(OutputFile, EC, llvm::sys::fs::F_None);
+  if (EC) {
+    llvm::errs() << "Can't open '" << OutputFile << "': " << EC.message()
+                 << '\n';
+    return false;
+  }
+  if (OutputFormat == binary) {
+    SymbolInfo::SignalMap Symbols;
+    MergeShards(Shards, [&](const SymbolInfo &Symbol,
+                            const SymbolInfo::Signals &Signals) {
+      Symbols.emplace_hint(Symbols.end(), Symbol, Signals);
+    });
+    if (!WriteSymbolInfosToBinary(OS, Symbols)) {
+      llvm::errs() << "Too many symbols for a binary database\n";
+      return false;
+    }
+    return true;
+  }
+  // YAML is written while the shards are merged.
+  SymbolInfoYAMLWriter Writer(OS);
+  MergeShards(Shards,
+              [&](const SymbolInfo &Symbol, const SymbolInfo::Signals &Signals) {
+                Writer.write(Symbol, Signals);
+              });
+  return true;
+}
+
+void AddSymbolsFromFile(llvm::StringRef Path, SymbolInfo::SignalMap &Symbols) {
+  auto Buffer = llvm::MemoryBuffer::getFile(Path);
+  if (!Buffer) {
+    llvm::errs() << "Can't open " << Path << "\n";
+    return;
+  }
+  for (auto &Symbol : ReadSymbolInfosFromYAML(Buffer.get()->getBuffer())) {
+    // Only count one occurrence per file, to avoid spam.
+    Symbol.Signals.Seen = std::min(Symbol.Signals.Seen, 1u);
+    Symbol.Signals.Used = std::min(Symbol.Signals.Used, 1u);
+    Symbols[Symbol.Symbol] += Symbol.Signals;
+  }
+}
+
 bool Merge(llvm::StringRef MergeDir, llvm::StringRef OutputFile) {
   std::error_code EC;
+  std::vector<std::string> Paths;
+  for (llvm::sys::fs::directory_iterator Dir(MergeDir, EC), DirEnd;
+       Dir != DirEnd && !EC; Dir.increment(EC))
+    Paths.push_back(Dir->path());
+
+  // Load all symbol files in MergeDir. Each thread merges every NumShards-th
+  // file into a shard of its own, so that the threads don't contend for a
+  // single map. The shards are merged while writing the database.
+  unsigned NumShards = std::max<size_t>(
+      1, std::min<size_t>(llvm::heavyweight_hardware_concurrency(),
+                          Paths.size()));
+  std::vector<SymbolInfo::SignalMap> Shards(NumShards);
+  {
+    llvm::ThreadPool Pool(NumShards);
+    for (unsigned Shard = 0; Shard < NumShards; ++Shard)
+      Pool.async([&Paths, &Shards, Shard, NumShards]() {
+        for (size_t I = Shard; I < Paths.size(); I += NumShards)
+          AddSymbolsFromFile(Paths[I], Shards[Shard]);
+      });
+  }
+
+  return WriteDatabase(OutputFile, Shards);
+}
+
+bool ConvertDatabase(llvm::StringRef InputFile, llvm::StringRef OutputFile) {
+  auto Buffer = llvm::MemoryBuffer::getFile(InputFile);
+  if (!Buffer) {
+    llvm::errs() << "Can't open " << InputFile << "\n";
+    return false;
+  }
+  std::vector<SymbolInfo::SignalMap> Shards(1);
+  for (const auto &Symbol : ReadSymbolInfosFromYAML(Buffer.get()->getBuffer()))
+    Shards[0][Symbol.Symbol] += Symbol.Signals;
+  return WriteDatabase(OutputFile, Shards);
+}
+
+/// \brief Merges the symbols of all reported files into one map, counting
+/// each symbol at most once per file like \c Merge.
+class MergingReporter : public SymbolReporter {
+public:
+  void reportSymbols(StringRef FileName,
+                     const SymbolInfo::SignalMap &NewSymbols) override {
+    for (const auto &Symbol : NewSymbols) {
+      SymbolInfo::Signals &Signals = Symbols[Symbol.first];
+      Signals.Seen += std::min(Symbol.second.Seen, 1u);
+      Signals.Used += std::min(Symbol.second.Used, 1u);
+    }
+  }
+
   SymbolInfo::SignalMap Symbols;
-  std::mutex SymbolMutex;
-  auto AddSymbols = [&](ArrayRef<SymbolAndSignals> NewSymbols) {
-    // Synchronize set accesses.
-    std::unique_lock<std::mutex> LockGuard(SymbolMutex);
+};
+
+/// \brief Runs the actions of the factory returned by \p GetFactory for each
+/// thread on \p Files, using \p NumThreads threads.
+bool RunInParallel(
+    const CompilationDatabase &Compilations, ArrayRef<std::string> Files,
+    unsigned NumThreads,
+    llvm::function_ref<tooling::FrontendActionFactory *(unsigned)> GetFactory) {
+  // ClangTool changes the process-wide working directory to the directory of
+  // each compile command, so only files built in the same directory can be
+  // indexed at the same time. Index the files of one directory after another
+  // and make it the working directory while doing so.
+  std::map<std::string, std::vector<std::string>> FilesByDirectory;
+  for (const std::string &File : Files) {
+    std::string AbsolutePath = tooling::getAbsolutePath(File);
+    std::vector<CompileCommand> Commands =
+        Compilations.getCompileCommands(AbsolutePath);
+    FilesByDirectory[Commands.empty() ? "" : Commands.front().Directory]
+        .push_back(std::move(AbsolutePath));
+  }
+  SmallString<256> InitialDirectory;
+  if (llvm::sys::fs::current_path(InitialDirectory))
+    llvm::report_fatal_error("Cannot get current working path.");
+
+  // Like clang-tidy -j, each thread takes the next file of the directory as
+  // soon as it is done with the previous one, so that a few large files don't
+  // leave the other threads idle. A FileManager isn't thread-safe, so each
+  // file is indexed with a ClangTool of its own.
+  std::atomic<bool> Failed(false);
+  llvm::ThreadPool Pool(NumThreads);
+  for (const auto &DirectoryAndFiles : FilesByDirectory) {
+    if (!DirectoryAndFiles.first.empty() &&
+        llvm::sys::fs::set_current_path(DirectoryAndFiles.first))
+      llvm::errs() << "Cannot change the working directory to "
+                   << DirectoryAndFiles.first << "\n";
+    ArrayRef<std::string> DirectoryFiles = DirectoryAndFiles.second;
+    std::atomic<size_t> NextFile(0);
+    for (unsigned I = 0; I < NumThreads && I < DirectoryFiles.size(); ++I) {
+      Pool.async([&, I] {
+        for (size_t Index = NextFile++; Index < DirectoryFiles.size();
+             Index = NextFile++) {
+          ClangTool Tool(Compilations, DirectoryFiles[Index]);
+          if (Tool.run(GetFactory(I)))
+            Failed = true;
+        }
+      });
+    }
+    Pool.wait();
+  }
+  if (llvm::sys::fs::set_current_path(InitialDirectory))
+    llvm::report_fatal_error("Cannot restore the working directory.");
+  return !Failed;
+}
+
+std::string GetDatabasePath() {
+  return OutputDir + (OutputFormat == binary ? "/find_all_symbols_db.bin"
+                                             : "/find_all_symbols_db.yaml");
+}
+
+bool IndexInParallel(const CompilationDatabase &Compilations,
+                     ArrayRef<std::string> Files, unsigned NumThreads) {
+  // Each thread merges the symbols of its files into a reporter of its own.
+  std::vector<MergingReporter> Reporters(NumThreads);
+  HeaderSymbolCache Cache;
+  std::vector<std::unique_ptr<FindAllSymbolsActionFactory>> Factories;
+  for (MergingReporter &Reporter : Reporters)
+    Factories.push_back(llvm::make_unique<FindAllSymbolsActionFactory>(
+        &Reporter, getSTLPostfixHeaderMap(),
+        CacheHeaderSymbols ? &Cache : nullptr));
+  bool Success = RunInParallel(Compilations, Files, NumThreads,
+                               [&](unsigned I) { return Factories[I].get(); });
+
+  std::vector<SymbolInfo::SignalMap> Shards;
+  for (MergingReporter &Reporter : Reporters)
+    Shards.push_back(std::move(Reporter.Symbols));
+  return WriteDatabase(GetDatabasePath(), Shards) && Success;
+}
+
+/// \brief Returns a digest of \p Content which is stable across runs.
+std::string GetDigest(StringRef Content) {
+  llvm::MD5 Hash;
+  Hash.update(Content);
+  llvm::MD5::MD5Result Result;
+  Hash.final(Result);
+  SmallString<32> Digest;
+  llvm::MD5::stringifyResult(Result, Digest);
+  return Digest.str();
+}
+
+/// \brief Returns the absolute path without dots by which the manifest refers
+/// to the source file \p File, relative to the current working directory.
+std::string GetSourceFileKey(StringRef File) {
+  SmallString<256> Path(tooling::getAbsolutePath(File));
+  llvm::sys::path::remove_dots(Path, /*remove_dot_dot=*/true);
+  return Path.str();
+}
+
+/// \brief Collects the symbols each indexed file contributes to the database
+/// and the files it was built from. Thread-safe.
+///
+/// The files are reported by the name of the main file of the compiler, which
+/// is relative to the directory of the compile command if its command line
+/// is. They are stored by the key the manifest uses.
+class SourceFileCollector : public SymbolReporter {
+public:
+  struct SourceFile {
+    SymbolInfo::SignalMap Symbols;
+    /// \brief Empty if the file couldn't be indexed.
+    std::vector<FileDigest> Dependencies;
+  };
+
+  void reportSymbols(StringRef FileName,
+                     const SymbolInfo::SignalMap &NewSymbols) override {
+    std::string Key = GetSourceFileKey(FileName);
+    std::lock_guard<std::mutex> Lock(Mutex);
+    SymbolInfo::SignalMap &Symbols = Files[Key].Symbols;
+    // Count each symbol at most once per file, like Merge.
     for (const auto &Symbol : NewSymbols) {
-      Symbols[Symbol.Symbol] += Symbol.Signals;
+      SymbolInfo::Signals &Signals = Symbols[Symbol.first];
+      Signals.Seen += std::min(Symbol.second.Seen, 1u);
+      Signals.Used += std::min(Symbol.second.Used, 1u);
+    }
+  }
+
+  void addDependencies(StringRef FileName,
+                       std::vector<FileDigest> Dependencies) {
+    std::string Key = GetSourceFileKey(FileName);
+    std::lock_guard<std::mutex> Lock(Mutex);
+    Files[Key].Dependencies = std::move(Dependencies);
+  }
+
+  std::map<std::string, SourceFile> Files;
+
+private:
+  std::mutex Mutex;
+};
+
+/// \brief Indexes a file and records the digests of the files it includes.
+class DependencyCollectingAction : public FindAllSymbolsAction {
+public:
+  DependencyCollectingAction(SourceFileCollector &Collector,
+                             HeaderSymbolCache *Cache)
+      : FindAllSymbolsAction(&Collector, getSTLPostfixHeaderMap(), Cache),
+        Collector(Collector) {}
+
+protected:
+  void EndSourceFileAction() override {
+    // Files with errors aren't recorded, so that they are indexed again by the
+    // next run.
+    if (getCompilerInstance().getDiagnostics().hasErrorOccurred()) {
+      FindAllSymbolsAction::EndSourceFileAction();
+      return;
+    }
+    const SourceManager &SM = getCompilerInstance().getSourceManager();
+    std::vector<FileDigest> Dependencies;
+    for (auto I = SM.fileinfo_begin(), E = SM.fileinfo_end(); I != E; ++I) {
+      const llvm::MemoryBuffer *Buffer = I->second->getRawBuffer();
+      if (!Buffer)
+        continue;
+      // The working directory is the one of the compile command here.
+      std::string Path = I->first->tryGetRealPathName();
+      if (Path.empty())
+        Path = tooling::getAbsolutePath(I->first->getName());
+      Dependencies.push_back({Path, GetDigest(Buffer->getBuffer())});
+    }
+    Collector.addDependencies(
+        SM.getFileEntryForID(SM.getMainFileID())->getName(),
+        std::move(Dependencies));
+    FindAllSymbolsAction::EndSourceFileAction();
+  }
+
+private:
+  SourceFileCollector &Collector;
+};
+
+class DependencyCollectingActionFactory
+    : public tooling::FrontendActionFactory {
+public:
+  DependencyCollectingActionFactory(SourceFileCollector &Collector,
+                                    HeaderSymbolCache *Cache)
+      : Collector(Collector), Cache(Cache) {}
+
+  clang::FrontendAction *create() override {
+    return new DependencyCollectingAction(Collector, Cache);
+  }
+
+private:
+  SourceFileCollector &Collector;
+  HeaderSymbolCache *const Cache;
+};
+
+/// \brief Reads the database written by a previous run into \p Symbols.
+bool ReadDatabase(StringRef DatabaseFile, SymbolInfo::SignalMap &Symbols) {
+  std::vector<SymbolAndSignals> AllSymbols;
+  if (OutputFormat == binary) {
+    auto Database = BinarySymbolDatabase::createFromFile(DatabaseFile);
+    if (!Database)
+      return false;
+    AllSymbols = (*Database)->getAllSymbols();
+  } else {
+    auto Buffer = llvm::MemoryBuffer::getFile(DatabaseFile);
+    if (!Buffer)
+      return false;
+    AllSymbols = ReadSymbolInfosFromYAML(Buffer.get()->getBuffer());
+  }
+  for (const auto &Symbol : AllSymbols)
+    Symbols[Symbol.Symbol] += Symbol.Signals;
+  return true;
+}
+
+/// \brief Returns the path of the file storing the symbols \p File
+/// contributed to the database.
+std::string GetContributionPath(StringRef StateDir, StringRef File) {
+  SmallString<128> Path = StateDir;
+  llvm::sys::path::append(Path, GetDigest(File) + ".yaml");
+  return Path.str();
+}
+
+/// \brief Removes the symbols \p File contributed from \p Database. The file
+/// storing them is kept until the new manifest is written.
+void RemoveContribution(StringRef StateDir, StringRef File,
+                        SymbolInfo::SignalMap &Database) {
+  std::string Path = GetContributionPath(StateDir, File);
+  auto Buffer = llvm::MemoryBuffer::getFile(Path);
+  if (!Buffer)
+    return;
+  for (const auto &Symbol :
+       ReadSymbolInfosFromYAML(Buffer.get()->getBuffer())) {
+    auto I = Database.find(Symbol.Symbol);
+    if (I == Database.end())
+      continue;
+    SymbolInfo::Signals &Signals = I->second;
+    Signals.Seen -= std::min(Signals.Seen, Symbol.Signals.Seen);
+    Signals.Used -= std::min(Signals.Used, Symbol.Signals.Used);
+    if (Signals.Seen == 0 && Signals.Used == 0)
+      Database.erase(I);
+  }
+}
+
+bool UpdateIncrementally(const CompilationDatabase &Compilations,
+                         ArrayRef<std::string> Files, StringRef StateDir,
+                         unsigned NumThreads) {
+  if (std::error_code EC = llvm::sys::fs::create_directories(StateDir)) {
+    llvm::errs() << "Can't create '" << StateDir << "': " << EC.message()
+                 << "\n";
+    return false;
+  }
+  SmallString<128> ManifestPath = StateDir;
+  llvm::sys::path::append(ManifestPath, "manifest.yaml");
+
+  // The manifest only describes the database if both were written by the
+  // previous run. Otherwise, start from scratch.
+  std::map<std::string, std::vector<FileDigest>> Manifest;
+  SymbolInfo::SignalMap Database;
+  std::string DatabaseFile = GetDatabasePath();
+  if (auto Buffer = llvm::MemoryBuffer::getFile(ManifestPath)) {
+    std::vector<SourceFileState> States;
+    llvm::yaml::Input YAML(Buffer.get()->getBuffer());
+    YAML >> States;
+    if (!YAML.error() && ReadDatabase(DatabaseFile, Database)) {
+      for (auto &State : States)
+        Manifest[State.File] = std::move(State.Dependencies);
+    } else {
+      Database.clear();
     }
+  }
+
+  // A file is stale if it is new or any file it was built from changed.
+  std::set<std::string> Wanted;
+  for (const std::string &File : Files)
+    Wanted.insert(GetSourceFileKey(File));
+  llvm::StringMap<std::string> Digests;
+  auto IsUpToDate = [&](const std::vector<FileDigest> &Dependencies) {
+    for (const FileDigest &Dependency : Dependencies) {
+      auto Inserted =
+          Digests.insert(std::make_pair(Dependency.Path, std::string()));
+      if (Inserted.second) {
+        auto Buffer = llvm::MemoryBuffer::getFile(Dependency.Path);
+        if (Buffer)
+          Inserted.first->second = GetDigest(Buffer.get()->getBuffer());
+      }
+      if (Inserted.first->second != Dependency.Hash)
+        return false;
+    }
+    return true;
   };
+  std::vector<std::string> Stale;
+  for (const std::string &File : Wanted) {
+    auto I = Manifest.find(File);
+    if (I == Manifest.end() || !IsUpToDate(I->second))
+      Stale.push_back(File);
+  }
 
-  // Load all symbol files in MergeDir.
-  {
-    llvm::ThreadPool Pool;
-    for (llvm::sys::fs::directory_iterator Dir(MergeDir, EC), DirEnd;
-         Dir != DirEnd && !EC; Dir.increment(EC)) {
-      // Parse YAML files in parallel.
-      Pool.async(
-          [&AddSymbols](std::string Path) {
-            auto Buffer = llvm::MemoryBuffer::getFile(Path);
-            if (!Buffer) {
-              llvm::errs() << "Can't open " << Path << "\n";
-              return;
-            }
-            std::vector<SymbolAndSignals> Symbols =
-                ReadSymbolInfosFromYAML(Buffer.get()->getBuffer());
-            for (auto &Symbol : Symbols) {
-              // Only count one occurrence per file, to avoid spam.
-              Symbol.Signals.Seen = std::min(Symbol.Signals.Seen, 1u);
-              Symbol.Signals.Used = std::min(Symbol.Signals.Used, 1u);
-            }
-            // FIXME: Merge without creating such a heavy contention point.
-            AddSymbols(Symbols);
-          },
-          Dir->path());
+  // Remove the symbols of stale and removed files from the database.
+  std::set<std::string> StaleSet(Stale.begin(), Stale.end());
+  std::vector<std::string> Removed;
+  for (auto I = Manifest.begin(); I != Manifest.end();) {
+    if (Wanted.count(I->first) && !StaleSet.count(I->first)) {
+      ++I;
+      continue;
     }
+    RemoveContribution(StateDir, I->first, Database);
+    Removed.push_back(I->first);
+    I = Manifest.erase(I);
   }
 
-  llvm::raw_fd_ostream OS(OutputFile, EC, llvm::sys::fs::F_None);
+  SourceFileCollector Collector;
+  HeaderSymbolCache Cache;
+  DependencyCollectingActionFactory Factory(
+      Collector, CacheHeaderSymbols ? &Cache : nullptr);
+  bool Success = RunInParallel(Compilations, Stale, NumThreads,
+                               [&](unsigned) { return &Factory; });
+
+  // Add the symbols of the indexed files and remember what they contributed.
+  // Files which failed to index or whose contribution couldn't be written are
+  // left out of the database and the manifest, so that they are indexed again
+  // by the next run.
+  for (auto &Indexed : Collector.Files) {
+    const std::string &File = Indexed.first;
+    SourceFileCollector::SourceFile &Result = Indexed.second;
+    if (Result.Dependencies.empty()) {
+      Success = false;
+      continue;
+    }
+    std::error_code EC;
+    llvm::raw_fd_ostream OS(GetContributionPath(StateDir, File), EC,
+                            llvm::sys::fs::F_None);
+    if (EC) {
+      llvm::errs() << "Can't write the symbols of '" << File
+                   << "': " << EC.message() << "\n";
+      Success = false;
+      continue;
+    }
+    WriteSymbolInfosToStream(OS, Result.Symbols);
+    OS.close();
+    if (OS.has_error()) {
+      llvm::errs() << "Can't write the symbols of '" << File << "'\n";
+      OS.clear_error();
+      Success = false;
+      continue;
+    }
+    for (const auto &Symbol : Result.Symbols)
+      Database[Symbol.first] += Symbol.second;
+    Manifest[File] = std::move(Result.Dependencies);
+  }
+
+  std::vector<SymbolInfo::SignalMap> Shards(1);
+  Shards[0] = std::move(Database);
+  if (!WriteDatabase(DatabaseFile, Shards))
+    return false;
+
+  std::error_code EC;
+  llvm::raw_fd_ostream OS(ManifestPath, EC, llvm::sys::fs::F_None);
   if (EC) {
-    llvm::errs() << "Can't open '" << OutputFile << "': " << EC.message()
-                 << '\n';
+    llvm::errs() << "Can't open '" << ManifestPath << "': " << EC.message()
+                 << "\n";
     return false;
   }
-  WriteSymbolInfosToStream(OS, Symbols);
-  return true;
+  std::vector<SourceFileState> States;
+  for (auto &Entry : Manifest)
+    States.push_back({Entry.first, std::move(Entry.second)});
+  llvm::yaml::Output YAML(OS);
+  YAML << States;
+  OS.close();
+  if (OS.has_error()) {
+    llvm::errs() << "Can't write '" << ManifestPath << "'\n";
+    OS.clear_error();
+    return false;
+  }
+
+  // The previous manifest referred to the contributions of the removed files
+  // until now. Those of files indexed again were overwritten instead.
+  for (const std::string &File : Removed)
+    if (!Manifest.count(File))
+      llvm::sys::fs::remove(GetContributionPath(StateDir, File));
+  return Success;
 }
 
 } // namespace clang
 } // namespace find_all_symbols
 
 int main(int argc, const char **argv) {
-  CommonOptionsParser OptionsParser(argc, argv, FindAllSymbolsCategory);
+  CommonOptionsParser OptionsParser(argc, argv, FindAllSymbolsCategory,
+                                    cl::ZeroOrMore);
   ClangTool Tool(OptionsParser.getCompilations(),
                  OptionsParser.getSourcePathList());
 
   std::vector<std::string> sources = OptionsParser.getSourcePathList();
+  if ((Jobs.getNumOccurrences() || !IncrementalDir.empty()) &&
+      MergeDir.empty() && Convert.empty()) {
+    if (sources.empty())
+      sources = OptionsParser.getCompilations().getAllFiles();
+    unsigned NumThreads = Jobs;
+    if (NumThreads == 0)
+      NumThreads = std::max(1u, llvm::heavyweight_hardware_concurrency());
+    bool Success =
+        IncrementalDir.empty()
+            ? clang::find_all_symbols::IndexInParallel(
+                  OptionsParser.getCompilations(), sources, NumThreads)
+            : clang::find_all_symbols::UpdateIncrementally(
+                  OptionsParser.getCompilations(), sources, IncrementalDir,
+                  NumThreads);
+    return Success ? 0 : 1;
+  }
   if (sources.empty()) {
     llvm::errs() << "Must specify at least one one source file.\n";
     return 1;
@@ -142,11 +715,16 @@ int main(int argc, const char **argv) {
     clang::find_all_symbols::Merge(MergeDir, sources[0]);
     return 0;
   }
+  if (!Convert.empty())
+    return clang::find_all_symbols::ConvertDatabase(Convert, sources[0]) ? 0
+                                                                        : 1;
 
   clang::find_all_symbols::YamlReporter Reporter;
+  clang::find_all_symbols::HeaderSymbolCache Cache;
 
   auto Factory =
       llvm::make_unique<clang::find_all_symbols::FindAllSymbolsActionFactory>(
-          &Reporter, clang::find_all_symbols::getSTLPostfixHeaderMap());
+          &Reporter, clang::find_all_symbols::getSTLPostfixHeaderMap(),
+          CacheHeaderSymbols ? &Cache : nullptr);
   return Tool.run(Factory.get());
 }
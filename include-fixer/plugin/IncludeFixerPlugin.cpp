@@ -7,6 +7,7 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include "../BinarySymbolIndex.h"
 #include "../IncludeFixer.h"
 #include "../YamlSymbolIndex.h"
 #include "clang/Frontend/CompilerInstance.h"
@@ -62,6 +63,28 @@ public:
     }
 
     std::string InputFile = CI.getFrontendOpts().Inputs[0].getFile();
+    if (DB == "binary") {
+      SymbolIndexMgr->addSymbolIndex(
+          [=]() -> std::unique_ptr<include_fixer::SymbolIndex> {
+            llvm::ErrorOr<std::unique_ptr<include_fixer::BinarySymbolIndex>>
+                SymbolIdx(nullptr);
+            if (!Input.empty()) {
+              SymbolIdx =
+                  include_fixer::BinarySymbolIndex::createFromFile(Input);
+            } else {
+              SmallString<128> AbsolutePath(
+                  tooling::getAbsolutePath(InputFile));
+              StringRef Directory = llvm::sys::path::parent_path(AbsolutePath);
+              SymbolIdx = include_fixer::BinarySymbolIndex::createFromDirectory(
+                  Directory, "find_all_symbols_db.bin");
+            }
+            if (!SymbolIdx)
+              return nullptr;
+            return std::move(*SymbolIdx);
+          });
+      return true;
+    }
+
     auto CreateYamlIdx = [=]() -> std::unique_ptr<include_fixer::SymbolIndex> {
       llvm::ErrorOr<std::unique_ptr<include_fixer::YamlSymbolIndex>> SymbolIdx(
           nullptr);
@@ -7,6 +7,7 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include "BinarySymbolIndex.h"
 #include "FuzzySymbolIndex.h"
 #include "InMemorySymbolIndex.h"
 #include "IncludeFixer.h"
@@ -19,14 +20,33 @@
 #include "clang/Tooling/CommonOptionsParser.h"
 #include "clang/Tooling/Core/Replacement.h"
 #include "clang/Tooling/Tooling.h"
+#include "llvm/ADT/StringMap.h"
+#include "llvm/Support/Chrono.h"
 #include "llvm/Support/CommandLine.h"
+#include "llvm/Support/FileSystem.h"
 #include "llvm/Support/Path.h"
 #include "llvm/Support/YAMLTraits.h"
+#include <iostream>
+#include <string>
 
 using namespace clang;
 using namespace llvm;
 using clang::include_fixer::IncludeFixerContext;
 
+namespace {
+/// A request to the include-fixer server.
+struct ServerRequest {
+  /// Either "query" or "insert".
+  std::string Command;
+  /// The file the code belongs to.
+  std::string FilePath;
+  /// The size of the code following the request.
+  unsigned Size = 0;
+  /// The header to insert for an "insert" request.
+  IncludeFixerContext Context;
+};
+} // namespace
+
 LLVM_YAML_IS_DOCUMENT_LIST_VECTOR(IncludeFixerContext)
 LLVM_YAML_IS_FLOW_SEQUENCE_VECTOR(IncludeFixerContext::HeaderInfo)
 LLVM_YAML_IS_FLOW_SEQUENCE_VECTOR(IncludeFixerContext::QuerySymbolInfo)
@@ -76,6 +96,15 @@ template <> struct MappingTraits<IncludeFixerContext> {
     IO.mapRequired("FilePath", Context.FilePath);
   }
 };
+
+template <> struct MappingTraits<ServerRequest> {
+  static void mapping(IO &IO, ServerRequest &Request) {
+    IO.mapRequired("Command", Request.Command);
+    IO.mapRequired("FilePath", Request.FilePath);
+    IO.mapRequired("Size", Request.Size);
+    IO.mapOptional("Context", Request.Context);
+  }
+};
 } // namespace yaml
 } // namespace llvm
 
@@ -86,13 +115,15 @@ enum DatabaseFormatTy {
   fixed,     ///< Hard-coded mapping.
   yaml,      ///< Yaml database created by find-all-symbols.
   fuzzyYaml, ///< Yaml database with fuzzy-matched identifiers.
+  binary,    ///< Binary database created by find-all-symbols.
 };
 
 cl::opt<DatabaseFormatTy> DatabaseFormat(
     "db", cl::desc("Specify input format"),
     cl::values(clEnumVal(fixed, "Hard-coded mapping"),
                clEnumVal(yaml, "Yaml database created by find-all-symbols"),
-               clEnumVal(fuzzyYaml, "Yaml database, with fuzzy-matched names")),
+               clEnumVal(fuzzyYaml, "Yaml database, with fuzzy-matched names"),
+               clEnumVal(binary, "Binary database created by find-all-symbols")),
     cl::init(yaml), cl::cat(IncludeFixerCategory));
 
 cl::opt<std::string> Input("input",
@@ -152,6 +183,22 @@ cl::opt<std::string> InsertHeader(
              "                     QualifiedName: \"a::foo\"} ]}\""),
     cl::init(""), cl::cat(IncludeFixerCategory));
 
+cl::opt<bool> ServerMode(
+    "server",
+    cl::desc("Keep the symbol database loaded and answer requests from\n"
+             "<stdin> until it is closed. The preambles of recently queried\n"
+             "files are kept as well. Each request is a line of JSON,\n"
+             "followed by the code of the file:\n"
+             "  {\"Command\": \"query\", \"FilePath\": \"/path/to/foo.cc\",\n"
+             "   \"Size\": <size of the code in bytes>}\n"
+             "The result of -output-headers is returned for a \"query\".\n"
+             "An \"insert\" request carries a \"Context\" like\n"
+             "-insert-header, and the changed code is returned. Each\n"
+             "response is a line of JSON followed by the result:\n"
+             "  {\"Status\": \"ok\" or \"error\",\n"
+             "   \"Size\": <size of the result in bytes>}"),
+    cl::init(false), cl::cat(IncludeFixerCategory));
+
 cl::opt<std::string>
     Style("style",
           cl::desc("Fallback style for reformatting after inserting new\n"
@@ -232,6 +279,33 @@ createSymbolIndexManager(StringRef FilePath) {
         });
     break;
   }
+  case binary: {
+    auto CreateBinaryIdx =
+        [=]() -> std::unique_ptr<include_fixer::SymbolIndex> {
+      llvm::ErrorOr<std::unique_ptr<include_fixer::BinarySymbolIndex>> DB(
+          nullptr);
+      if (!Input.empty()) {
+        DB = include_fixer::BinarySymbolIndex::createFromFile(Input);
+      } else {
+        // If we don't have any input file, look in the directory of the first
+        // file and its parents.
+        SmallString<128> AbsolutePath(tooling::getAbsolutePath(FilePath));
+        StringRef Directory = llvm::sys::path::parent_path(AbsolutePath);
+        DB = include_fixer::BinarySymbolIndex::createFromDirectory(
+            Directory, "find_all_symbols_db.bin");
+      }
+
+      if (!DB) {
+        llvm::errs() << "Couldn't find binary db: " << DB.getError().message()
+                     << '\n';
+        return nullptr;
+      }
+      return std::move(*DB);
+    };
+
+    SymbolIndexMgr->addSymbolIndex(std::move(CreateBinaryIdx));
+    break;
+  }
   }
   return SymbolIndexMgr;
 }
@@ -263,8 +337,164 @@ void writeToJson(llvm::raw_ostream &OS, const IncludeFixerContext& Context) {
   OS << "}\n";
 }
 
+/// Inserts the header of \p Context into \p Code and returns the changed code.
+llvm::Expected<std::string> insertHeader(StringRef Code,
+                                         const IncludeFixerContext &Context) {
+  const auto &HeaderInfos = Context.getHeaderInfos();
+  // We only accept one unique header.
+  // Check all elements in HeaderInfos have the same header.
+  bool IsUniqueHeader =
+      !HeaderInfos.empty() &&
+      std::equal(HeaderInfos.begin() + 1, HeaderInfos.end(),
+                 HeaderInfos.begin(),
+                 [](const IncludeFixerContext::HeaderInfo &LHS,
+                    const IncludeFixerContext::HeaderInfo &RHS) {
+                   return LHS.Header == RHS.Header;
+                 });
+  if (!IsUniqueHeader)
+    return llvm::make_error<llvm::StringError>(
+        "Expect exactly one unique header.", llvm::inconvertibleErrorCode());
+
+  // If a header has multiple symbols, we won't add the missing namespace
+  // qualifiers because we don't know which one is exactly used.
+  //
+  // Check whether all elements in HeaderInfos have the same qualified name.
+  bool IsUniqueQualifiedName = std::equal(
+      HeaderInfos.begin() + 1, HeaderInfos.end(), HeaderInfos.begin(),
+      [](const IncludeFixerContext::HeaderInfo &LHS,
+         const IncludeFixerContext::HeaderInfo &RHS) {
+        return LHS.QualifiedName == RHS.QualifiedName;
+      });
+  auto InsertStyle = format::getStyle("file", Context.getFilePath(), Style);
+  if (!InsertStyle)
+    return InsertStyle.takeError();
+  auto Replacements = clang::include_fixer::createIncludeFixerReplacements(
+      Code, Context, *InsertStyle,
+      /*AddQualifiers=*/IsUniqueQualifiedName);
+  if (!Replacements)
+    return llvm::make_error<llvm::StringError>(
+        "Failed to create replacements: " +
+            llvm::toString(Replacements.takeError()),
+        llvm::inconvertibleErrorCode());
+
+  return tooling::applyAllReplacements(Code, *Replacements);
+}
+
+/// Returns the path of the symbol database file used for \p FilePath, or an
+/// empty string if there is none.
+std::string getDatabasePath(StringRef FilePath) {
+  if (DatabaseFormat == fixed)
+    return "";
+  if (!Input.empty())
+    return Input;
+  StringRef DatabaseName = DatabaseFormat == yaml ? "find_all_symbols_db.yaml"
+                                                  : "find_all_symbols_db.bin";
+  SmallString<128> AbsolutePath(tooling::getAbsolutePath(FilePath));
+  for (StringRef Parent = llvm::sys::path::parent_path(AbsolutePath);
+       !Parent.empty(); Parent = llvm::sys::path::parent_path(Parent)) {
+    SmallString<128> Path = Parent;
+    llvm::sys::path::append(Path, DatabaseName);
+    if (llvm::sys::fs::exists(Path))
+      return Path.str();
+  }
+  return "";
+}
+
+void writeResponse(bool Success, StringRef Result) {
+  llvm::outs() << "{\"Status\": \"" << (Success ? "ok" : "error")
+               << "\", \"Size\": " << Result.size() << "}\n"
+               << Result;
+  llvm::outs().flush();
+}
+
+/// Answers the requests read from stdin, see -server.
+int runServer(const tooling::CompilationDatabase &Compilations) {
+  include_fixer::IncludeFixerPreambleCache Preambles;
+  // Each symbol database is loaded for the first file using it, and again
+  // once the database file is modified. Files without database share the
+  // empty path.
+  struct LoadedDatabase {
+    std::unique_ptr<include_fixer::SymbolIndexManager> SymbolIndexMgr;
+    llvm::sys::TimePoint<> ModificationTime;
+  };
+  llvm::StringMap<LoadedDatabase> Databases;
+
+  std::string Line;
+  while (std::getline(std::cin, Line)) {
+    if (Line.empty())
+      continue;
+    ServerRequest Request;
+    llvm::yaml::Input YAML(Line);
+    YAML >> Request;
+    if (YAML.error()) {
+      // Without the size of the code, we can't find the next request.
+      writeResponse(/*Success=*/false, "Invalid request: " + Line);
+      return 1;
+    }
+    std::string Code(Request.Size, '\0');
+    if (!std::cin.read(&Code[0], Request.Size)) {
+      writeResponse(/*Success=*/false, "Unexpected end of input");
+      return 1;
+    }
+
+    std::string FilePath = tooling::getAbsolutePath(Request.FilePath);
+    if (Request.Command == "insert") {
+      auto ChangedCode = insertHeader(Code, Request.Context);
+      if (!ChangedCode)
+        writeResponse(/*Success=*/false,
+                      llvm::toString(ChangedCode.takeError()));
+      else
+        writeResponse(/*Success=*/true, *ChangedCode);
+      continue;
+    }
+    if (Request.Command != "query") {
+      writeResponse(/*Success=*/false, "Unknown command: " + Request.Command);
+      continue;
+    }
+
+    std::string DatabasePath = getDatabasePath(FilePath);
+    llvm::sys::TimePoint<> ModificationTime;
+    llvm::sys::fs::file_status Status;
+    if (!DatabasePath.empty() && !llvm::sys::fs::status(DatabasePath, Status))
+      ModificationTime = Status.getLastModificationTime();
+    LoadedDatabase &Database = Databases[DatabasePath];
+    if (!Database.SymbolIndexMgr ||
+        Database.ModificationTime != ModificationTime) {
+      Database.SymbolIndexMgr = createSymbolIndexManager(FilePath);
+      Database.ModificationTime = ModificationTime;
+    }
+    include_fixer::SymbolIndexManager *SymbolIndexMgr =
+        Database.SymbolIndexMgr.get();
+
+    tooling::ClangTool Tool(Compilations, FilePath);
+    Tool.mapVirtualFile(FilePath, Code);
+    std::vector<IncludeFixerContext> Contexts;
+    include_fixer::IncludeFixerActionFactory Factory(
+        *SymbolIndexMgr, Contexts, Style, MinimizeIncludePaths, &Preambles);
+    if (Tool.run(&Factory) != 0) {
+      writeResponse(/*Success=*/false,
+                    "Fatal compiler error occurred while parsing file!");
+      continue;
+    }
+    assert(!Contexts.empty());
+    std::string Result;
+    llvm::raw_string_ostream OS(Result);
+    writeToJson(OS, Contexts.front());
+    writeResponse(/*Success=*/true, OS.str());
+  }
+  return 0;
+}
+
 int includeFixerMain(int argc, const char **argv) {
-  tooling::CommonOptionsParser options(argc, argv, IncludeFixerCategory);
+  tooling::CommonOptionsParser options(argc, argv, IncludeFixerCategory,
+                                       cl::ZeroOrMore);
+  if (ServerMode)
+    return runServer(options.getCompilations());
+  if (options.getSourcePathList().empty()) {
+    errs() << "Must specify at least one source file.\n";
+    return 1;
+  }
+
   tooling::ClangTool tool(options.getCompilations(),
                           options.getSourcePathList());
 
@@ -299,47 +529,7 @@ int includeFixerMain(int argc, const char **argv) {
     IncludeFixerContext Context;
     yin >> Context;
 
-    const auto &HeaderInfos = Context.getHeaderInfos();
-    assert(!HeaderInfos.empty());
-    // We only accept one unique header.
-    // Check all elements in HeaderInfos have the same header.
-    bool IsUniqueHeader = std::equal(
-        HeaderInfos.begin()+1, HeaderInfos.end(), HeaderInfos.begin(),
-        [](const IncludeFixerContext::HeaderInfo &LHS,
-           const IncludeFixerContext::HeaderInfo &RHS) {
-          return LHS.Header == RHS.Header;
-        });
-    if (!IsUniqueHeader) {
-      errs() << "Expect exactly one unique header.\n";
-      return 1;
-    }
-
-    // If a header has multiple symbols, we won't add the missing namespace
-    // qualifiers because we don't know which one is exactly used.
-    //
-    // Check whether all elements in HeaderInfos have the same qualified name.
-    bool IsUniqueQualifiedName = std::equal(
-        HeaderInfos.begin() + 1, HeaderInfos.end(), HeaderInfos.begin(),
-        [](const IncludeFixerContext::HeaderInfo &LHS,
-           const IncludeFixerContext::HeaderInfo &RHS) {
-          return LHS.QualifiedName == RHS.QualifiedName;
-        });
-    auto InsertStyle = format::getStyle("file", Context.getFilePath(), Style);
-    if (!InsertStyle) {
-      llvm::errs() << llvm::toString(InsertStyle.takeError()) << "\n";
-      return 1;
-    }
-    auto Replacements = clang::include_fixer::createIncludeFixerReplacements(
-        Code->getBuffer(), Context, *InsertStyle,
-        /*AddQualifiers=*/IsUniqueQualifiedName);
-    if (!Replacements) {
-      errs() << "Failed to create replacements: "
-             << llvm::toString(Replacements.takeError()) << "\n";
-      return 1;
-    }
-
-    auto ChangedCode =
-        tooling::applyAllReplacements(Code->getBuffer(), *Replacements);
+    auto ChangedCode = insertHeader(Code->getBuffer(), Context);
     if (!ChangedCode) {
       llvm::errs() << llvm::toString(ChangedCode.takeError()) << "\n";
       return 1;
@@ -0,0 +1,17 @@
+// RUN: clang-tidy -checks='-*,modernize-pass-by-value,readability-function-size' -config='{}' -dump-config - -- | FileCheck %s -check-prefix=CHECK-DEFAULT
+// CHECK-DEFAULT: {{- key: *modernize-pass-by-value.IncludeStyle}}
+// CHECK-DEFAULT-NEXT: {{value: *llvm}}
+// CHECK-DEFAULT: {{- key: *readability-function-size.StatementThreshold}}
+// CHECK-DEFAULT-NEXT: {{value: *'800'}}
+
+// RUN: clang-tidy -checks='-*,modernize-pass-by-value,readability-function-size' -config='{CheckOptions: [{key: readability-function-size.StatementThreshold, value: 10}]}' -dump-config - -- | FileCheck %s -check-prefix=CHECK-LOCAL
+// CHECK-LOCAL: {{- key: *modernize-pass-by-value.IncludeStyle}}
+// CHECK-LOCAL-NEXT: {{value: *llvm}}
+// CHECK-LOCAL: {{- key: *readability-function-size.StatementThreshold}}
+// CHECK-LOCAL-NEXT: {{value: *'10'}}
+
+// RUN: clang-tidy -checks='-*,modernize-pass-by-value,readability-function-size' -config='{CheckOptions: [{key: IncludeStyle, value: google}]}' -dump-config - -- | FileCheck %s -check-prefix=CHECK-GLOBAL
+// CHECK-GLOBAL: {{- key: *modernize-pass-by-value.IncludeStyle}}
+// CHECK-GLOBAL-NEXT: {{value: *google}}
+// CHECK-GLOBAL: {{- key: *readability-function-size.StatementThreshold}}
+// CHECK-GLOBAL-NEXT: {{value: *'800'}}
@@ -0,0 +1,48 @@
+// RUN: rm -rf %t.dir
+// RUN: mkdir -p %t.dir
+// RUN: echo 'class A { A(int); };' > %t.dir/a.cpp
+// RUN: echo 'class B { B(int); };' > %t.dir/b.cpp
+// RUN: echo 'class C { C(int); };' > %t.dir/c.cpp
+// RUN: clang-tidy -checks='-*,google-explicit-constructor' -export-fixes=%t.dir/fixes.yaml %t.dir/a.cpp %t.dir/b.cpp %t.dir/c.cpp -- 2>&1 | FileCheck -check-prefix=CHECK-MESSAGES %s
+// RUN: FileCheck -input-file=%t.dir/fixes.yaml -check-prefix=CHECK-YAML %s
+// RUN: clang-apply-replacements %t.dir
+// RUN: FileCheck -input-file=%t.dir/b.cpp -check-prefix=CHECK-B %s
+// RUN: FileCheck -input-file=%t.dir/c.cpp -check-prefix=CHECK-C %s
+// RUN: echo 'class D { D(int); };' > %t.dir/d.cpp
+// RUN: echo 'class E { E(int); } // error' > %t.dir/e.cpp
+// RUN: clang-tidy -checks='-*,google-explicit-constructor' -fix %t.dir/d.cpp %t.dir/e.cpp -- 2>&1 | FileCheck -check-prefix=CHECK-DROPPED %s -implicit-check-not='FIX-IT applied'
+// RUN: FileCheck -input-file=%t.dir/d.cpp -check-prefix=CHECK-D %s
+// RUN: FileCheck -input-file=%t.dir/e.cpp -check-prefix=CHECK-E %s
+
+// The diagnostics of each translation unit are exported to a separate document
+// as soon as it is analyzed.
+// CHECK-MESSAGES: a.cpp:1:11: warning: single-argument constructors must be marked explicit
+// CHECK-MESSAGES: b.cpp:1:11: warning: single-argument constructors must be marked explicit
+// CHECK-MESSAGES: c.cpp:1:11: warning: single-argument constructors must be marked explicit
+// CHECK-YAML: ---
+// CHECK-YAML-NEXT: MainSourceFile: {{.*}}a.cpp
+// CHECK-YAML-NEXT: Diagnostics:
+// CHECK-YAML-NEXT:   - DiagnosticName: google-explicit-constructor
+// CHECK-YAML: FilePath: {{.*}}a.cpp
+// CHECK-YAML: ReplacementText: 'explicit '
+// CHECK-YAML: ...
+// CHECK-YAML-NEXT: ---
+// CHECK-YAML:   - DiagnosticName: google-explicit-constructor
+// CHECK-YAML: FilePath: {{.*}}b.cpp
+// CHECK-YAML: ...
+// CHECK-YAML-NEXT: ---
+// CHECK-YAML:   - DiagnosticName: google-explicit-constructor
+// CHECK-YAML: FilePath: {{.*}}c.cpp
+// CHECK-YAML: ...
+// CHECK-YAML-NOT: ---
+// CHECK-B: {{^}}class B { explicit B(int); };{{$}}
+// CHECK-C: {{^}}class C { explicit C(int); };{{$}}
+
+// Only the fixes of e.cpp are dropped because of its compiler error, the fixes
+// of d.cpp are still applied.
+// CHECK-DROPPED: d.cpp:1:11: warning: single-argument constructors must be marked explicit
+// CHECK-DROPPED: d.cpp:1:11: note: FIX-IT applied suggested code changes
+// CHECK-DROPPED: e.cpp:1:11: warning: single-argument constructors must be marked explicit
+// CHECK-DROPPED: Fixes of translation units with compiler errors have NOT been applied.
+// CHECK-D: {{^}}class D { explicit D(int); };{{$}}
+// CHECK-E: {{^}}class E { E(int); } // error{{$}}
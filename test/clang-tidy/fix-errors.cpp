@@ -9,7 +9,7 @@
 
 class A { A(int i); }
 // CHECK-FIX: class A { A(int i); }{{$}}
-// CHECK-MESSAGES: Fixes have NOT been applied.
+// CHECK-MESSAGES: Fixes of translation units with compiler errors have NOT been applied.
 // CHECK-FIX2: class A { explicit A(int i); };
 // CHECK-MESSAGES2: note: FIX-IT applied suggested code changes
 // CHECK-MESSAGES2: clang-tidy applied 2 of 2 suggested fixes.
@@ -0,0 +1,30 @@
+// RUN: %check_clang_tidy %s modernize-make-unique %t -- \
+// RUN:   -config="{CheckOptions: \
+// RUN:     [{key: modernize-make-unique.MakeSmartPtrFunctionHeader, \
+// RUN:       value: 'initializer_list.h'}]}" \
+// RUN:   -matching-jobs=3 -- -std=c++11 -I%S/Inputs/modernize-smart-ptr
+
+// The header of the make function is already included, it must not be
+// inserted again when the translation unit is matched in chunks.
+#include "unique_ptr.h"
+#include "initializer_list.h"
+// CHECK-FIXES: {{^}}#include "initializer_list.h"{{$}}
+// CHECK-FIXES-NOT: #include
+
+void f1() {
+  std::unique_ptr<int> P = std::unique_ptr<int>(new int());
+  // CHECK-MESSAGES: :[[@LINE-1]]:28: warning: use std::make_unique instead
+  // CHECK-FIXES: std::unique_ptr<int> P = std::make_unique<int>();
+}
+
+void f2() {
+  std::unique_ptr<int> P = std::unique_ptr<int>(new int());
+  // CHECK-MESSAGES: :[[@LINE-1]]:28: warning: use std::make_unique instead
+  // CHECK-FIXES: std::unique_ptr<int> P = std::make_unique<int>();
+}
+
+void f3() {
+  std::unique_ptr<int> P = std::unique_ptr<int>(new int());
+  // CHECK-MESSAGES: :[[@LINE-1]]:28: warning: use std::make_unique instead
+  // CHECK-FIXES: std::unique_ptr<int> P = std::make_unique<int>();
+}
@@ -0,0 +1,26 @@
+// RUN: %check_clang_tidy %s modernize-make-unique %t -- -matching-jobs=3 -- \
+// RUN:   -std=c++11 -I%S/Inputs/modernize-smart-ptr
+
+// Checks inserting headers are serial-only, the header is inserted once for
+// all chunks of the translation unit.
+#include "unique_ptr.h"
+// CHECK-FIXES: #include <memory>
+// CHECK-FIXES-NOT: #include <memory>
+
+void f1() {
+  std::unique_ptr<int> P = std::unique_ptr<int>(new int());
+  // CHECK-MESSAGES: :[[@LINE-1]]:28: warning: use std::make_unique instead
+  // CHECK-FIXES: std::unique_ptr<int> P = std::make_unique<int>();
+}
+
+void f2() {
+  std::unique_ptr<int> P = std::unique_ptr<int>(new int());
+  // CHECK-MESSAGES: :[[@LINE-1]]:28: warning: use std::make_unique instead
+  // CHECK-FIXES: std::unique_ptr<int> P = std::make_unique<int>();
+}
+
+void f3() {
+  std::unique_ptr<int> P = std::unique_ptr<int>(new int());
+  // CHECK-MESSAGES: :[[@LINE-1]]:28: warning: use std::make_unique instead
+  // CHECK-FIXES: std::unique_ptr<int> P = std::make_unique<int>();
+}
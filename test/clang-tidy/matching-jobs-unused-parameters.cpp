@@ -0,0 +1,24 @@
+// RUN: %check_clang_tidy %s misc-unused-parameters %t -- -matching-jobs=2 --
+
+// misc-unused-parameters finds the calls and references of each function in
+// the shared traversal, which only runs in the main process. Its fixes must
+// not depend on the chunk the function is matched in.
+static void removed(int i) {}
+// CHECK-MESSAGES: :[[@LINE-1]]:25: warning: parameter 'i' is unused
+// CHECK-FIXES: {{^}}static void removed() {}{{$}}
+
+static void addressTaken(int i) {}
+// CHECK-MESSAGES: :[[@LINE-1]]:30: warning: parameter 'i' is unused
+// CHECK-FIXES: {{^}}static void addressTaken(int  /*i*/) {}{{$}}
+
+void caller() {
+  removed(1);
+// CHECK-FIXES: {{^}}  removed();{{$}}
+}
+
+void (*Pointer)(int) = addressTaken;
+
+void other() {
+  caller();
+  caller();
+}
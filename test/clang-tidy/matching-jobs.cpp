@@ -0,0 +1,25 @@
+// RUN: clang-tidy %s -checks='-*,google-explicit-constructor,misc-unused-using-decls' -matching-jobs=3 -- 2>&1 | FileCheck %s -implicit-check-not='{{warning|error}}:'
+// RUN: not clang-tidy %s -checks='-*,google-explicit-constructor' -matching-jobs=2 -j=2 -- 2>&1 | FileCheck -check-prefix=CHECK-JOBS %s
+
+namespace n {
+class A { A(int); };
+// CHECK: :[[@LINE-1]]:11: warning: single-argument constructors must be marked explicit
+class B { B(int); };
+// CHECK: :[[@LINE-1]]:11: warning: single-argument constructors must be marked explicit
+void f();
+}
+
+class C { C(int); };
+// CHECK: :[[@LINE-1]]:11: warning: single-argument constructors must be marked explicit
+
+// misc-unused-using-decls is serial-only, it needs all uses in the translation
+// unit.
+using n::f;
+// CHECK: :[[@LINE-1]]:10: warning: using decl 'f' is unused
+
+extern "C" {
+class D { D(int); };
+// CHECK: :[[@LINE-1]]:11: warning: single-argument constructors must be marked explicit
+}
+
+// CHECK-JOBS: Error: -matching-jobs can't be combined with -j.
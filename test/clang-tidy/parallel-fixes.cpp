@@ -0,0 +1,22 @@
+// RUN: rm -rf %t.dir
+// RUN: mkdir -p %t.dir
+// RUN: echo 'class A { A(int); };' > %t.dir/header.h
+// RUN: echo '#include "header.h"' > %t.dir/a.cpp
+// RUN: echo 'class B { B(int); };' >> %t.dir/a.cpp
+// RUN: echo '#include "header.h"' > %t.dir/b.cpp
+// RUN: clang-tidy -checks='-*,google-explicit-constructor,hicpp-explicit-conversions' -header-filter='.*' -j=2 %t.dir/a.cpp %t.dir/b.cpp -- 2>&1 | FileCheck -check-prefix=CHECK-ALIASES %s
+// RUN: clang-tidy -checks='-*,google-explicit-constructor' -header-filter='.*' -j=2 -fix -export-fixes=%t.dir/fixes.yaml %t.dir/a.cpp %t.dir/b.cpp -- 2>&1 | FileCheck -check-prefix=CHECK-MESSAGES %s
+// RUN: FileCheck -input-file=%t.dir/header.h -check-prefix=CHECK-HEADER %s
+// RUN: FileCheck -input-file=%t.dir/a.cpp -check-prefix=CHECK-A %s
+// RUN: grep -c 'ReplacementText: .explicit ' %t.dir/fixes.yaml | FileCheck -check-prefix=CHECK-YAML %s
+
+// CHECK-MESSAGES-DAG: header.h:1:11: warning: single-argument constructors must be marked explicit
+// CHECK-MESSAGES-DAG: a.cpp:2:11: warning: single-argument constructors must be marked explicit
+// CHECK-MESSAGES-DAG: clang-tidy applied 2 of 2 suggested fixes.
+// CHECK-HEADER: {{^}}class A { explicit A(int); };{{$}}
+// CHECK-A: {{^}}class B { explicit B(int); };{{$}}
+// CHECK-YAML: {{^}}2{{$}}
+
+// Diagnostics of different checks at the same location are all kept.
+// CHECK-ALIASES-DAG: header.h:1:11: warning: single-argument constructors must be marked explicit {{.*}} [google-explicit-constructor]
+// CHECK-ALIASES-DAG: header.h:1:11: warning: single-argument constructors must be marked explicit {{.*}} [hicpp-explicit-conversions]
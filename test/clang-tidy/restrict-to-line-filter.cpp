@@ -0,0 +1,21 @@
+// RUN: clang-tidy -checks='-*,google-explicit-constructor' -line-filter='[{"name":"restrict-to-line-filter.cpp","lines":[[10,10]]}]' -restrict-to-line-filter %s -- 2>&1 | FileCheck %s
+// RUN: clang-tidy -checks='-*,google-explicit-constructor' -line-filter='[{"name":"restrict-to-line-filter.cpp","lines":[[10,10]]}]' %s -- 2>&1 | FileCheck -check-prefix=CHECK-ALL %s
+
+namespace n {
+class A { A(int); };
+// CHECK-NOT: :[[@LINE-1]]:{{.*}} warning
+// CHECK-ALL-NOT: :[[@LINE-2]]:{{.*}} warning
+
+class B {
+  B(int);
+// CHECK: :[[@LINE-1]]:3: warning: single-argument constructors must be marked explicit
+// CHECK-ALL: :[[@LINE-2]]:3: warning: single-argument constructors must be marked explicit
+};
+}
+
+class C { C(int); };
+// CHECK-NOT: warning:
+// CHECK-ALL-NOT: warning:
+
+// CHECK-NOT: Suppressed
+// CHECK-ALL: Suppressed 2 warnings (2 due to line filter)
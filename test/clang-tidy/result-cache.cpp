@@ -0,0 +1,23 @@
+// RUN: rm -rf %t.cache %t.dir
+// RUN: mkdir -p %t.dir
+// RUN: echo 'class A { A(int); };' > %t.dir/input.cpp
+// RUN: clang-tidy -checks='-*,google-explicit-constructor' -result-cache-dir=%t.cache %t.dir/input.cpp -- 2>&1 | FileCheck -check-prefix=CHECK-A %s
+// RUN: ls %t.cache | count 1
+// Change the message stored in the cache entry: the second run must replay it
+// instead of analyzing the file again.
+// RUN: sed -i.orig -e 's/must be marked explicit/were replayed from the cache/' %t.cache/*.yaml
+// RUN: rm %t.cache/*.orig
+// RUN: clang-tidy -checks='-*,google-explicit-constructor' -result-cache-dir=%t.cache %t.dir/input.cpp -- 2>&1 | FileCheck -check-prefix=CHECK-HIT %s
+// RUN: echo 'class B { B(int); };' > %t.dir/input.cpp
+// RUN: clang-tidy -checks='-*,google-explicit-constructor' -result-cache-dir=%t.cache %t.dir/input.cpp -- 2>&1 | FileCheck -check-prefix=CHECK-B %s
+// RUN: ls %t.cache | count 1
+// RUN: clang-tidy -checks='-*,google-explicit-constructor' -config='{CheckOptions: [{key: a, value: b}]}' -result-cache-dir=%t.cache %t.dir/input.cpp -- 2>&1 | FileCheck -check-prefix=CHECK-B %s
+// RUN: ls %t.cache | count 2
+
+// CHECK-A: input.cpp:1:11: warning: single-argument constructors must be marked explicit
+// CHECK-A-NOT: warning:
+// CHECK-HIT: input.cpp:1:11: warning: single-argument constructors were replayed from the cache
+// CHECK-HIT-NOT: warning:
+// CHECK-B: input.cpp:1:11: warning: single-argument constructors must be marked explicit
+// CHECK-B-NEXT: class B { B(int); };
+// CHECK-B-NOT: warning:
@@ -0,0 +1,3 @@
+#include "shared.h"
+
+parallel::Shared A;
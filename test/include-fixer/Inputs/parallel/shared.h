@@ -0,0 +1,3 @@
+namespace parallel {
+class Shared {};
+}
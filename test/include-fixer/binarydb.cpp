@@ -0,0 +1,9 @@
+// RUN: find-all-symbols -output-format=binary -convert=%p/Inputs/fake_yaml_db.yaml %t.bin
+// RUN: sed -e 's#//.*$##' %s > %t.cpp
+// RUN: clang-include-fixer -db=binary -input=%t.bin %t.cpp --
+// RUN: FileCheck %s -input-file=%t.cpp
+
+// CHECK: #include "foo.h"
+// CHECK: b::a::foo f;
+
+b::a::foo f;
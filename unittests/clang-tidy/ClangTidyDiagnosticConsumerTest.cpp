@@ -1,94 +1,192 @@
-#include "ClangTidy.h"
-#include "ClangTidyTest.h"
-#include "gtest/gtest.h"
-
-namespace clang {
-namespace tidy {
-namespace test {
-
-class TestCheck : public ClangTidyCheck {
-public:
-  TestCheck(StringRef Name, ClangTidyContext *Context)
-      : ClangTidyCheck(Name, Context) {}
-  void registerMatchers(ast_matchers::MatchFinder *Finder) override {
-    Finder->addMatcher(ast_matchers::varDecl().bind("var"), this);
-  }
-  void check(const ast_matchers::MatchFinder::MatchResult &Result) override {
-    const auto *Var = Result.Nodes.getNodeAs<VarDecl>("var");
-    // Add diagnostics in the wrong order.
-    diag(Var->getLocation(), "variable");
-    diag(Var->getTypeSpecStartLoc(), "type specifier");
-  }
-};
-
-TEST(ClangTidyDiagnosticConsumer, SortsErrors) {
-  std::vector<ClangTidyError> Errors;
-  runCheckOnCode<TestCheck>("int a;", &Errors);
-  EXPECT_EQ(2ul, Errors.size());
-  EXPECT_EQ("type specifier", Errors[0].Message.Message);
-  EXPECT_EQ("variable", Errors[1].Message.Message);
-}
-
-TEST(GlobList, Empty) {
-  GlobList Filter("");
-
-  EXPECT_TRUE(Filter.contains(""));
-  EXPECT_FALSE(Filter.contains("aaa"));
-}
-
-TEST(GlobList, Nothing) {
-  GlobList Filter("-*");
-
-  EXPECT_FALSE(Filter.contains(""));
-  EXPECT_FALSE(Filter.contains("a"));
-  EXPECT_FALSE(Filter.contains("-*"));
-  EXPECT_FALSE(Filter.contains("-"));
-  EXPECT_FALSE(Filter.contains("*"));
-}
-
-TEST(GlobList, Everything) {
-  GlobList Filter("*");
-
-  EXPECT_TRUE(Filter.contains(""));
-  EXPECT_TRUE(Filter.contains("aaaa"));
-  EXPECT_TRUE(Filter.contains("-*"));
-  EXPECT_TRUE(Filter.contains("-"));
-  EXPECT_TRUE(Filter.contains("*"));
-}
-
-TEST(GlobList, Simple) {
-  GlobList Filter("aaa");
-
-  EXPECT_TRUE(Filter.contains("aaa"));
-  EXPECT_FALSE(Filter.contains(""));
-  EXPECT_FALSE(Filter.contains("aa"));
-  EXPECT_FALSE(Filter.contains("aaaa"));
-  EXPECT_FALSE(Filter.contains("bbb"));
-}
-
-TEST(GlobList, WhitespacesAtBegin) {
-  GlobList Filter("-*,   a.b.*");
-
-  EXPECT_TRUE(Filter.contains("a.b.c"));
-  EXPECT_FALSE(Filter.contains("b.c"));
-}
-
-TEST(GlobList, Complex) {
-  GlobList Filter("*,-a.*, -b.*, \r  \n  a.1.* ,-a.1.A.*,-..,-...,-..+,-*$, -*qwe* ");
-
-  EXPECT_TRUE(Filter.contains("aaa"));
-  EXPECT_TRUE(Filter.contains("qqq"));
-  EXPECT_FALSE(Filter.contains("a."));
-  EXPECT_FALSE(Filter.contains("a.b"));
-  EXPECT_FALSE(Filter.contains("b."));
-  EXPECT_FALSE(Filter.contains("b.b"));
-  EXPECT_TRUE(Filter.contains("a.1.b"));
-  EXPECT_FALSE(Filter.contains("a.1.A.a"));
-  EXPECT_FALSE(Filter.contains("qwe"));
-  EXPECT_FALSE(Filter.contains("asdfqweasdf"));
-  EXPECT_TRUE(Filter.contains("asdfqwEasdf"));
-}
-
-} // namespace test
-} // namespace tidy
-} // namespace clang
+#include "ClangTidy.h"
+#include "ClangTidyTest.h"
+#include "gtest/gtest.h"
+
+namespace clang {
+namespace tidy {
+namespace test {
+
+class TestCheck : public ClangTidyCheck {
+public:
+  TestCheck(StringRef Name, ClangTidyContext *Context)
+      : ClangTidyCheck(Name, Context) {}
+  void registerMatchers(ast_matchers::MatchFinder *Finder) override {
+    Finder->addMatcher(ast_matchers::varDecl().bind("var"), this);
+  }
+  void check(const ast_matchers::MatchFinder::MatchResult &Result) override {
+    const auto *Var = Result.Nodes.getNodeAs<VarDecl>("var");
+    // Add diagnostics in the wrong order.
+    diag(Var->getLocation(), "variable");
+    diag(Var->getTypeSpecStartLoc(), "type specifier");
+  }
+};
+
+TEST(ClangTidyDiagnosticConsumer, SortsErrors) {
+  std::vector<ClangTidyError> Errors;
+  runCheckOnCode<TestCheck>("int a;", &Errors);
+  EXPECT_EQ(2ul, Errors.size());
+  EXPECT_EQ("type specifier", Errors[0].Message.Message);
+  EXPECT_EQ("variable", Errors[1].Message.Message);
+}
+
+static ClangTidyError makeError(ArrayRef<tooling::Replacement> Replacements) {
+  ClangTidyError Error("test-check", ClangTidyError::Warning, "",
+                       /*IsWarningAsError=*/false);
+  for (const tooling::Replacement &Replacement : Replacements) {
+    if (llvm::Error Err =
+            Error.Fix[Replacement.getFilePath()].add(Replacement))
+      ADD_FAILURE() << llvm::toString(std::move(Err));
+  }
+  return Error;
+}
+
+TEST(RemoveIncompatibleErrors, DifferentFiles) {
+  SmallVector<ClangTidyError, 2> Errors;
+  Errors.push_back(makeError(tooling::Replacement("a.cc", 0, 10, "x")));
+  Errors.push_back(makeError(tooling::Replacement("b.cc", 5, 10, "x")));
+  removeIncompatibleErrors(Errors);
+  EXPECT_EQ(1u, Errors[0].Fix.size());
+  EXPECT_EQ(1u, Errors[1].Fix.size());
+  EXPECT_TRUE(Errors[0].Notes.empty());
+  EXPECT_TRUE(Errors[1].Notes.empty());
+}
+
+TEST(RemoveIncompatibleErrors, PartialOverlap) {
+  SmallVector<ClangTidyError, 3> Errors;
+  Errors.push_back(makeError(tooling::Replacement("a.cc", 0, 10, "x")));
+  Errors.push_back(makeError(tooling::Replacement("a.cc", 5, 10, "x")));
+  Errors.push_back(makeError(tooling::Replacement("a.cc", 15, 10, "x")));
+  removeIncompatibleErrors(Errors);
+  EXPECT_TRUE(Errors[0].Fix.empty());
+  EXPECT_TRUE(Errors[1].Fix.empty());
+  EXPECT_EQ(1u, Errors[2].Fix.size());
+  EXPECT_EQ(1u, Errors[0].Notes.size());
+  EXPECT_EQ(1u, Errors[1].Notes.size());
+  EXPECT_TRUE(Errors[2].Notes.empty());
+}
+
+TEST(RemoveIncompatibleErrors, ContainedReplacement) {
+  SmallVector<ClangTidyError, 2> Errors;
+  Errors.push_back(makeError(tooling::Replacement("a.cc", 2, 2, "x")));
+  Errors.push_back(makeError({tooling::Replacement("a.cc", 0, 10, "x"),
+                              tooling::Replacement("b.cc", 0, 10, "x")}));
+  removeIncompatibleErrors(Errors);
+  EXPECT_TRUE(Errors[0].Fix.empty());
+  EXPECT_EQ(2u, Errors[1].Fix.size());
+}
+
+// Runs on one million non-overlapping replacements. Use
+// --gtest_also_run_disabled_tests to run it.
+TEST(RemoveIncompatibleErrors, DISABLED_MillionReplacements) {
+  const unsigned NumErrors = 100000;
+  const unsigned ReplacementsPerError = 10;
+  SmallVector<ClangTidyError, 0> Errors;
+  Errors.reserve(NumErrors);
+  for (unsigned I = 0; I < NumErrors; ++I) {
+    std::vector<tooling::Replacement> Replacements;
+    for (unsigned J = 0; J < ReplacementsPerError; ++J) {
+      // Interleave the replacements of different errors.
+      unsigned Offset = (J * NumErrors + I) * 4;
+      Replacements.emplace_back("a.cc", Offset, 2, "x");
+    }
+    Errors.push_back(makeError(Replacements));
+  }
+  removeIncompatibleErrors(Errors);
+  for (const ClangTidyError &Error : Errors)
+    EXPECT_EQ(ReplacementsPerError, Error.Fix.lookup("a.cc").size());
+}
+
+TEST(GlobList, Empty) {
+  GlobList Filter("");
+
+  EXPECT_TRUE(Filter.contains(""));
+  EXPECT_FALSE(Filter.contains("aaa"));
+}
+
+TEST(GlobList, Nothing) {
+  GlobList Filter("-*");
+
+  EXPECT_FALSE(Filter.contains(""));
+  EXPECT_FALSE(Filter.contains("a"));
+  EXPECT_FALSE(Filter.contains("-*"));
+  EXPECT_FALSE(Filter.contains("-"));
+  EXPECT_FALSE(Filter.contains("*"));
+}
+
+TEST(GlobList, Everything) {
+  GlobList Filter("*");
+
+  EXPECT_TRUE(Filter.contains(""));
+  EXPECT_TRUE(Filter.contains("aaaa"));
+  EXPECT_TRUE(Filter.contains("-*"));
+  EXPECT_TRUE(Filter.contains("-"));
+  EXPECT_TRUE(Filter.contains("*"));
+}
+
+TEST(GlobList, Simple) {
+  GlobList Filter("aaa");
+
+  EXPECT_TRUE(Filter.contains("aaa"));
+  EXPECT_FALSE(Filter.contains(""));
+  EXPECT_FALSE(Filter.contains("aa"));
+  EXPECT_FALSE(Filter.contains("aaaa"));
+  EXPECT_FALSE(Filter.contains("bbb"));
+}
+
+TEST(GlobList, WhitespacesAtBegin) {
+  GlobList Filter("-*,   a.b.*");
+
+  EXPECT_TRUE(Filter.contains("a.b.c"));
+  EXPECT_FALSE(Filter.contains("b.c"));
+}
+
+TEST(GlobList, Complex) {
+  GlobList Filter("*,-a.*, -b.*, \r  \n  a.1.* ,-a.1.A.*,-..,-...,-..+,-*$, -*qwe* ");
+
+  EXPECT_TRUE(Filter.contains("aaa"));
+  EXPECT_TRUE(Filter.contains("qqq"));
+  EXPECT_FALSE(Filter.contains("a."));
+  EXPECT_FALSE(Filter.contains("a.b"));
+  EXPECT_FALSE(Filter.contains("b."));
+  EXPECT_FALSE(Filter.contains("b.b"));
+  EXPECT_TRUE(Filter.contains("a.1.b"));
+  EXPECT_FALSE(Filter.contains("a.1.A.a"));
+  EXPECT_FALSE(Filter.contains("qwe"));
+  EXPECT_FALSE(Filter.contains("asdfqweasdf"));
+  EXPECT_TRUE(Filter.contains("asdfqwEasdf"));
+}
+
+namespace {
+/// \brief Returns the same shared options for all files, like
+/// \c FileOptionsProvider for files using the same configuration file.
+class SharedOptionsProvider : public DefaultOptionsProvider {
+public:
+  SharedOptionsProvider(const ClangTidyOptions &Options)
+      : DefaultOptionsProvider(ClangTidyGlobalOptions(), Options),
+        Shared(std::make_shared<const ClangTidyOptions>(Options)) {}
+
+  std::shared_ptr<const ClangTidyOptions>
+  getSharedOptions(StringRef FileName) override {
+    return Shared;
+  }
+
+private:
+  std::shared_ptr<const ClangTidyOptions> Shared;
+};
+} // namespace
+
+TEST(ClangTidyContext, MergesSharedOptionsOncePerDirectory) {
+  ClangTidyOptions Options;
+  Options.Checks = "-*,test-check";
+  ClangTidyContext Context(llvm::make_unique<SharedOptionsProvider>(Options));
+  auto A = Context.getOptionsForFile("dir/a.cc");
+  EXPECT_EQ("-*,test-check", *A->Checks);
+  // Unset options are taken from the defaults.
+  EXPECT_TRUE(A->HeaderFilterRegex.hasValue());
+  EXPECT_EQ(A, Context.getOptionsForFile("dir/b.cc"));
+  EXPECT_NE(A, Context.getOptionsForFile("other/c.cc"));
+}
+
+} // namespace test
+} // namespace tidy
+} // namespace clang
@@ -1,6 +1,9 @@
 #include "ClangTidyOptions.h"
 #include "gtest/gtest.h"
 #include "llvm/ADT/StringExtras.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/Path.h"
+#include "llvm/Support/raw_ostream.h"
 
 namespace clang {
 namespace tidy {
@@ -99,6 +102,49 @@ TEST(ParseConfiguration, MergeConfigurations) {
             llvm::join(Options.ExtraArgsBefore->begin(),
                        Options.ExtraArgsBefore->end(), ","));
 }
+
+TEST(FileOptionsProvider, CachesDirectoryConfigurations) {
+  llvm::SmallString<128> Root;
+  ASSERT_FALSE(
+      llvm::sys::fs::createUniqueDirectory("clang-tidy-options-test", Root));
+  llvm::SmallString<128> Config(Root), Nested(Root), Sibling(Root);
+  llvm::sys::path::append(Config, ".clang-tidy");
+  llvm::sys::path::append(Nested, "a", "b");
+  llvm::sys::path::append(Sibling, "c");
+  ASSERT_FALSE(llvm::sys::fs::create_directories(Nested));
+  ASSERT_FALSE(llvm::sys::fs::create_directories(Sibling));
+  {
+    std::error_code EC;
+    llvm::raw_fd_ostream OS(Config, EC, llvm::sys::fs::F_Text);
+    ASSERT_FALSE(EC);
+    OS << "Checks: '-*,test-check'\n";
+  }
+
+  FileOptionsProvider Provider(ClangTidyGlobalOptions(), ClangTidyOptions(),
+                               ClangTidyOptions());
+  auto NestedOptions = Provider.getSharedOptions((Nested + "/x.cc").str());
+  auto SiblingOptions = Provider.getSharedOptions((Sibling + "/y.cc").str());
+  EXPECT_EQ("-*,test-check", *NestedOptions->Checks);
+  // All directories using the same configuration file share its options.
+  EXPECT_EQ(NestedOptions, SiblingOptions);
+
+  // Cached directories don't look for the configuration file again.
+  ASSERT_FALSE(llvm::sys::fs::remove(Config));
+  EXPECT_EQ(NestedOptions,
+            Provider.getSharedOptions((Nested + "/z.cc").str()));
+  std::vector<OptionsSource> RawOptions =
+      Provider.getRawOptions((Nested + "/x.cc").str());
+  ASSERT_EQ(3u, RawOptions.size());
+  EXPECT_EQ(Config.str(), RawOptions[1].second);
+
+  // Clearing the cache makes the removal visible.
+  Provider.clearCache();
+  EXPECT_FALSE(
+      Provider.getSharedOptions((Nested + "/x.cc").str())->Checks.hasValue());
+  EXPECT_EQ(2u, Provider.getRawOptions((Nested + "/x.cc").str()).size());
+
+  llvm::sys::fs::remove_directories(Root);
+}
 } // namespace test
 } // namespace tidy
 } // namespace clang
@@ -0,0 +1,88 @@
+#include "ClangTidyParentMap.h"
+#include "clang/AST/RecursiveASTVisitor.h"
+#include "clang/Frontend/ASTUnit.h"
+#include "clang/Tooling/Tooling.h"
+#include "gtest/gtest.h"
+
+namespace clang {
+namespace tidy {
+namespace test {
+
+using ast_type_traits::DynTypedNode;
+
+namespace {
+class NodeCollector : public RecursiveASTVisitor<NodeCollector> {
+public:
+  bool shouldVisitTemplateInstantiations() const { return true; }
+  bool shouldVisitImplicitCode() const { return true; }
+
+  bool VisitDecl(Decl *D) {
+    Nodes.push_back(DynTypedNode::create(*D));
+    return true;
+  }
+  bool VisitStmt(Stmt *S) {
+    Nodes.push_back(DynTypedNode::create(*S));
+    return true;
+  }
+
+  std::vector<DynTypedNode> Nodes;
+};
+} // namespace
+
+static void expectSameParents(StringRef Code) {
+  std::unique_ptr<ASTUnit> AST = tooling::buildASTFromCode(Code);
+  ASSERT_TRUE(AST);
+  ASTContext &Context = AST->getASTContext();
+
+  NodeCollector Collector;
+  Collector.TraverseDecl(Context.getTranslationUnitDecl());
+  ASSERT_FALSE(Collector.Nodes.empty());
+
+  // Query the nodes in the reverse order, so that most lookups start in a
+  // top-level declaration that wasn't traversed yet.
+  ClangTidyParentMap ParentMap;
+  ParentMap.setASTContext(&Context);
+  std::vector<std::vector<DynTypedNode>> Parents;
+  for (auto I = Collector.Nodes.rbegin(), E = Collector.Nodes.rend(); I != E;
+       ++I) {
+    ASTContext::DynTypedNodeList List = ParentMap.getParents(*I);
+    Parents.emplace_back(List.begin(), List.end());
+  }
+
+  for (size_t I = 0, E = Parents.size(); I != E; ++I) {
+    const DynTypedNode &Node = Collector.Nodes[E - I - 1];
+    ASTContext::DynTypedNodeList Expected = Context.getParents(Node);
+    ASSERT_EQ(Expected.size(), Parents[I].size());
+    for (size_t J = 0; J < Expected.size(); ++J)
+      EXPECT_EQ(Expected[J].getMemoizationData(),
+                Parents[I][J].getMemoizationData());
+  }
+}
+
+TEST(ClangTidyParentMap, SameAsASTContext) {
+  expectSameParents("int a, b = 1;\n"
+                    "struct S { int f(int x) { return x + a; } } s;\n"
+                    "namespace n {\n"
+                    "void g() { int c[2] = {1, 2}; if (c[0]) g(); }\n"
+                    "namespace m { int d = sizeof(int[3]); }\n"
+                    "}\n"
+                    "extern \"C\" { int h(); }\n");
+}
+
+TEST(ClangTidyParentMap, TemplateInstantiations) {
+  expectSameParents("template <typename T> T f(T x) { return x * 2; }\n"
+                    "template <typename T> struct S { T g() { return {}; } };\n"
+                    "int i = f(1) + S<int>().g();\n"
+                    "double d = f(1.0);\n");
+}
+
+TEST(ClangTidyParentMap, Macros) {
+  expectSameParents("#define DECLARE(name) int name = 0;\n"
+                    "#define SUM(a, b) ((a) + (b))\n"
+                    "DECLARE(x) DECLARE(y)\n"
+                    "int z = SUM(x, y);\n");
+}
+
+} // namespace test
+} // namespace tidy
+} // namespace clang
@@ -30,25 +30,31 @@ public:
   TestClangTidyAction(SmallVectorImpl<std::unique_ptr<ClangTidyCheck>> &Checks,
                       ast_matchers::MatchFinder &Finder,
                       ClangTidyContext &Context)
-      : Checks(Checks), Finder(Finder), Context(Context) {}
+      : Checks(Checks), Finder(Finder), Context(Context),
+        SharedVisitor(Context) {}
 
-private:
+protected:
   std::unique_ptr<ASTConsumer> CreateASTConsumer(CompilerInstance &Compiler,
                                                  StringRef File) override {
     Context.setSourceManager(&Compiler.getSourceManager());
     Context.setCurrentFile(File);
     Context.setASTContext(&Compiler.getASTContext());
+    Context.getIncludeGraph().reset();
 
     for (auto &Check : Checks) {
       Check->registerMatchers(&Finder);
       Check->registerPPCallbacks(Compiler);
+      Check->registerSharedVisitorCallbacks(SharedVisitor);
     }
+    SharedVisitor.registerMatchers(&Finder);
     return Finder.newASTConsumer();
   }
 
+private:
   SmallVectorImpl<std::unique_ptr<ClangTidyCheck>> &Checks;
   ast_matchers::MatchFinder &Finder;
   ClangTidyContext &Context;
+  ClangTidySharedVisitor SharedVisitor;
 };
 
 template <typename Check, typename... Checks> struct CheckFactory {
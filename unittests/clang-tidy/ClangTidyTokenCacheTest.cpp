@@ -0,0 +1,80 @@
+#include "ClangTidyTokenCache.h"
+#include "clang/Frontend/ASTUnit.h"
+#include "clang/Tooling/Tooling.h"
+#include "gtest/gtest.h"
+
+namespace clang {
+namespace tidy {
+namespace test {
+
+class ClangTidyTokenCacheTest : public ::testing::Test {
+protected:
+  void SetUp() override {
+    AST = tooling::buildASTFromCode("int f(int a /* x */, int b);\n"
+                                    "// trailing\n");
+    ASSERT_TRUE(AST);
+    Tokens.setASTContext(&AST->getASTContext());
+  }
+
+  SourceLocation loc(unsigned Offset) {
+    const SourceManager &SM = AST->getSourceManager();
+    return SM.getLocForStartOfFile(SM.getMainFileID()).getLocWithOffset(Offset);
+  }
+
+  StringRef text(const Token &Tok) {
+    const SourceManager &SM = AST->getSourceManager();
+    return StringRef(SM.getCharacterData(Tok.getLocation()), Tok.getLength());
+  }
+
+  std::unique_ptr<ASTUnit> AST;
+  ClangTidyTokenCache Tokens;
+};
+
+TEST_F(ClangTidyTokenCacheTest, LexesWholeFile) {
+  ArrayRef<Token> All =
+      Tokens.getTokens(AST->getSourceManager().getMainFileID());
+  ASSERT_EQ(13u, All.size());
+  EXPECT_TRUE(All.front().is(tok::raw_identifier));
+  EXPECT_EQ("int", text(All.front()));
+  EXPECT_TRUE(All[5].is(tok::comment));
+  EXPECT_TRUE(All[11].is(tok::comment));
+  EXPECT_TRUE(All.back().is(tok::eof));
+}
+
+TEST_F(ClangTidyTokenCacheTest, GetTokenAt) {
+  // Inside "int" of "int a".
+  const Token *Tok = Tokens.getTokenAt(loc(7));
+  ASSERT_TRUE(Tok);
+  EXPECT_EQ("int", text(*Tok));
+  EXPECT_EQ(loc(6), Tok->getLocation());
+  // Whitespace after "int".
+  EXPECT_FALSE(Tokens.getTokenAt(loc(3)));
+  // Macro locations have no tokens.
+  EXPECT_FALSE(Tokens.getTokenAt(SourceLocation()));
+}
+
+TEST_F(ClangTidyTokenCacheTest, PreviousAndNextTokens) {
+  // Before ",".
+  SourceLocation Comma = loc(19);
+  EXPECT_EQ("a", text(Tokens.getPreviousToken(Comma)));
+  EXPECT_EQ("/* x */",
+            text(Tokens.getPreviousToken(Comma, /*SkipComments=*/false)));
+  EXPECT_EQ(",", text(Tokens.getNextToken(Comma)));
+  EXPECT_EQ(",", text(Tokens.getNextToken(loc(12))));
+  EXPECT_EQ("/* x */",
+            text(Tokens.getNextToken(loc(12), /*SkipComments=*/false)));
+  EXPECT_TRUE(Tokens.getPreviousToken(loc(0)).is(tok::unknown));
+}
+
+TEST_F(ClangTidyTokenCacheTest, TokensInRange) {
+  ArrayRef<Token> Range =
+      Tokens.getTokensInRange(CharSourceRange::getCharRange(loc(6), loc(19)));
+  ASSERT_EQ(3u, Range.size());
+  EXPECT_EQ("int", text(Range[0]));
+  EXPECT_EQ("a", text(Range[1]));
+  EXPECT_EQ("/* x */", text(Range[2]));
+}
+
+} // namespace test
+} // namespace tidy
+} // namespace clang
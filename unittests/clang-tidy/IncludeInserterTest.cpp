@@ -33,11 +33,9 @@ public:
       : ClangTidyCheck(CheckName, Context) {}
 
   void registerPPCallbacks(CompilerInstance &Compiler) override {
-    Inserter.reset(new utils::IncludeInserter(
-        Compiler.getSourceManager(),
-        Compiler.getLangOpts(),
-        utils::IncludeSorter::IS_Google));
-    Compiler.getPreprocessor().addPPCallbacks(Inserter->CreatePPCallbacks());
+    Inserter.reset(new utils::IncludeInserter(getIncludeGraph(),
+                                              Compiler.getPreprocessor(),
+                                              utils::IncludeSorter::IS_Google));
   }
 
   void registerMatchers(ast_matchers::MatchFinder *Finder) override {
@@ -115,10 +113,10 @@ public:
   bool IsAngledInclude() const override { return true; }
 };
 
-template <typename Check>
+template <typename... Checks>
 std::string runCheckOnCode(StringRef Code, StringRef Filename) {
   std::vector<ClangTidyError> Errors;
-  return test::runCheckOnCode<Check>(Code, &Errors, Filename, None,
+  return test::runCheckOnCode<Checks...>(Code, &Errors, Filename, None,
                                      ClangTidyOptions(),
                                      {// Main file include
                                       {"clang_tidy/tests/"
@@ -200,6 +198,38 @@ void foo() {
                                    "insert_includes_test_input2.cc"));
 }
 
+TEST(IncludeInserterTest, InsertFromMultipleChecks) {
+  const char *PreCode = R"(
+#include "clang_tidy/tests/insert_includes_test_header.h"
+
+#include <list>
+#include <map>
+
+#include "path/to/a/header.h"
+
+void foo() {
+  int a = 0;
+})";
+  const char *PostCode = R"(
+#include "clang_tidy/tests/insert_includes_test_header.h"
+
+#include <list>
+#include <map>
+#include <set>
+
+#include "path/to/a/header.h"
+#include "path/to/header.h"
+
+void foo() {
+  int a = 0;
+})";
+
+  EXPECT_EQ(PostCode,
+            (runCheckOnCode<NonSystemHeaderInserterCheck,
+                            CXXSystemIncludeInserterCheck>(
+                PreCode, "clang_tidy/tests/insert_includes_test_input2.cc")));
+}
+
 TEST(IncludeInserterTest, InsertBeforeFirstNonSystemInclude) {
   const char *PreCode = R"(
 #include "clang_tidy/tests/insert_includes_test_header.h"
@@ -0,0 +1,405 @@
+//===--- ClangTidyBench.cpp - clang-tidy ----------------------------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+///
+///  \file This file implements clang-tidy-bench, which runs each clang-tidy
+///  check in isolation on synthetic translation units of growing size and
+///  reports the time and memory it takes and how it scales with the input.
+///
+//===----------------------------------------------------------------------===//
+
+#include "ClangTidyModule.h"
+#include "ClangTidyModuleRegistry.h"
+#include "ClangTidyTest.h"
+#include "clang/Frontend/MultiplexConsumer.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/Format.h"
+#include "llvm/Support/Signals.h"
+#include "llvm/Support/Timer.h"
+#include "llvm/Support/raw_ostream.h"
+#include <algorithm>
+#include <cmath>
+
+using namespace clang;
+using namespace clang::tidy;
+using namespace llvm;
+
+static cl::OptionCategory BenchCategory("clang-tidy-bench options");
+
+static cl::opt<std::string> ChecksFilter(
+    "checks",
+    cl::desc("Comma-separated list of globs with optional '-' prefix,\n"
+             "selecting the checks to benchmark, like clang-tidy -checks."),
+    cl::init("*"), cl::cat(BenchCategory));
+
+static cl::opt<std::string> InputsFilter(
+    "inputs",
+    cl::desc("Comma-separated list of globs with optional '-' prefix,\n"
+             "selecting the synthetic inputs, see -list-inputs."),
+    cl::init("*"), cl::cat(BenchCategory));
+
+static cl::opt<bool> ListInputs("list-inputs",
+                                cl::desc("List the synthetic inputs and exit."),
+                                cl::init(false), cl::cat(BenchCategory));
+
+static cl::opt<unsigned>
+    Scale("scale",
+          cl::desc("Multiplies the size of all inputs, use it to make the\n"
+                   "smallest inputs large enough for stable timings."),
+          cl::init(1), cl::cat(BenchCategory));
+
+static cl::opt<unsigned>
+    Steps("steps",
+          cl::desc("Number of input sizes, each twice as large as the\n"
+                   "previous one."),
+          cl::init(3), cl::cat(BenchCategory));
+
+static cl::opt<double> MaxExponent(
+    "max-exponent",
+    cl::desc("Flags checks whose time grows faster than the input size\n"
+             "to this power between the smallest and the largest input."),
+    cl::init(1.5), cl::cat(BenchCategory));
+
+static cl::opt<double> MinTime(
+    "min-time",
+    cl::desc("Checks taking less wall time (in seconds) on the largest\n"
+             "input are never flagged, as their timings are mostly noise."),
+    cl::init(0.05), cl::cat(BenchCategory));
+
+namespace {
+
+/// \brief A generator of synthetic translation units.
+struct SyntheticInput {
+  const char *Name;
+  const char *Description;
+  /// \brief Size of the smallest input, in generator specific units.
+  unsigned BaseSize;
+  std::string (*Generate)(unsigned Size);
+};
+
+/// \brief \p Size chains of class templates, each instantiated 64 levels deep.
+std::string generateTemplates(unsigned Size) {
+  std::string Code = "template <int N, int Tag> struct Deep {\n"
+                     "  typedef typename Deep<N - 1, Tag>::Type Type;\n"
+                     "  static Type get() { return Deep<N - 1, Tag>::get() "
+                     "+ N; }\n"
+                     "};\n"
+                     "template <int Tag> struct Deep<0, Tag> {\n"
+                     "  typedef int Type;\n"
+                     "  static Type get() { return Tag; }\n"
+                     "};\n"
+                     "template <typename T> T twice(T Value) {\n"
+                     "  return Value + Value;\n"
+                     "}\n";
+  for (unsigned I = 0; I < Size; ++I) {
+    std::string Tag = std::to_string(I);
+    Code += "int Value" + Tag + " = twice(Deep<64, " + Tag + ">::get());\n";
+  }
+  return Code;
+}
+
+/// \brief A single function with \p Size lines of statements.
+std::string generateLongFunction(unsigned Size) {
+  std::string Code = "int longFunction(int *Values, int Count) {\n"
+                     "  int Sum = 0;\n";
+  for (unsigned I = 0; I < Size; ++I) {
+    std::string N = std::to_string(I);
+    switch (I % 4) {
+    case 0:
+      Code += "  Sum += Values[" + std::to_string(I % 64) + "];\n";
+      break;
+    case 1:
+      Code += "  if (Sum > " + N + ") Sum -= Count;\n";
+      break;
+    case 2:
+      Code += "  for (int I = 0; I < Count; ++I) Sum ^= Values[I];\n";
+      break;
+    case 3:
+      Code += "  { int Local" + N + " = Sum * 2; Sum = Local" + N + " / 3; }\n";
+      break;
+    }
+  }
+  Code += "  return Sum;\n"
+          "}\n";
+  return Code;
+}
+
+/// \brief A function with \p Size statements built from nested macros.
+std::string generateMacros(unsigned Size) {
+  std::string Code =
+      "#define BENCH_ADD(a, b) ((a) + (b))\n"
+      "#define BENCH_MUL(a, b) ((a) * (b))\n"
+      "#define BENCH_EXPR(x) BENCH_ADD(BENCH_MUL(x, 2), BENCH_ADD(x, 1))\n"
+      "#define BENCH_DECLARE(name, init) int name = BENCH_EXPR(init);\n"
+      "#define BENCH_CHECK(cond) do { if (!(cond)) return 0; } while (0)\n"
+      "int macros() {\n";
+  for (unsigned I = 0; I < Size; ++I) {
+    std::string Var = "Var" + std::to_string(I);
+    Code += "  BENCH_DECLARE(" + Var + ", " + std::to_string(I % 100) + ")\n";
+    Code += "  BENCH_CHECK(" + Var + " != BENCH_EXPR(" + Var + "));\n";
+  }
+  Code += "  return 1;\n"
+          "}\n";
+  return Code;
+}
+
+/// \brief \p Size class hierarchies with code that many checks suggest fixes
+/// for.
+std::string generateFixIts(unsigned Size) {
+  std::string Code = "#define NULL 0\n";
+  for (unsigned I = 0; I < Size; ++I) {
+    std::string N = std::to_string(I);
+    Code += "struct Base" + N + " {\n"
+            "  virtual ~Base" + N + "();\n"
+            "  virtual int get(int *P) const;\n"
+            "};\n"
+            "struct Derived" + N + " : Base" + N + " {\n"
+            "  virtual int get(int *P) const;\n"
+            "};\n"
+            "int Derived" + N + "::get(int *P) const {\n"
+            "  if (P == NULL) return (int)0.5;\n"
+            "  bool B = *P != 0;\n"
+            "  if (B == true) return 1;\n"
+            "  else return 0;\n"
+            "}\n";
+  }
+  return Code;
+}
+
+const SyntheticInput Inputs[] = {
+    {"templates", "chains of deep class template instantiations", 16,
+     generateTemplates},
+    {"long-function", "a function with one statement per line", 25000,
+     generateLongFunction},
+    {"macros", "statements built from nested macro expansions", 2500,
+     generateMacros},
+    {"fixits", "code many checks suggest fix-its for", 1000, generateFixIts},
+};
+
+/// \brief Records the time and memory usage when the translation unit is
+/// handed to the consumer.
+class TimeRecordingConsumer : public ASTConsumer {
+public:
+  TimeRecordingConsumer(TimeRecord &Record, bool Start)
+      : Record(Record), Start(Start) {}
+
+  void HandleTranslationUnit(ASTContext &) override {
+    Record = TimeRecord::getCurrentTime(Start);
+  }
+
+private:
+  TimeRecord &Record;
+  bool Start;
+};
+
+/// \brief Measures the time the checks take to match the translation unit.
+/// Preprocessor callbacks run while parsing and aren't included.
+class BenchAction : public test::TestClangTidyAction {
+public:
+  BenchAction(SmallVectorImpl<std::unique_ptr<ClangTidyCheck>> &Checks,
+              ast_matchers::MatchFinder &Finder, ClangTidyContext &Context,
+              TimeRecord &MatchStart, TimeRecord &MatchEnd)
+      : TestClangTidyAction(Checks, Finder, Context), MatchStart(MatchStart),
+        MatchEnd(MatchEnd) {}
+
+private:
+  std::unique_ptr<ASTConsumer> CreateASTConsumer(CompilerInstance &Compiler,
+                                                 StringRef File) override {
+    std::vector<std::unique_ptr<ASTConsumer>> Consumers;
+    Consumers.push_back(
+        llvm::make_unique<TimeRecordingConsumer>(MatchStart, true));
+    Consumers.push_back(TestClangTidyAction::CreateASTConsumer(Compiler, File));
+    Consumers.push_back(
+        llvm::make_unique<TimeRecordingConsumer>(MatchEnd, false));
+    return llvm::make_unique<MultiplexConsumer>(std::move(Consumers));
+  }
+
+  TimeRecord &MatchStart;
+  TimeRecord &MatchEnd;
+};
+
+struct BenchResult {
+  BenchResult() : Failed(false), Warnings(0), Fixes(0) {}
+  bool Failed;
+  TimeRecord Match;
+  TimeRecord Total;
+  unsigned Warnings;
+  unsigned Fixes;
+};
+
+/// \brief Runs the check created by \p Factory, or no check if it's empty,
+/// on \p Code, like \c test::runCheckOnCode.
+BenchResult runBench(StringRef CheckName,
+                     const ClangTidyCheckFactories::CheckFactory &Factory,
+                     StringRef Code) {
+  BenchResult Result;
+  ClangTidyOptions Options;
+  Options.Checks = "-*," + CheckName.str();
+  ClangTidyContext Context(llvm::make_unique<DefaultOptionsProvider>(
+      ClangTidyGlobalOptions(), Options));
+  ClangTidyDiagnosticConsumer DiagConsumer(Context);
+
+  std::vector<std::string> Args = {"clang-tidy-bench", "-fsyntax-only",
+                                   "-std=c++11", "input.cc"};
+
+  ast_matchers::MatchFinder Finder;
+  llvm::IntrusiveRefCntPtr<vfs::InMemoryFileSystem> InMemoryFileSystem(
+      new vfs::InMemoryFileSystem);
+  llvm::IntrusiveRefCntPtr<FileManager> Files(
+      new FileManager(FileSystemOptions(), InMemoryFileSystem));
+
+  SmallVector<std::unique_ptr<ClangTidyCheck>, 1> Checks;
+  if (Factory)
+    Checks.emplace_back(Factory(CheckName, &Context));
+  TimeRecord MatchStart, MatchEnd;
+  tooling::ToolInvocation Invocation(
+      Args, new BenchAction(Checks, Finder, Context, MatchStart, MatchEnd),
+      Files.get());
+  InMemoryFileSystem->addFile("input.cc", 0,
+                              llvm::MemoryBuffer::getMemBuffer(Code));
+  Invocation.setDiagnosticConsumer(&DiagConsumer);
+
+  TimeRecord Start = TimeRecord::getCurrentTime(true);
+  if (!Invocation.run()) {
+    Result.Failed = true;
+    return Result;
+  }
+  Result.Total = TimeRecord::getCurrentTime(false);
+  Result.Total -= Start;
+  Result.Match = MatchEnd;
+  Result.Match -= MatchStart;
+
+  DiagConsumer.finish();
+  for (const ClangTidyError &Error : Context.getErrors()) {
+    if (Error.DiagnosticName != CheckName)
+      continue;
+    ++Result.Warnings;
+    for (const auto &FileAndReplacements : Error.Fix)
+      Result.Fixes += FileAndReplacements.second.size();
+  }
+  return Result;
+}
+
+} // namespace
+
+// These anchors are used to force the linker to link all modules.
+namespace clang {
+namespace tidy {
+extern volatile int AndroidModuleAnchorSource;
+extern volatile int BoostModuleAnchorSource;
+extern volatile int BugproneModuleAnchorSource;
+extern volatile int CERTModuleAnchorSource;
+extern volatile int CppCoreGuidelinesModuleAnchorSource;
+extern volatile int GoogleModuleAnchorSource;
+extern volatile int HICPPModuleAnchorSource;
+extern volatile int LLVMModuleAnchorSource;
+extern volatile int MiscModuleAnchorSource;
+extern volatile int ModernizeModuleAnchorSource;
+extern volatile int MPIModuleAnchorSource;
+extern volatile int PerformanceModuleAnchorSource;
+extern volatile int ReadabilityModuleAnchorSource;
+static int LLVM_ATTRIBUTE_UNUSED ModuleAnchorDestinations[] = {
+    AndroidModuleAnchorSource,
+    BoostModuleAnchorSource,
+    BugproneModuleAnchorSource,
+    CERTModuleAnchorSource,
+    CppCoreGuidelinesModuleAnchorSource,
+    GoogleModuleAnchorSource,
+    HICPPModuleAnchorSource,
+    LLVMModuleAnchorSource,
+    MiscModuleAnchorSource,
+    ModernizeModuleAnchorSource,
+    MPIModuleAnchorSource,
+    PerformanceModuleAnchorSource,
+    ReadabilityModuleAnchorSource,
+};
+} // namespace tidy
+} // namespace clang
+
+int main(int argc, const char **argv) {
+  sys::PrintStackTraceOnErrorSignal(argv[0]);
+  cl::HideUnrelatedOptions(BenchCategory);
+  cl::ParseCommandLineOptions(argc, argv, "clang-tidy benchmark\n");
+
+  if (ListInputs) {
+    for (const SyntheticInput &Input : Inputs)
+      outs() << "  " << Input.Name << " - " << Input.Description << "\n";
+    return 0;
+  }
+
+  const ClangTidyCheckFactories &Factories =
+      ClangTidyCheckFactories::getRegistered();
+
+  GlobList CheckGlobs(ChecksFilter);
+  GlobList InputGlobs(InputsFilter);
+  unsigned Flagged = 0;
+  for (const SyntheticInput &Input : Inputs) {
+    if (!InputGlobs.contains(Input.Name))
+      continue;
+
+    std::vector<unsigned> Sizes;
+    std::vector<std::string> Codes;
+    std::vector<BenchResult> Baselines;
+    for (unsigned Step = 0; Step < Steps; ++Step) {
+      Sizes.push_back(Input.BaseSize * Scale << Step);
+      Codes.push_back(Input.Generate(Sizes.back()));
+      Baselines.push_back(runBench("", nullptr, Codes.back()));
+      if (Baselines.back().Failed) {
+        errs() << "error: input " << Input.Name << " of size " << Sizes.back()
+               << " doesn't compile\n";
+        return 1;
+      }
+    }
+
+    outs() << "Input " << Input.Name << " (" << Input.Description << ")\n";
+    outs() << format("%-50s %9s %10s %10s %10s %8s %8s\n", "check", "size",
+                     "match (s)", "extra (s)", "mem (KB)", "warnings",
+                     "fixes");
+    for (const auto &Factory : Factories) {
+      StringRef CheckName = Factory.first;
+      if (!CheckGlobs.contains(CheckName))
+        continue;
+
+      std::vector<double> Times;
+      for (unsigned Step = 0; Step < Steps; ++Step) {
+        BenchResult Result = runBench(CheckName, Factory.second, Codes[Step]);
+        if (Result.Failed) {
+          outs() << format("%-50s %9u failed\n", CheckName.str().c_str(),
+                           Sizes[Step]);
+          break;
+        }
+        double Extra = Result.Total.getWallTime() -
+                       Baselines[Step].Total.getWallTime();
+        outs() << format("%-50s %9u %10.3f %10.3f %10lld %8u %8u\n",
+                         CheckName.str().c_str(), Sizes[Step],
+                         Result.Match.getWallTime(), std::max(Extra, 0.0),
+                         (long long)(Result.Match.getMemUsed() / 1024),
+                         Result.Warnings, Result.Fixes);
+        Times.push_back(std::max(Extra, Result.Match.getWallTime()));
+      }
+
+      // Compare the smallest and the largest input: time ~ size^Exponent.
+      if (Times.size() < 2 || Times.back() < MinTime || Times.front() <= 0)
+        continue;
+      double Exponent = std::log(Times.back() / Times.front()) /
+                        std::log(double(Sizes[Times.size() - 1]) / Sizes[0]);
+      if (Exponent > MaxExponent) {
+        ++Flagged;
+        outs() << "warning: " << CheckName << " scales superlinearly on "
+               << Input.Name << ": time ~ size^"
+               << format("%.2f", Exponent) << "\n";
+      }
+    }
+    outs() << "\n";
+  }
+
+  if (Flagged)
+    outs() << Flagged << " superlinear check/input combination"
+           << (Flagged == 1 ? "" : "s") << " found\n";
+  return 0;
+}
@@ -9,8 +9,11 @@
 
 #include "FuzzySymbolIndex.h"
 #include "gmock/gmock.h"
+#include "llvm/Support/FileSystem.h"
 #include "llvm/Support/Regex.h"
+#include "llvm/Support/raw_ostream.h"
 #include "gtest/gtest.h"
+#include <algorithm>
 
 using testing::ElementsAre;
 using testing::Not;
@@ -56,6 +59,68 @@ TEST(FuzzySymbolIndexTest, QueryRegexp) {
   EXPECT_THAT(QueryRegexp("UniP"), MatchesSymbol("unique_ptr"));
 }
 
+MATCHER_P(TokensMatchSymbol, Identifier, "") {
+  auto Tokens = FuzzySymbolIndex::tokenize(Identifier);
+  std::vector<llvm::StringRef> SymbolTokens(Tokens.begin(), Tokens.end());
+  return FuzzySymbolIndex::matchTokens(FuzzySymbolIndex::tokenize(arg),
+                                       SymbolTokens);
+}
+
+TEST(FuzzySymbolIndexTest, MatchTokens) {
+  EXPECT_THAT("uhc", TokensMatchSymbol("URLHandlerCallback"));
+  EXPECT_THAT("urhaca", TokensMatchSymbol("URLHandlerCallback"));
+  EXPECT_THAT("uhcb", Not(TokensMatchSymbol("URLHandlerCallback")))
+      << "Non-prefix";
+  EXPECT_THAT("uc", Not(TokensMatchSymbol("URLHandlerCallback")))
+      << "Skip token";
+  EXPECT_THAT("hc", Not(TokensMatchSymbol("URLHandlerCallback")))
+      << "Unanchored";
+
+  EXPECT_THAT("uptr", TokensMatchSymbol("unique_ptr"));
+  EXPECT_THAT("UniP", TokensMatchSymbol("unique_ptr"));
+  EXPECT_THAT("StR", TokensMatchSymbol("string_ref"));
+  EXPECT_THAT("STr", Not(TokensMatchSymbol("string_ref")))
+      << "Query token spans symbol tokens";
+  EXPECT_THAT("aab", TokensMatchSymbol("aa_ab")) << "Backtracking";
+  EXPECT_THAT("", TokensMatchSymbol("anything"));
+}
+
+TEST(FuzzySymbolIndexTest, Search) {
+  using find_all_symbols::SymbolInfo;
+  int FD;
+  llvm::SmallString<128> Path;
+  ASSERT_FALSE(llvm::sys::fs::createTemporaryFile("fuzzy-symbol-index", "yaml",
+                                                  FD, Path));
+  {
+    llvm::raw_fd_ostream OS(FD, /*shouldClose=*/true);
+    SymbolInfo::SignalMap Symbols;
+    for (const char *Name :
+         {"URLHandlerCallback", "unique_ptr", "UniquePtr", "ptr", "a"})
+      Symbols[SymbolInfo(Name, SymbolInfo::SymbolKind::Class, "x.h", {})] =
+          SymbolInfo::Signals(1, 0);
+    find_all_symbols::WriteSymbolInfosToStream(OS, Symbols);
+  }
+  auto Index = FuzzySymbolIndex::createFromYAML(Path);
+  ASSERT_TRUE(bool(Index));
+
+  auto Search = [&](llvm::StringRef Query) {
+    std::vector<std::string> Names;
+    for (const auto &Symbol : (*Index)->search(Query))
+      Names.push_back(Symbol.Symbol.getName());
+    std::sort(Names.begin(), Names.end());
+    return Names;
+  };
+  EXPECT_THAT(Search("uptr"), ElementsAre("UniquePtr", "unique_ptr"));
+  EXPECT_THAT(Search("uhc"), ElementsAre("URLHandlerCallback"));
+  EXPECT_THAT(Search("u"),
+              ElementsAre("URLHandlerCallback", "UniquePtr", "unique_ptr"));
+  EXPECT_THAT(Search("a"), ElementsAre("a"));
+  EXPECT_THAT(Search("ab"), ElementsAre());
+  EXPECT_THAT(Search("ptr"), ElementsAre("ptr"));
+  EXPECT_EQ(5u, Search("").size());
+  llvm::sys::fs::remove(Path);
+}
+
 } // namespace
 } // namespace include_fixer
 } // namespace clang
@@ -365,6 +365,82 @@ TEST(IncludeFixer, DontAddQualifiersForMissingCompleteType) {
             runIncludeFixer("class bar;\nvoid f() {\nbar* b;\nb->f();\n}"));
 }
 
+/// Counts the searches in an InMemorySymbolIndex.
+class CountingSymbolIndex : public SymbolIndex {
+public:
+  CountingSymbolIndex(const std::vector<SymbolAndSignals> &Symbols,
+                      unsigned &Searches)
+      : Index(Symbols), Searches(Searches) {}
+
+  std::vector<SymbolAndSignals> search(llvm::StringRef Identifier) override {
+    ++Searches;
+    return Index.search(Identifier);
+  }
+
+private:
+  InMemorySymbolIndex Index;
+  unsigned &Searches;
+};
+
+TEST(SymbolIndexManager, SearchCache) {
+  std::vector<SymbolAndSignals> Symbols = {
+      {SymbolInfo("bar", SymbolInfo::SymbolKind::Class, "\"bar.h\"",
+                  {{SymbolInfo::ContextType::Namespace, "a"}}),
+       SymbolInfo::Signals{}},
+  };
+  unsigned Searches = 0;
+  SymbolIndexManager SymbolIndexMgr;
+  SymbolIndexMgr.addSymbolIndex([&]() {
+    return llvm::make_unique<CountingSymbolIndex>(Symbols, Searches);
+  });
+
+  // Both queries look up "bar" in the index, but only the first one searches.
+  SymbolIndexManager::SearchCache Cache;
+  EXPECT_TRUE(SymbolIndexMgr
+                  .search("b::bar", /*IsNestedSearch=*/false, "input.cc",
+                          &Cache)
+                  .empty());
+  std::vector<SymbolInfo> Results = SymbolIndexMgr.search(
+      "a::bar", /*IsNestedSearch=*/false, "input.cc", &Cache);
+  ASSERT_EQ(1u, Results.size());
+  EXPECT_EQ("\"bar.h\"", Results.front().getFilePath());
+  EXPECT_EQ(1u, Searches);
+
+  // Without a cache, the index is searched again.
+  SymbolIndexMgr.search("a::bar", /*IsNestedSearch=*/false, "input.cc");
+  EXPECT_EQ(2u, Searches);
+}
+
+TEST(SymbolIndexManager, Ranking) {
+  std::vector<SymbolAndSignals> Symbols = {
+      {SymbolInfo("bar", SymbolInfo::SymbolKind::Class, "util/bar.h", {}),
+       SymbolInfo::Signals{/*Seen=*/1, 0}},
+      {SymbolInfo("bar", SymbolInfo::SymbolKind::Class, "src/dir/sub/bar.h",
+                  {}),
+       SymbolInfo::Signals{}},
+      {SymbolInfo("bar", SymbolInfo::SymbolKind::Class, "other/bar.h", {}),
+       SymbolInfo::Signals{}},
+  };
+  SymbolIndexManager SymbolIndexMgr;
+  SymbolIndexMgr.addSymbolIndex(
+      [=]() { return llvm::make_unique<InMemorySymbolIndex>(Symbols); });
+
+  // The header sharing most directories with the file comes first, then the
+  // more popular one.
+  std::vector<SymbolInfo> Results = SymbolIndexMgr.search(
+      "bar", /*IsNestedSearch=*/true, "/src/dir/sub/x.cc");
+  ASSERT_EQ(3u, Results.size());
+  EXPECT_EQ("src/dir/sub/bar.h", Results[0].getFilePath());
+  EXPECT_EQ("util/bar.h", Results[1].getFilePath());
+  EXPECT_EQ("other/bar.h", Results[2].getFilePath());
+
+  Results = SymbolIndexMgr.search("bar", /*IsNestedSearch=*/true,
+                                  "/src/dir/sub/x.cc", /*Cache=*/nullptr,
+                                  /*MaxResults=*/1);
+  ASSERT_EQ(1u, Results.size());
+  EXPECT_EQ("src/dir/sub/bar.h", Results[0].getFilePath());
+}
+
 } // namespace
 } // namespace include_fixer
 } // namespace clang
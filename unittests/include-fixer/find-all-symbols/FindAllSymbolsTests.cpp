@@ -7,8 +7,10 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include "BinarySymbolDatabase.h"
 #include "FindAllSymbolsAction.h"
 #include "HeaderMapCollector.h"
+#include "HeaderSymbolCache.h"
 #include "SymbolInfo.h"
 #include "SymbolReporter.h"
 #include "clang/ASTMatchers/ASTMatchFinder.h"
@@ -22,7 +24,9 @@
 #include "llvm/ADT/STLExtras.h"
 #include "llvm/ADT/StringRef.h"
 #include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/raw_ostream.h"
 #include "gtest/gtest.h"
+#include <map>
 #include <memory>
 #include <string>
 #include <vector>
@@ -574,5 +578,186 @@ TEST_F(FindAllSymbolsTest, NoFriendTest) {
   EXPECT_EQ(0, seen(Symbol));
 }
 
+// Indexes \p MainCode as \p FileName with the headers \p Headers, using
+// \p Cache.
+static bool runWithCache(TestSymbolReporter &Reporter, HeaderSymbolCache &Cache,
+                         const std::string &FileName, StringRef MainCode,
+                         const std::map<std::string, std::string> &Headers,
+                         const std::vector<std::string> &ExtraArgs = {}) {
+  llvm::IntrusiveRefCntPtr<vfs::InMemoryFileSystem> InMemoryFileSystem(
+      new vfs::InMemoryFileSystem);
+  llvm::IntrusiveRefCntPtr<FileManager> Files(
+      new FileManager(FileSystemOptions(), InMemoryFileSystem));
+  FindAllSymbolsActionFactory Factory(&Reporter, nullptr, &Cache);
+  std::vector<std::string> Args = {"find_all_symbols", "-fsyntax-only",
+                                   "-std=c++11"};
+  Args.insert(Args.end(), ExtraArgs.begin(), ExtraArgs.end());
+  Args.push_back(FileName);
+  tooling::ToolInvocation Invocation(
+      Args, Factory.create(), Files.get(),
+      std::make_shared<PCHContainerOperations>());
+  for (const auto &Header : Headers)
+    InMemoryFileSystem->addFile(
+        Header.first, 0, llvm::MemoryBuffer::getMemBuffer(Header.second));
+  InMemoryFileSystem->addFile(FileName, 0,
+                              llvm::MemoryBuffer::getMemBuffer(MainCode));
+  return Invocation.run();
+}
+
+TEST(HeaderSymbolCacheTest, ReusesHeaderSymbols) {
+  static const char HeaderCode[] = R"(
+    #ifndef SYMBOLS_H
+    #define SYMBOLS_H
+    #define HEADER_MACRO 1
+    namespace na {
+    class Shared {};
+    }
+    #endif
+  )";
+  std::map<std::string, std::string> Headers = {{HeaderName, HeaderCode}};
+  std::string Include = "#include \"" + std::string(HeaderName) + "\"\n";
+  TestSymbolReporter Reporter;
+  HeaderSymbolCache Cache;
+
+  ASSERT_TRUE(runWithCache(Reporter, Cache, "a.cc", Include + "na::Shared A;",
+                           Headers));
+  EXPECT_EQ(2u, Cache.size());
+  ASSERT_TRUE(runWithCache(Reporter, Cache, "b.cc",
+                           Include + "int B = HEADER_MACRO;", Headers));
+  EXPECT_EQ(2u, Cache.size());
+
+  SymbolInfo Shared("Shared", SymbolInfo::SymbolKind::Class, HeaderName,
+                    {{SymbolInfo::ContextType::Namespace, "na"}});
+  EXPECT_EQ(2, Reporter.seen(Shared));
+  EXPECT_EQ(1, Reporter.used(Shared));
+  SymbolInfo Macro("HEADER_MACRO", SymbolInfo::SymbolKind::Macro, HeaderName,
+                   {});
+  EXPECT_EQ(2, Reporter.seen(Macro));
+  EXPECT_EQ(1, Reporter.used(Macro));
+}
+
+TEST(HeaderSymbolCacheTest, DoesNotCacheHeadersWithoutIncludeGuard) {
+  // An X-macro header declaring other symbols each time it is included.
+  static const char MainCode[] = R"(
+    #define OP(Name) class Name##Op {};
+    #include "ops.def"
+    #undef OP
+    #define OP(Name) void Name##Function();
+    #include "ops.def"
+    #undef OP
+  )";
+  std::map<std::string, std::string> Headers = {{"ops.def", "OP(Add)\n"}};
+  TestSymbolReporter Reporter;
+  HeaderSymbolCache Cache;
+
+  ASSERT_TRUE(runWithCache(Reporter, Cache, "a.cc", MainCode, Headers));
+  ASSERT_TRUE(runWithCache(Reporter, Cache, "b.cc", MainCode, Headers));
+  EXPECT_EQ(0u, Cache.size());
+
+  SymbolInfo Class("AddOp", SymbolInfo::SymbolKind::Class, "ops.def", {});
+  EXPECT_EQ(2, Reporter.seen(Class));
+  SymbolInfo Function("AddFunction", SymbolInfo::SymbolKind::Function,
+                      "ops.def", {});
+  EXPECT_EQ(2, Reporter.seen(Function));
+}
+
+TEST(HeaderSymbolCacheTest, DoesNotCacheHeadersIncludedInNamespace) {
+  std::map<std::string, std::string> Headers = {
+      {HeaderName, "#pragma once\nclass Nested {};\n"}};
+  TestSymbolReporter Reporter;
+  HeaderSymbolCache Cache;
+
+  ASSERT_TRUE(runWithCache(
+      Reporter, Cache, "a.cc",
+      "namespace na {\n#include \"" + std::string(HeaderName) + "\"\n}",
+      Headers));
+  ASSERT_TRUE(runWithCache(Reporter, Cache, "b.cc",
+                           "#include \"" + std::string(HeaderName) + "\"\n",
+                           Headers));
+
+  SymbolInfo Nested("Nested", SymbolInfo::SymbolKind::Class, HeaderName,
+                    {{SymbolInfo::ContextType::Namespace, "na"}});
+  EXPECT_EQ(1, Reporter.seen(Nested));
+  SymbolInfo Global("Nested", SymbolInfo::SymbolKind::Class, HeaderName, {});
+  EXPECT_EQ(1, Reporter.seen(Global));
+}
+
+TEST(HeaderSymbolCacheTest, KeysHeadersByPredefinedMacros) {
+  static const char HeaderCode[] = R"(
+    #ifndef SYMBOLS_H
+    #define SYMBOLS_H
+    #ifdef USE_B
+    class B {};
+    #else
+    class A {};
+    #endif
+    #endif
+  )";
+  std::map<std::string, std::string> Headers = {{HeaderName, HeaderCode}};
+  std::string Include = "#include \"" + std::string(HeaderName) + "\"\n";
+  TestSymbolReporter Reporter;
+  HeaderSymbolCache Cache;
+
+  ASSERT_TRUE(runWithCache(Reporter, Cache, "a.cc", Include, Headers));
+  ASSERT_TRUE(
+      runWithCache(Reporter, Cache, "b.cc", Include, Headers, {"-DUSE_B"}));
+
+  SymbolInfo A("A", SymbolInfo::SymbolKind::Class, HeaderName, {});
+  EXPECT_EQ(1, Reporter.seen(A));
+  SymbolInfo B("B", SymbolInfo::SymbolKind::Class, HeaderName, {});
+  EXPECT_EQ(1, Reporter.seen(B));
+}
+
+TEST(BinarySymbolDatabaseTest, RoundTrip) {
+  SymbolInfo::SignalMap Symbols;
+  SymbolInfo Foo("foo", SymbolInfo::SymbolKind::Class, "foo.h",
+                 {{SymbolInfo::ContextType::Namespace, "a"},
+                  {SymbolInfo::ContextType::Namespace, "b"}});
+  SymbolInfo FooFunction("foo", SymbolInfo::SymbolKind::Function, "bar.h",
+                         {{SymbolInfo::ContextType::Record, "C"}});
+  SymbolInfo Bar("bar", SymbolInfo::SymbolKind::Variable, "foo.h", {});
+  Symbols[Foo] = SymbolInfo::Signals(/*Seen=*/3, /*Used=*/1);
+  Symbols[FooFunction] = SymbolInfo::Signals(/*Seen=*/1, /*Used=*/0);
+  Symbols[Bar] = SymbolInfo::Signals(/*Seen=*/2, /*Used=*/2);
+
+  std::string Data;
+  llvm::raw_string_ostream OS(Data);
+  ASSERT_TRUE(WriteSymbolInfosToBinary(OS, Symbols));
+  OS.flush();
+
+  auto Database = BinarySymbolDatabase::createFromBuffer(
+      llvm::MemoryBuffer::getMemBuffer(Data, "db", false));
+  ASSERT_TRUE(bool(Database));
+  EXPECT_EQ(3u, (*Database)->size());
+
+  std::vector<SymbolAndSignals> Results = (*Database)->lookup("foo");
+  ASSERT_EQ(2u, Results.size());
+  EXPECT_EQ(Foo, Results[0].Symbol);
+  EXPECT_EQ(SymbolInfo::Signals(3, 1), Results[0].Signals);
+  EXPECT_EQ(FooFunction, Results[1].Symbol);
+  EXPECT_EQ(SymbolInfo::Signals(1, 0), Results[1].Signals);
+
+  Results = (*Database)->lookup("bar");
+  ASSERT_EQ(1u, Results.size());
+  EXPECT_EQ(Bar, Results[0].Symbol);
+  EXPECT_TRUE((*Database)->lookup("baz").empty());
+  EXPECT_EQ(3u, (*Database)->getAllSymbols().size());
+}
+
+TEST(BinarySymbolDatabaseTest, RejectsInvalidData) {
+  EXPECT_FALSE(bool(BinarySymbolDatabase::createFromBuffer(
+      llvm::MemoryBuffer::getMemBuffer("--- not a binary database", "db",
+                                       false))));
+
+  std::string Data;
+  llvm::raw_string_ostream OS(Data);
+  ASSERT_TRUE(WriteSymbolInfosToBinary(OS, SymbolInfo::SignalMap()));
+  OS.flush();
+  // Truncated tables are rejected when the database is opened.
+  Data.resize(Data.size() - 1);
+  EXPECT_FALSE(bool(BinarySymbolDatabase::createFromBuffer(
+      llvm::MemoryBuffer::getMemBuffer(Data, "db", false))));
+}
+
 } // namespace find_all_symbols
 } // namespace clang